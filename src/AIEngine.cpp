@@ -1,36 +1,51 @@
 #include "AIEngine.h"
+#include "data/Tracing.h"
 #include <chrono>
 #include <ctime>
 
 AIEngine::AIEngine() 
     : model_(std::make_shared<EnsembleModel>()),
+      feature_schema_(novacrypt::FeatureSchema::standard()),
+      features_(feature_schema_),
       last_trade_time_(0.0),
       cooldown_period_(300.0)  // 5 minutes cooldown
 {
 }
 
 AIEngine::Decision AIEngine::decide(const std::string& price) {
-    // Get current time
-    auto now = std::chrono::system_clock::now();
-    auto now_time_t = std::chrono::system_clock::to_time_t(now);
-    double current_time = static_cast<double>(now_time_t);
+    NOVACRYPT_TRACE_SCOPE("ai.decide");
+    double current_time = currentTime();
     
     // Check cooldown period
     if (current_time - last_trade_time_ < cooldown_period_) {
-        return Decision{"HOLD", 0.0};  // Force hold during cooldown
+        return Decision{TradeAction::Hold, 0.0};  // Force hold during cooldown
     }
     
     // Convert price string to double
     double price_value = std::stod(price);
     
     // Prepare features for prediction
-    std::vector<double> features = {price_value};
-    
+    const double features[] = {price_value};
+    return decideFrom(FeatureSpan(features, 1), current_time);
+}
+
+AIEngine::Decision AIEngine::decide(const novacrypt::IndicatorManager& indicators,
+                                    const novacrypt::SentimentAnalyzer* sentiment) {
+    NOVACRYPT_TRACE_SCOPE("ai.decide");
+    double current_time = currentTime();
+    if (current_time - last_trade_time_ < cooldown_period_) {
+        return Decision{TradeAction::Hold, 0.0};
+    }
+    feature_schema_.fill(indicators, sentiment, features_.row(0));
+    return decideFrom(FeatureSpan(features_.row(0), features_.columns()), current_time);
+}
+
+AIEngine::Decision AIEngine::decideFrom(FeatureSpan features, double current_time) {
     // Get prediction from ensemble model
     auto prediction = model_->predict(features);
     
     // Update last trade time if we're making a trade
-    if (prediction.action != "HOLD") {
+    if (prediction.action != TradeAction::Hold) {
         last_trade_time_ = current_time;
     }
     
@@ -40,6 +55,19 @@ AIEngine::Decision AIEngine::decide(const std::string& price) {
     };
 }
 
+void AIEngine::saveState(novacrypt::StateWriter& out) const {
+    out.put(last_trade_time_.load(std::memory_order_relaxed));
+}
+
+void AIEngine::loadState(novacrypt::StateReader& in) {
+    last_trade_time_.store(in.get<double>(), std::memory_order_relaxed);
+}
+
+double AIEngine::currentTime() {
+    auto now = std::chrono::system_clock::now();
+    return static_cast<double>(std::chrono::system_clock::to_time_t(now));
+}
+
 void AIEngine::updateModelWeights(double rf_performance, double lstm_performance) {
     model_->updateWeights(rf_performance, lstm_performance);
 } 
\ No newline at end of file
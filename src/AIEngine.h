@@ -1,21 +1,38 @@
 #pragma once
+#include <atomic>
 #include <string>
 #include <memory>
 #include "ai/EnsembleModel.h"
+#include "indicators/FeatureSchema.h"
+#include "common/StateStream.h"
 
 class AIEngine {
 public:
     struct Decision {
-        std::string action;
+        TradeAction action;
         double confidence;
     };
 
     AIEngine();
     Decision decide(const std::string& price);
+    // A symbol's indicators, book metrics and sentiment go straight into a
+    // preallocated FeatureSchema::standard() row, so no allocation per tick
+    Decision decide(const novacrypt::IndicatorManager& indicators,
+                    const novacrypt::SentimentAnalyzer* sentiment = nullptr);
     void updateModelWeights(double rf_performance, double lstm_performance);
 
+    // Checkpoint the trade cooldown, so a restart cannot trade again early.
+    // Saving is safe while another thread is deciding.
+    void saveState(novacrypt::StateWriter& out) const;
+    void loadState(novacrypt::StateReader& in);
+
 private:
     std::shared_ptr<EnsembleModel> model_;
-    double last_trade_time_;
+    novacrypt::FeatureSchema feature_schema_;
+    novacrypt::FeatureBuffer features_;
+    std::atomic<double> last_trade_time_;  // read by checkpoints
     double cooldown_period_;  // Minimum time between trades in seconds
+
+    Decision decideFrom(FeatureSpan features, double current_time);
+    static double currentTime();
 }; 
\ No newline at end of file
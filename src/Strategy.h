@@ -5,7 +5,7 @@
 class Strategy {
 public:
     struct Signal {
-        std::string action;
+        TradeAction action;
         double confidence;
         bool should_execute;
     };
@@ -1,30 +1,46 @@
 #include "EnsembleModel.h"
+#include "../data/Tracing.h"
 #include <algorithm>
 #include <cmath>
 
+TradeAction parseTradeAction(const std::string& action) {
+    if (action == "BUY") return TradeAction::Buy;
+    if (action == "SELL") return TradeAction::Sell;
+    return TradeAction::Hold;
+}
+
+const char* toString(TradeAction action) {
+    switch (action) {
+        case TradeAction::Buy: return "BUY";
+        case TradeAction::Sell: return "SELL";
+        case TradeAction::Hold: break;
+    }
+    return "HOLD";
+}
+
 EnsembleModel::EnsembleModel() : rf_weight_(0.5), lstm_weight_(0.5) {}
 
-EnsembleModel::Prediction EnsembleModel::predict(const std::vector<double>& features) {
-    std::string rf_pred = predictRF(features);
-    std::string lstm_pred = predictLSTM(features);
-    
-    // Combine predictions based on weights
-    std::string final_action;
-    if (rf_pred == lstm_pred) {
-        final_action = rf_pred;
-    } else {
-        // Weighted decision
-        final_action = (rf_weight_ > lstm_weight_) ? rf_pred : lstm_pred;
+EnsembleModel::Prediction EnsembleModel::predict(FeatureSpan features) const {
+    NOVACRYPT_TRACE_SCOPE("ai.predict");
+    return combine(predictRF(features), predictLSTM(features));
+}
+
+void EnsembleModel::predictBatch(const FeatureMatrix& features, std::vector<Prediction>& out) const {
+    NOVACRYPT_TRACE_SCOPE("ai.predict_batch");
+    out.resize(features.rows);
+    // Sub-model outputs go through small stack blocks, so no scratch allocation
+    constexpr size_t kBlockRows = 256;
+    TradeAction rf_preds[kBlockRows];
+    TradeAction lstm_preds[kBlockRows];
+    for (size_t begin = 0; begin < features.rows; begin += kBlockRows) {
+        FeatureMatrix block{features.data + begin * features.rowStride(),
+                            std::min(kBlockRows, features.rows - begin), features.cols, features.stride};
+        predictRFBatch(block, rf_preds);
+        predictLSTMBatch(block, lstm_preds);
+        for (size_t i = 0; i < block.rows; ++i) {
+            out[begin + i] = combine(rf_preds[i], lstm_preds[i]);
+        }
     }
-    
-    double confidence = calculateConfidence(rf_pred, lstm_pred);
-    
-    return Prediction{
-        final_action,
-        confidence,
-        rf_weight_,
-        lstm_weight_
-    };
 }
 
 void EnsembleModel::updateWeights(double rf_performance, double lstm_performance) {
@@ -35,24 +51,56 @@ void EnsembleModel::updateWeights(double rf_performance, double lstm_performance
     }
 }
 
-std::string EnsembleModel::predictRF(const std::vector<double>& features) {
+TradeAction EnsembleModel::predictRF(FeatureSpan features) const {
     // TODO: Implement actual Random Forest prediction
     // For now, return a simulated prediction
-    return "HOLD";
+    (void)features;
+    return TradeAction::Hold;
 }
 
-std::string EnsembleModel::predictLSTM(const std::vector<double>& features) {
+TradeAction EnsembleModel::predictLSTM(FeatureSpan features) const {
     // TODO: Implement actual LSTM prediction
     // For now, return a simulated prediction
-    return "HOLD";
+    (void)features;
+    return TradeAction::Hold;
+}
+
+void EnsembleModel::predictRFBatch(const FeatureMatrix& features, TradeAction* out) const {
+    for (size_t i = 0; i < features.rows; ++i) {
+        out[i] = predictRF(features.row(i));
+    }
+}
+
+void EnsembleModel::predictLSTMBatch(const FeatureMatrix& features, TradeAction* out) const {
+    for (size_t i = 0; i < features.rows; ++i) {
+        out[i] = predictLSTM(features.row(i));
+    }
+}
+
+EnsembleModel::Prediction EnsembleModel::combine(TradeAction rf_pred, TradeAction lstm_pred) const {
+    // Combine predictions based on weights
+    TradeAction final_action;
+    if (rf_pred == lstm_pred) {
+        final_action = rf_pred;
+    } else {
+        // Weighted decision
+        final_action = (rf_weight_ > lstm_weight_) ? rf_pred : lstm_pred;
+    }
+
+    return Prediction{
+        final_action,
+        calculateConfidence(rf_pred, lstm_pred),
+        rf_weight_,
+        lstm_weight_
+    };
 }
 
-double EnsembleModel::calculateConfidence(const std::string& rf_pred, const std::string& lstm_pred) {
+double EnsembleModel::calculateConfidence(TradeAction rf_pred, TradeAction lstm_pred) const {
     // Calculate confidence based on agreement between models
     if (rf_pred == lstm_pred) {
         return 0.8;  // High confidence when models agree
     }
-    
+
     // Lower confidence when models disagree
     return 0.4;
-} 
\ No newline at end of file
+}
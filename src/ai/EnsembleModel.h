@@ -1,30 +1,74 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 
+enum class TradeAction : uint8_t {
+    Hold,
+    Buy,
+    Sell
+};
+
+TradeAction parseTradeAction(const std::string& action);  // "BUY", "SELL", anything else is HOLD
+const char* toString(TradeAction action);
+
+// Non-owning view of one feature row
+struct FeatureSpan {
+    const double* data = nullptr;
+    size_t size = 0;
+
+    FeatureSpan() = default;
+    FeatureSpan(const double* values, size_t count) : data(values), size(count) {}
+    FeatureSpan(const std::vector<double>& values) : data(values.data()), size(values.size()) {}
+
+    double operator[](size_t index) const { return data[index]; }
+};
+
+// Non-owning view of a row-major feature matrix: row i starts at
+// data + i * stride. A stride of 0 means rows are packed (stride == cols);
+// padded rows, as in novacrypt::FeatureBuffer, set it explicitly.
+struct FeatureMatrix {
+    const double* data = nullptr;
+    size_t rows = 0;
+    size_t cols = 0;
+    size_t stride = 0;
+
+    size_t rowStride() const { return stride ? stride : cols; }
+    FeatureSpan row(size_t index) const { return FeatureSpan(data + index * rowStride(), cols); }
+};
+
 class EnsembleModel {
 public:
     struct Prediction {
-        std::string action;  // BUY, SELL, HOLD
+        TradeAction action;  // BUY, SELL, HOLD
         double confidence;   // Confidence score (0.0 to 1.0)
         double rf_weight;    // Random Forest weight
         double lstm_weight;  // LSTM weight
     };
 
     EnsembleModel();
-    Prediction predict(const std::vector<double>& features);
+    // Single row, for live ticks; never allocates
+    Prediction predict(FeatureSpan features) const;
+    // One prediction per matrix row. out is resized to features.rows and
+    // keeps its capacity, so reusing it across batches does not allocate.
+    void predictBatch(const FeatureMatrix& features, std::vector<Prediction>& out) const;
     void updateWeights(double rf_performance, double lstm_performance);
 
 private:
     // Model weights (can be adjusted based on performance)
     double rf_weight_;
     double lstm_weight_;
-    
-    // Simulated model predictions (to be replaced with actual implementations)
-    std::string predictRF(const std::vector<double>& features);
-    std::string predictLSTM(const std::vector<double>& features);
-    
+
+    // Simulated model predictions (to be replaced with actual implementations).
+    // The batch forms evaluate every row of the matrix in one call.
+    TradeAction predictRF(FeatureSpan features) const;
+    TradeAction predictLSTM(FeatureSpan features) const;
+    void predictRFBatch(const FeatureMatrix& features, TradeAction* out) const;
+    void predictLSTMBatch(const FeatureMatrix& features, TradeAction* out) const;
+
+    Prediction combine(TradeAction rf_pred, TradeAction lstm_pred) const;
     // Helper function to calculate confidence score
-    double calculateConfidence(const std::string& rf_pred, const std::string& lstm_pred);
-}; 
\ No newline at end of file
+    double calculateConfidence(TradeAction rf_pred, TradeAction lstm_pred) const;
+};
@@ -1,107 +1,168 @@
 #include "Backtester.h"
 #include <algorithm>
-#include <numeric>
 #include <cmath>
 
 Backtester::Backtester(std::shared_ptr<EnsembleModel> model) : model_(model) {}
 
+Backtester::Backtester(std::shared_ptr<EnsembleModel> model, BacktestConfig config)
+    : model_(model), config_(std::move(config)) {}
+
+const BacktestConfig& Backtester::getConfig() const {
+    return config_;
+}
+
 BacktestResult Backtester::run(const std::vector<double>& prices,
                              const std::vector<double>& timestamps,
                              double initial_capital) {
+    return simulate(prices.data(), prices.size(),
+                    [&](size_t i) { return timestamps[i]; }, initial_capital);
+}
+
+BacktestResult Backtester::run(const novacrypt::CandleColumns& candles,
+                             double initial_capital) {
+    // Candle timestamps are nanoseconds; trades record seconds
+    return simulate(candles.close, candles.size,
+                    [&](size_t i) { return candles.timestamp[i] / 1e9; }, initial_capital);
+}
+
+template<typename TimestampAt>
+BacktestResult Backtester::simulate(const double* prices, size_t count, TimestampAt timestamp_at,
+                                    double initial_capital) {
     BacktestResult result;
-    std::vector<Trade> trades;
-    std::vector<double> equity_curve = {initial_capital};
+    StreamingMetrics metrics(initial_capital);
+    if (config_.record_equity_curve) {
+        result.equity_curve.reserve(count + 1);
+        result.equity_curve.push_back(initial_capital);
+    }
     double current_capital = initial_capital;
     double position = 0.0;
     
-    for (size_t i = 0; i < prices.size(); ++i) {
-        // Prepare features for prediction (simplified for now)
-        std::vector<double> features = {prices[i]};
-        
-        // Get prediction from ensemble model
-        auto prediction = model_->predict(features);
+    std::vector<novacrypt::RollingWindow> windows;
+    for (int period : config_.feature_periods) {
+        windows.emplace_back(static_cast<size_t>(period));
+    }
+    
+    // Features are built and predicted a block of ticks at a time: one
+    // contiguous row per tick, price followed by the configured SMAs
+    constexpr size_t kBlockTicks = 4096;
+    const size_t cols = 1 + windows.size();
+    std::vector<double> features(std::min(count, kBlockTicks) * cols);
+    std::vector<EnsembleModel::Prediction> predictions;
+    predictions.reserve(std::min(count, kBlockTicks));
+    
+    for (size_t i = 0; i < count; ++i) {
+        size_t row = i % kBlockTicks;
+        if (row == 0) {
+            size_t rows = std::min(kBlockTicks, count - i);
+            for (size_t r = 0; r < rows; ++r) {
+                double* values = features.data() + r * cols;
+                values[0] = prices[i + r];
+                for (size_t w = 0; w < windows.size(); ++w) {
+                    windows[w].push(prices[i + r]);
+                    values[1 + w] = windows[w].mean();
+                }
+            }
+            model_->predictBatch(FeatureMatrix{features.data(), rows, cols}, predictions);
+        }
+        const auto& prediction = predictions[row];
         
         // Execute trade if confidence is high enough
-        if (prediction.confidence > 0.7) {
-            Trade trade{
-                prediction.action,
-                prices[i],
-                timestamps[i],
-                prediction.confidence
-            };
+        if (prediction.confidence > config_.confidence_threshold) {
+            TradeAction action = prediction.action;
             
             // Simulate trade execution
-            if (prediction.action == "BUY" && position <= 0) {
+            if (action == TradeAction::Buy && position <= 0) {
                 position = current_capital / prices[i];
                 current_capital = 0;
-            } else if (prediction.action == "SELL" && position >= 0) {
+            } else if (action == TradeAction::Sell && position >= 0) {
                 current_capital = position * prices[i];
                 position = 0;
             }
             
-            trades.push_back(trade);
+            metrics.addTrade(prices[i]);
+            if (config_.record_trades) {
+                result.trades.push_back(Trade{
+                    action,
+                    prices[i],
+                    timestamp_at(i),
+                    prediction.confidence
+                });
+            }
         }
         
-        // Update equity curve
+        // Update equity
         double current_equity = current_capital + (position * prices[i]);
-        equity_curve.push_back(current_equity);
+        metrics.addEquity(current_equity);
+        if (config_.record_equity_curve) {
+            result.equity_curve.push_back(current_equity);
+        }
     }
     
-    // Calculate performance metrics
-    result.trades = trades;
-    result.total_trades = trades.size();
-    result.total_return = (equity_curve.back() - initial_capital) / initial_capital;
-    result.sharpe_ratio = calculateSharpeRatio(equity_curve);
-    result.max_drawdown = calculateMaxDrawdown(equity_curve);
-    result.win_rate = calculateWinRate(trades);
+    // Collect performance metrics
+    result.total_trades = metrics.tradeCount();
+    result.total_return = (metrics.lastEquity() - initial_capital) / initial_capital;
+    result.sharpe_ratio = metrics.sharpeRatio();
+    result.max_drawdown = metrics.maxDrawdown();
+    result.win_rate = metrics.winRate();
     
     return result;
 }
 
-double Backtester::calculateSharpeRatio(const std::vector<double>& returns) {
-    if (returns.size() < 2) return 0.0;
-    
-    // Calculate daily returns
-    std::vector<double> daily_returns;
-    for (size_t i = 1; i < returns.size(); ++i) {
-        daily_returns.push_back((returns[i] - returns[i-1]) / returns[i-1]);
-    }
+StreamingMetrics::StreamingMetrics(double initial_equity)
+    : previous_equity_(initial_equity),
+      peak_equity_(initial_equity),
+      max_drawdown_(0.0),
+      return_count_(0),
+      return_mean_(0.0),
+      return_m2_(0.0),
+      trade_count_(0),
+      winning_trades_(0),
+      last_trade_price_(0.0) {}
+
+void StreamingMetrics::addEquity(double equity) {
+    double ret = (equity - previous_equity_) / previous_equity_;
+    ++return_count_;
+    double delta = ret - return_mean_;
+    return_mean_ += delta / return_count_;
+    return_m2_ += delta * (ret - return_mean_);
+    previous_equity_ = equity;
     
-    // Calculate mean and standard deviation
-    double mean = std::accumulate(daily_returns.begin(), daily_returns.end(), 0.0) / daily_returns.size();
-    double variance = 0.0;
-    for (double ret : daily_returns) {
-        variance += std::pow(ret - mean, 2);
+    if (equity > peak_equity_) {
+        peak_equity_ = equity;
     }
-    variance /= daily_returns.size();
-    
-    return mean / std::sqrt(variance);
+    double drawdown = (peak_equity_ - equity) / peak_equity_;
+    max_drawdown_ = std::max(max_drawdown_, drawdown);
 }
 
-double Backtester::calculateMaxDrawdown(const std::vector<double>& equity_curve) {
-    double max_drawdown = 0.0;
-    double peak = equity_curve[0];
-    
-    for (double value : equity_curve) {
-        if (value > peak) {
-            peak = value;
-        }
-        double drawdown = (peak - value) / peak;
-        max_drawdown = std::max(max_drawdown, drawdown);
+void StreamingMetrics::addTrade(double price) {
+    // A trade counts as a win when it executes above the previous trade
+    if (trade_count_ > 0 && price > last_trade_price_) {
+        winning_trades_++;
     }
-    
-    return max_drawdown;
+    trade_count_++;
+    last_trade_price_ = price;
 }
 
-double Backtester::calculateWinRate(const std::vector<Trade>& trades) {
-    if (trades.empty()) return 0.0;
-    
-    int winning_trades = 0;
-    for (size_t i = 1; i < trades.size(); ++i) {
-        if (trades[i].price > trades[i-1].price) {
-            winning_trades++;
-        }
-    }
-    
-    return static_cast<double>(winning_trades) / trades.size();
-} 
\ No newline at end of file
+double StreamingMetrics::sharpeRatio() const {
+    if (return_count_ == 0) return 0.0;
+    double variance = return_m2_ / return_count_;
+    if (variance <= 0.0) return 0.0;
+    return return_mean_ / std::sqrt(variance);
+}
+
+double StreamingMetrics::maxDrawdown() const {
+    return max_drawdown_;
+}
+
+double StreamingMetrics::winRate() const {
+    if (trade_count_ == 0) return 0.0;
+    return static_cast<double>(winning_trades_) / trade_count_;
+}
+
+double StreamingMetrics::lastEquity() const {
+    return previous_equity_;
+}
+
+int StreamingMetrics::tradeCount() const {
+    return trade_count_;
+}
@@ -2,36 +2,86 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <cstdint>
+#include <cstddef>
 #include "../ai/EnsembleModel.h"
+#include "../indicators/MarketData.h"
 
 struct Trade {
-    std::string action;
+    TradeAction action;
     double price;
     double timestamp;
     double confidence;
 };
 
+// Tunable parameters of a single backtest run
+struct BacktestConfig {
+    double confidence_threshold = 0.7;  // minimum prediction confidence to trade
+    double rf_weight = 0.5;             // ensemble weights applied to the model
+    double lstm_weight = 0.5;
+    std::vector<int> feature_periods;   // SMA windows appended to the price feature
+    bool record_trades = false;         // keep the full trade log in the result
+    bool record_equity_curve = false;   // keep one equity value per tick
+};
+
 struct BacktestResult {
     double total_return;
     double sharpe_ratio;
     double max_drawdown;
     int total_trades;
     double win_rate;
-    std::vector<Trade> trades;
+    std::vector<Trade> trades;          // only filled with record_trades
+    std::vector<double> equity_curve;   // only filled with record_equity_curve
+};
+
+// Single-pass performance metrics with O(1) memory: Welford mean/variance of
+// per-tick returns for the Sharpe ratio, a running peak for the drawdown, and
+// the previous trade price for the win rate
+class StreamingMetrics {
+public:
+    explicit StreamingMetrics(double initial_equity);
+    
+    void addEquity(double equity);
+    void addTrade(double price);
+    
+    double sharpeRatio() const;
+    double maxDrawdown() const;
+    double winRate() const;
+    double lastEquity() const;
+    int tradeCount() const;
+
+private:
+    double previous_equity_;
+    double peak_equity_;
+    double max_drawdown_;
+    size_t return_count_;
+    double return_mean_;
+    double return_m2_;
+    int trade_count_;
+    int winning_trades_;
+    double last_trade_price_;
 };
 
 class Backtester {
 public:
     Backtester(std::shared_ptr<EnsembleModel> model);
+    Backtester(std::shared_ptr<EnsembleModel> model, BacktestConfig config);
     BacktestResult run(const std::vector<double>& prices,
                       const std::vector<double>& timestamps,
                       double initial_capital = 10000.0);
+    
+    // Zero-copy run over columnar candles (CandleStore or MappedCandleFile),
+    // trading on close prices
+    BacktestResult run(const novacrypt::CandleColumns& candles,
+                      double initial_capital = 10000.0);
+
+    const BacktestConfig& getConfig() const;
 
 private:
     std::shared_ptr<EnsembleModel> model_;
+    BacktestConfig config_;
     
-    // Helper functions
-    double calculateSharpeRatio(const std::vector<double>& returns);
-    double calculateMaxDrawdown(const std::vector<double>& equity_curve);
-    double calculateWinRate(const std::vector<Trade>& trades);
+    template<typename TimestampAt>
+    BacktestResult simulate(const double* prices, size_t count, TimestampAt timestamp_at,
+                            double initial_capital);
 }; 
\ No newline at end of file
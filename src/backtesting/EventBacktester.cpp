@@ -0,0 +1,306 @@
+#include "EventBacktester.h"
+#include "../data/MarketDataCapture.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+uint32_t checkedIndex(size_t index) {
+    if (index > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Backtest event log is full");
+    }
+    return static_cast<uint32_t>(index);
+}
+
+int64_t toNanoseconds(std::chrono::system_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point fromNanoseconds(int64_t ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+// Contiguous levels in the shape OrderBookEngine::applySnapshot iterates
+struct LevelRange {
+    const novacrypt::OrderBookLevel* first;
+    const novacrypt::OrderBookLevel* last;
+
+    const novacrypt::OrderBookLevel* begin() const { return first; }
+    const novacrypt::OrderBookLevel* end() const { return last; }
+};
+
+void applyBook(novacrypt::OrderBookEngine& engine, const BacktestEventLog::Book& book,
+               const novacrypt::OrderBookLevel* levels) {
+    const auto* bids = levels;
+    const auto* asks = levels + book.bid_count;
+    LevelRange bidRange{bids, bids + book.bid_count};
+    LevelRange askRange{asks, asks + book.ask_count};
+    if (book.snapshot) {
+        engine.applySnapshot(bidRange, askRange);
+    } else {
+        engine.applyDeltas(bidRange, askRange);
+    }
+}
+
+} // namespace
+
+void BacktestEventLog::addTick(int64_t timestamp_ns, double price, double volume) {
+    events_.push_back(Event{timestamp_ns, BacktestEventType::Tick, checkedIndex(ticks_.size())});
+    ticks_.push_back(Tick{price, volume});
+}
+
+void BacktestEventLog::addBook(int64_t timestamp_ns, const novacrypt::OrderBookUpdate& book) {
+    constexpr size_t kMaxLevels = std::numeric_limits<uint16_t>::max();
+    if (book.bids.size() > kMaxLevels || book.asks.size() > kMaxLevels) {
+        throw std::invalid_argument("Order book has too many levels for the event log");
+    }
+    events_.push_back(Event{timestamp_ns, BacktestEventType::Book, checkedIndex(books_.size())});
+    books_.push_back(Book{checkedIndex(levels_.size()), static_cast<uint16_t>(book.bids.size()),
+                          static_cast<uint16_t>(book.asks.size()),
+                          book.type == novacrypt::OrderBookUpdate::Type::Snapshot});
+    for (const auto& level : book.bids) {
+        levels_.push_back(novacrypt::OrderBookLevel{level.price, level.volume});
+    }
+    for (const auto& level : book.asks) {
+        levels_.push_back(novacrypt::OrderBookLevel{level.price, level.volume});
+    }
+}
+
+void BacktestEventLog::addSentiment(int64_t timestamp_ns, double sentiment) {
+    events_.push_back(Event{timestamp_ns, BacktestEventType::Sentiment, checkedIndex(sentiment_.size())});
+    sentiment_.push_back(sentiment);
+}
+
+void BacktestEventLog::reserve(size_t events) {
+    events_.reserve(events);
+}
+
+BacktestEventLog BacktestEventLog::fromCapture(const std::string& path, novacrypt::SymbolId symbol) {
+    BacktestEventLog log;
+    novacrypt::CaptureReader reader(path);
+    novacrypt::CaptureRecord record;
+    while (reader.next(record)) {
+        int64_t ns = toNanoseconds(record.captureTime);
+        switch (record.type) {
+            case novacrypt::CaptureRecordType::MarketData:
+                if (record.marketData.symbol == symbol) {
+                    log.addTick(ns, record.marketData.price, record.marketData.volume);
+                }
+                break;
+            case novacrypt::CaptureRecordType::OrderBook:
+                if (record.orderBook.symbol == symbol) {
+                    log.addBook(ns, record.orderBook);
+                }
+                break;
+            case novacrypt::CaptureRecordType::Sentiment:
+                log.addSentiment(ns, record.sentiment);
+                break;
+            case novacrypt::CaptureRecordType::Source:
+                break;
+        }
+    }
+    return log;
+}
+
+BacktestEventLog BacktestEventLog::fromCandles(const novacrypt::CandleColumns& candles) {
+    BacktestEventLog log;
+    log.reserve(candles.size);
+    log.ticks_.reserve(candles.size);
+    for (size_t i = 0; i < candles.size; ++i) {
+        log.addTick(candles.timestamp[i], candles.close[i], candles.volume[i]);
+    }
+    return log;
+}
+
+size_t BacktestEventLog::size() const {
+    return events_.size();
+}
+
+const BacktestEventLog::Event& BacktestEventLog::event(size_t index) const {
+    return events_[index];
+}
+
+const BacktestEventLog::Tick& BacktestEventLog::tick(const Event& event) const {
+    return ticks_[event.index];
+}
+
+const BacktestEventLog::Book& BacktestEventLog::book(const Event& event) const {
+    return books_[event.index];
+}
+
+const novacrypt::OrderBookLevel* BacktestEventLog::levels(const Book& book) const {
+    return levels_.data() + book.first_level;
+}
+
+double BacktestEventLog::sentiment(const Event& event) const {
+    return sentiment_[event.index];
+}
+
+ModelStrategy::ModelStrategy(std::shared_ptr<EnsembleModel> model, double confidence_threshold)
+    : model_(std::move(model)),
+      confidence_threshold_(confidence_threshold),
+      schema_(novacrypt::FeatureSchema::standard(false)),
+      features_(schema_) {}
+
+OrderRequest ModelStrategy::onEvent(const MarketView& view) {
+    if (view.event != BacktestEventType::Tick) {
+        return OrderRequest{};
+    }
+    schema_.fill(view.indicators, nullptr, features_.row(0));
+    auto prediction = model_->predict(FeatureSpan(features_.row(0), features_.columns()));
+    if (prediction.confidence <= confidence_threshold_) {
+        return OrderRequest{};
+    }
+    // All in or all out, as Backtester trades
+    if (prediction.action == TradeAction::Buy && view.position <= 0.0) {
+        return OrderRequest{TradeAction::Buy, 0.0, prediction.confidence};
+    }
+    if (prediction.action == TradeAction::Sell && view.position > 0.0) {
+        return OrderRequest{TradeAction::Sell, 0.0, prediction.confidence};
+    }
+    return OrderRequest{};
+}
+
+BookFill walkBook(const novacrypt::OrderBookEngine& book, novacrypt::BookSide side,
+                  double quantity, double max_notional) {
+    BookFill fill;
+    size_t count = book.levelCount(side);
+    for (size_t depth = 0; depth < count && fill.quantity < quantity; ++depth) {
+        const auto& level = book.level(side, depth);
+        double take = std::min(quantity - fill.quantity, level.quantity);
+        double cost = take * level.price;
+        bool capped = fill.notional + cost > max_notional;
+        if (capped) {
+            take = (max_notional - fill.notional) / level.price;
+            cost = take * level.price;
+        }
+        if (take <= 0.0) {
+            break;
+        }
+        fill.quantity += take;
+        fill.notional += cost;
+        ++fill.levels;
+        if (capped) {
+            return fill;
+        }
+    }
+    fill.exhausted = fill.quantity < quantity && fill.levels == count;
+    return fill;
+}
+
+EventBacktester::EventBacktester(ExecutionConfig config) : config_(config) {}
+
+const ExecutionConfig& EventBacktester::getConfig() const {
+    return config_;
+}
+
+EventBacktestResult EventBacktester::run(const BacktestEventLog& events, EventStrategy& strategy,
+                                         double initial_capital) {
+    auto started = std::chrono::steady_clock::now();
+    EventBacktestResult result;
+    StreamingMetrics metrics(initial_capital);
+    if (config_.record_equity_curve) {
+        result.equity_curve.push_back(initial_capital);
+    }
+
+    novacrypt::IndicatorManager indicators;
+    auto& book = indicators.getOrderBook();
+    const double fee_rate = config_.fee_bps / 10000.0;
+    const double slippage = config_.fallback_slippage_bps / 10000.0;
+    double cash = initial_capital;
+    double position = 0.0;
+    double last_price = 0.0;
+    double sentiment = 0.0;
+
+    for (size_t i = 0; i < events.size(); ++i) {
+        const auto& event = events.event(i);
+        switch (event.type) {
+            case BacktestEventType::Tick: {
+                const auto& tick = events.tick(event);
+                last_price = tick.price;
+                indicators.update(novacrypt::OHLCV{tick.price, tick.price, tick.price, tick.price,
+                                                   tick.volume, fromNanoseconds(event.timestamp_ns)});
+                break;
+            }
+            case BacktestEventType::Book: {
+                const auto& update = events.book(event);
+                applyBook(book, update, events.levels(update));
+                break;
+            }
+            case BacktestEventType::Sentiment:
+                sentiment = events.sentiment(event);
+                break;
+        }
+
+        OrderRequest order = strategy.onEvent(
+            MarketView{event.timestamp_ns, event.type, last_price, sentiment, indicators, position, cash});
+        bool buy = order.action == TradeAction::Buy;
+        bool sell = order.action == TradeAction::Sell;
+        if ((buy && cash > 0.0) || (sell && position > 0.0)) {
+            ++result.orders;
+            double wanted = order.quantity > 0.0 ? order.quantity
+                                                 : (buy ? std::numeric_limits<double>::infinity() : position);
+            if (sell) {
+                wanted = std::min(wanted, position);
+            }
+            // Leave room for the fee when spending cash
+            double budget = buy ? cash / (1.0 + fee_rate) : std::numeric_limits<double>::infinity();
+
+            BookFill fill;
+            auto side = buy ? novacrypt::BookSide::Ask : novacrypt::BookSide::Bid;
+            if (book.levelCount(side) > 0) {
+                fill = walkBook(book, side, wanted, budget);
+            } else if (last_price > 0.0) {
+                double price = last_price * (buy ? 1.0 + slippage : 1.0 - slippage);
+                fill.quantity = buy ? std::min(wanted, budget / price) : wanted;
+                fill.notional = fill.quantity * price;
+            }
+
+            if (fill.quantity <= 0.0) {
+                ++result.rejected_orders;
+            } else {
+                double fee = fill.notional * fee_rate;
+                if (buy) {
+                    // Rounding must not leave a negative balance
+                    cash = std::max(cash - fill.notional - fee, 0.0);
+                    position += fill.quantity;
+                } else {
+                    cash += fill.notional - fee;
+                    position = std::max(position - fill.quantity, 0.0);
+                }
+                result.fees_paid += fee;
+                if (fill.exhausted || (order.quantity > 0.0 && fill.quantity < wanted)) {
+                    ++result.partial_fills;
+                }
+                metrics.addTrade(fill.averagePrice());
+                if (config_.record_trades) {
+                    result.trades.push_back(Trade{order.action, fill.averagePrice(),
+                                                  event.timestamp_ns / 1e9, order.confidence});
+                }
+            }
+        }
+
+        if (event.type == BacktestEventType::Tick) {
+            // Mark to the book's mid when there is one
+            double mark = book.hasBothSides() ? book.midPrice() : last_price;
+            double equity = cash + position * mark;
+            metrics.addEquity(equity);
+            if (config_.record_equity_curve) {
+                result.equity_curve.push_back(equity);
+            }
+        }
+    }
+
+    result.events = events.size();
+    result.total_trades = metrics.tradeCount();
+    result.total_return = (metrics.lastEquity() - initial_capital) / initial_capital;
+    result.sharpe_ratio = metrics.sharpeRatio();
+    result.max_drawdown = metrics.maxDrawdown();
+    result.win_rate = metrics.winRate();
+    result.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    return result;
+}
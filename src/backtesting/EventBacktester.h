@@ -0,0 +1,161 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Backtester.h"
+#include "../ai/EnsembleModel.h"
+#include "../data/SourceRegistry.h"
+#include "../indicators/FeatureSchema.h"
+#include "../indicators/IndicatorManager.h"
+
+namespace novacrypt {
+struct OrderBookUpdate;
+}
+
+enum class BacktestEventType : uint8_t {
+    Tick,
+    Book,
+    Sentiment
+};
+
+// Compact, time-ordered event stream for the event-driven backtester. Events
+// are fixed-size records pointing into flat payload arrays (book levels are
+// stored back to back), so replaying tens of millions of them streams through
+// memory without touching the heap.
+class BacktestEventLog {
+public:
+    struct Event {
+        int64_t timestamp_ns;
+        BacktestEventType type;
+        uint32_t index;  // into ticks, books or sentiment, by type
+    };
+
+    struct Tick {
+        double price;
+        double volume;
+    };
+
+    struct Book {
+        uint32_t first_level;  // bids first, then asks
+        uint16_t bid_count;
+        uint16_t ask_count;
+        bool snapshot;         // false: only changed levels, zero quantity removes
+    };
+
+    // Events must be appended in time order
+    void addTick(int64_t timestamp_ns, double price, double volume);
+    void addBook(int64_t timestamp_ns, const novacrypt::OrderBookUpdate& book);
+    void addSentiment(int64_t timestamp_ns, double sentiment);
+    void reserve(size_t events);
+
+    // One symbol's ticks and books plus every sentiment record of a capture,
+    // in capture order and stamped with the capture time
+    static BacktestEventLog fromCapture(const std::string& path, novacrypt::SymbolId symbol);
+    // One tick per candle, at the close
+    static BacktestEventLog fromCandles(const novacrypt::CandleColumns& candles);
+
+    size_t size() const;
+    const Event& event(size_t index) const;
+    const Tick& tick(const Event& event) const;
+    const Book& book(const Event& event) const;
+    const novacrypt::OrderBookLevel* levels(const Book& book) const;
+    double sentiment(const Event& event) const;
+
+private:
+    std::vector<Event> events_;
+    std::vector<Tick> ticks_;
+    std::vector<Book> books_;
+    std::vector<novacrypt::OrderBookLevel> levels_;
+    std::vector<double> sentiment_;
+};
+
+// Market and account state handed to the strategy after every event
+struct MarketView {
+    int64_t timestamp_ns;
+    BacktestEventType event;
+    double last_price;   // last tick, 0 before the first one
+    double sentiment;    // last sentiment record, 0 before the first one
+    // Indicators are updated with every tick as a single-price candle; the
+    // manager's order book is the simulated book
+    const novacrypt::IndicatorManager& indicators;
+    double position;     // base units held
+    double cash;
+};
+
+struct OrderRequest {
+    TradeAction action = TradeAction::Hold;
+    double quantity = 0.0;    // base units; 0 spends all cash / sells the whole position
+    double confidence = 0.0;  // recorded with the trade
+};
+
+// Called at every event, as the live pipeline would call a strategy
+class EventStrategy {
+public:
+    virtual ~EventStrategy() = default;
+    virtual OrderRequest onEvent(const MarketView& view) = 0;
+};
+
+// Trades the ensemble model on every tick, built from the same
+// FeatureSchema::standard(false) row the live AIEngine uses minus sentiment
+class ModelStrategy : public EventStrategy {
+public:
+    ModelStrategy(std::shared_ptr<EnsembleModel> model, double confidence_threshold = 0.7);
+    OrderRequest onEvent(const MarketView& view) override;
+
+private:
+    std::shared_ptr<EnsembleModel> model_;
+    double confidence_threshold_;
+    novacrypt::FeatureSchema schema_;
+    novacrypt::FeatureBuffer features_;
+};
+
+struct ExecutionConfig {
+    double fee_bps = 0.0;                // taker fee on filled notional
+    double fallback_slippage_bps = 0.0;  // applied to the last tick when there is no book
+    bool record_trades = false;
+    bool record_equity_curve = false;    // one value per tick
+};
+
+struct EventBacktestResult : BacktestResult {
+    uint64_t events = 0;
+    uint64_t orders = 0;
+    uint64_t partial_fills = 0;    // the book ran out, or cash did
+    uint64_t rejected_orders = 0;  // nothing to fill against
+    double fees_paid = 0.0;
+    double elapsed_seconds = 0.0;
+};
+
+// Result of walking one side of the book for a market order
+struct BookFill {
+    double quantity = 0.0;
+    double notional = 0.0;
+    size_t levels = 0;       // levels touched
+    bool exhausted = false;  // the side ran out before the quantity filled
+
+    double averagePrice() const { return quantity > 0.0 ? notional / quantity : 0.0; }
+};
+
+// Takes liquidity level by level from the best price until the quantity is
+// filled, the book side is exhausted, or (for buys) the notional would exceed
+// max_notional. The simulated book is not depleted by our own fills, so
+// results are deterministic and independent of earlier orders.
+BookFill walkBook(const novacrypt::OrderBookEngine& book, novacrypt::BookSide side,
+                  double quantity, double max_notional);
+
+// Event-driven backtest: replays a BacktestEventLog through a simulated book
+// and indicator state, asks the strategy for an order after every event and
+// fills market orders by walking the book. Long only, like Backtester.
+class EventBacktester {
+public:
+    explicit EventBacktester(ExecutionConfig config = {});
+
+    EventBacktestResult run(const BacktestEventLog& events, EventStrategy& strategy,
+                            double initial_capital = 10000.0);
+
+    const ExecutionConfig& getConfig() const;
+
+private:
+    ExecutionConfig config_;
+};
@@ -0,0 +1,64 @@
+#include "ParameterSweep.h"
+
+std::vector<BacktestConfig> SweepGrid::expand() const {
+    std::vector<BacktestConfig> configs;
+    configs.reserve(confidence_thresholds.size() * ensemble_weights.size() * feature_periods.size());
+    for (double threshold : confidence_thresholds) {
+        for (const auto& weights : ensemble_weights) {
+            for (const auto& periods : feature_periods) {
+                BacktestConfig config;
+                config.confidence_threshold = threshold;
+                config.rf_weight = weights.first;
+                config.lstm_weight = weights.second;
+                config.feature_periods = periods;
+                configs.push_back(std::move(config));
+            }
+        }
+    }
+    return configs;
+}
+
+ParameterSweep::ParameterSweep(size_t threadCount, ModelFactory factory,
+                               novacrypt::PoolPlacement placement)
+    : pool_(threadCount, std::move(placement)), factory_(std::move(factory))
+{
+    if (!factory_) {
+        factory_ = [](const BacktestConfig& config) {
+            auto model = std::make_shared<EnsembleModel>();
+            model->updateWeights(config.rf_weight, config.lstm_weight);
+            return model;
+        };
+    }
+}
+
+std::vector<BacktestResult> ParameterSweep::run(const std::vector<BacktestConfig>& configs,
+                                                const std::vector<double>& prices,
+                                                const std::vector<double>& timestamps,
+                                                double initial_capital) {
+    return runAll(configs, [&](Backtester& backtester) {
+        return backtester.run(prices, timestamps, initial_capital);
+    });
+}
+
+std::vector<BacktestResult> ParameterSweep::run(const std::vector<BacktestConfig>& configs,
+                                                const novacrypt::CandleColumns& candles,
+                                                double initial_capital) {
+    return runAll(configs, [&](Backtester& backtester) {
+        return backtester.run(candles, initial_capital);
+    });
+}
+
+size_t ParameterSweep::threadCount() const {
+    return pool_.threadCount();
+}
+
+template<typename RunOne>
+std::vector<BacktestResult> ParameterSweep::runAll(const std::vector<BacktestConfig>& configs,
+                                                   RunOne run_one) {
+    std::vector<BacktestResult> results(configs.size());
+    pool_.parallelFor(configs.size(), [&](size_t i) {
+        Backtester backtester(factory_(configs[i]), configs[i]);
+        results[i] = run_one(backtester);
+    });
+    return results;
+}
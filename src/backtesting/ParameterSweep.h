@@ -0,0 +1,51 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Backtester.h"
+#include "WorkStealingPool.h"
+
+// Cartesian grid of backtest parameters
+struct SweepGrid {
+    std::vector<double> confidence_thresholds{0.7};
+    std::vector<std::pair<double, double>> ensemble_weights{{0.5, 0.5}};  // (rf, lstm)
+    std::vector<std::vector<int>> feature_periods{{}};
+
+    // All combinations, confidence threshold varying slowest
+    std::vector<BacktestConfig> expand() const;
+};
+
+// Runs many independent backtests over the same read-only price series on a
+// work-stealing pool. Every run gets its own model and indicator state, so
+// workers share nothing mutable.
+class ParameterSweep {
+public:
+    // Builds the model used by one run; the default applies the configured
+    // ensemble weights to a fresh EnsembleModel
+    using ModelFactory = std::function<std::shared_ptr<EnsembleModel>(const BacktestConfig&)>;
+
+    // threadCount == 0 uses every hardware thread; placement pins the workers
+    explicit ParameterSweep(size_t threadCount = 0, ModelFactory factory = nullptr,
+                            novacrypt::PoolPlacement placement = {});
+
+    // Results come back in config order. Trade logs and equity curves are
+    // only kept for configs that opt in, so large sweeps stay compact.
+    std::vector<BacktestResult> run(const std::vector<BacktestConfig>& configs,
+                                    const std::vector<double>& prices,
+                                    const std::vector<double>& timestamps,
+                                    double initial_capital = 10000.0);
+    std::vector<BacktestResult> run(const std::vector<BacktestConfig>& configs,
+                                    const novacrypt::CandleColumns& candles,
+                                    double initial_capital = 10000.0);
+
+    size_t threadCount() const;
+
+private:
+    template<typename RunOne>
+    std::vector<BacktestResult> runAll(const std::vector<BacktestConfig>& configs,
+                                       RunOne run_one);
+
+    WorkStealingPool pool_;
+    ModelFactory factory_;
+};
@@ -0,0 +1,139 @@
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace {
+// Index of the pool worker running on this thread, or npos for outside threads
+thread_local size_t currentWorker = static_cast<size_t>(-1);
+thread_local const WorkStealingPool* currentPool = nullptr;
+}
+
+WorkStealingPool::WorkStealingPool(size_t threadCount, novacrypt::PoolPlacement placement)
+    : placement_(std::move(placement)), nextQueue_(0), queuedTasks_(0), pendingTasks_(0), stopping_(false)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    // Tasks spawned by a worker stay on its own deque for locality
+    size_t index = (currentPool == this) ? currentWorker
+                                         : nextQueue_.fetch_add(1) % queues_.size();
+    pendingTasks_.fetch_add(1);
+    {
+        // Count before publishing so a worker never sees the counter underflow
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        queuedTasks_.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    workAvailable_.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    allDone_.wait(lock, [this] { return pendingTasks_.load() == 0; });
+    if (firstError_) {
+        std::exception_ptr error = firstError_;
+        firstError_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    for (size_t i = 0; i < count; ++i) {
+        submit([&body, i] { body(i); });
+    }
+    wait();
+}
+
+size_t WorkStealingPool::threadCount() const {
+    return workers_.size();
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    novacrypt::applyPlacement(placement_.forWorker(index));
+    currentWorker = index;
+    currentPool = this;
+    Task task;
+    for (;;) {
+        if (popLocal(index, task) || steal(index, task)) {
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(stateMutex_);
+                if (!firstError_) {
+                    firstError_ = std::current_exception();
+                }
+            }
+            task = nullptr;
+            finishTask();
+            continue;
+        }
+
+        bool ready = novacrypt::spinUntil(placement_.wait, placement_.spinTime, [this] {
+            return stopping_ || queuedTasks_.load() > 0;
+        });
+        if (!ready) {
+            std::unique_lock<std::mutex> lock(stateMutex_);
+            workAvailable_.wait(lock, [this] { return stopping_ || queuedTasks_.load() > 0; });
+        }
+        if (stopping_ && queuedTasks_.load() == 0) {
+            return;
+        }
+    }
+}
+
+bool WorkStealingPool::popLocal(size_t index, Task& task) {
+    auto& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    queuedTasks_.fetch_sub(1);
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thief, Task& task) {
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        auto& queue = *queues_[(thief + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            queuedTasks_.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::finishTask() {
+    if (pendingTasks_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        allDone_.notify_all();
+    }
+}
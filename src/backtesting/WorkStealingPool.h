@@ -0,0 +1,63 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../data/ThreadAffinity.h"
+
+// Fixed-size thread pool with one task deque per worker. Workers pop their own
+// deque LIFO and steal FIFO from the others when it runs dry, so uneven task
+// costs (e.g. long vs short backtest windows) still keep every core busy.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threadCount == 0 uses std::thread::hardware_concurrency(). Worker i
+    // runs as placement.forWorker(i) says; idle workers follow its wait policy.
+    explicit WorkStealingPool(size_t threadCount = 0, novacrypt::PoolPlacement placement = {});
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void submit(Task task);
+
+    // Block until every submitted task has finished; rethrows the first
+    // exception thrown by a task. Must not be called from inside a task.
+    void wait();
+
+    // Run body(i) for i in [0, count) across the pool and wait for completion
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    size_t threadCount() const;
+
+private:
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool popLocal(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+    void finishTask();
+
+    const novacrypt::PoolPlacement placement_;
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> nextQueue_;
+    std::atomic<size_t> queuedTasks_;
+    std::atomic<size_t> pendingTasks_;
+    std::atomic<bool> stopping_;
+
+    std::mutex stateMutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable allDone_;
+    std::exception_ptr firstError_;
+};
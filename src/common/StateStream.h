@@ -0,0 +1,110 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace novacrypt {
+
+// Compact binary encoding for checkpoints: fixed-width values in native
+// byte order, length-prefixed strings and blocks. Checkpoints are written
+// and read back by the same build, so there is no schema negotiation; a
+// version bump in the file header covers format changes.
+class StateWriter {
+public:
+    template<typename T>
+    void put(const T& value) {
+        static_assert(std::is_trivially_copyable<T>::value, "put() copies raw bytes");
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+    }
+
+    void putString(const std::string& value) {
+        put<uint32_t>(static_cast<uint32_t>(value.size()));
+        buffer_.insert(buffer_.end(), value.begin(), value.end());
+    }
+
+    void putTime(std::chrono::system_clock::time_point time) {
+        put<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+    }
+
+    // Length-prefixed block: write the contents after beginBlock(), then
+    // pass its result to endBlock()
+    size_t beginBlock() {
+        size_t offset = buffer_.size();
+        put<uint64_t>(0);
+        return offset;
+    }
+
+    void endBlock(size_t offset) {
+        uint64_t length = buffer_.size() - offset - sizeof(uint64_t);
+        std::memcpy(buffer_.data() + offset, &length, sizeof(length));
+    }
+
+    // Keeps the capacity, so a reused writer stops allocating
+    void clear() { buffer_.clear(); }
+    size_t size() const { return buffer_.size(); }
+    const char* data() const { return buffer_.data(); }
+
+private:
+    std::vector<char> buffer_;
+};
+
+// Reads what StateWriter wrote. Every read is bounds checked and throws
+// std::runtime_error on truncated input.
+class StateReader {
+public:
+    StateReader(const char* data, size_t size) : data_(data), size_(size), offset_(0) {}
+
+    template<typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "get() copies raw bytes");
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string getString() {
+        uint32_t length = get<uint32_t>();
+        const char* bytes = take(length);
+        return std::string(bytes, length);
+    }
+
+    std::chrono::system_clock::time_point getTime() {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(get<int64_t>())));
+    }
+
+    // The next block as its own reader; this reader moves past it
+    StateReader block() {
+        uint64_t length = get<uint64_t>();
+        if (length > remaining()) {
+            throw std::runtime_error("Truncated checkpoint data");
+        }
+        const char* bytes = take(static_cast<size_t>(length));
+        return StateReader(bytes, static_cast<size_t>(length));
+    }
+
+    size_t remaining() const { return size_ - offset_; }
+    bool atEnd() const { return offset_ == size_; }
+
+private:
+    const char* take(size_t count) {
+        if (count > remaining()) {
+            throw std::runtime_error("Truncated checkpoint data");
+        }
+        const char* bytes = data_ + offset_;
+        offset_ += count;
+        return bytes;
+    }
+
+    const char* data_;
+    size_t size_;
+    size_t offset_;
+};
+
+} // namespace novacrypt
@@ -0,0 +1,166 @@
+#include "CandleAggregator.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+namespace novacrypt {
+
+namespace {
+
+int64_t toNanoseconds(std::chrono::system_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point fromNanoseconds(int64_t ns) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(ns)));
+}
+
+// Floor division, so pre-epoch timestamps still land in the right bar
+int64_t floorTo(int64_t ns, int64_t step) {
+    int64_t floored = ns / step * step;
+    return floored > ns ? floored - step : floored;
+}
+
+// Field by field, so checkpoints hold no padding bytes
+void putBar(StateWriter& out, const OHLCV& bar) {
+    out.put(bar.open);
+    out.put(bar.high);
+    out.put(bar.low);
+    out.put(bar.close);
+    out.put(bar.volume);
+    out.putTime(bar.timestamp);
+}
+
+OHLCV getBar(StateReader& in) {
+    OHLCV bar;
+    bar.open = in.get<double>();
+    bar.high = in.get<double>();
+    bar.low = in.get<double>();
+    bar.close = in.get<double>();
+    bar.volume = in.get<double>();
+    bar.timestamp = in.getTime();
+    return bar;
+}
+
+} // namespace
+
+const char* toString(Timeframe timeframe) {
+    switch (timeframe) {
+        case Timeframe::Second1: return "1s";
+        case Timeframe::Minute1: return "1m";
+        case Timeframe::Minute5: return "5m";
+        case Timeframe::Hour1: return "1h";
+    }
+    return "unknown";
+}
+
+std::chrono::seconds timeframeDuration(Timeframe timeframe) {
+    switch (timeframe) {
+        case Timeframe::Second1: return std::chrono::seconds(1);
+        case Timeframe::Minute1: return std::chrono::minutes(1);
+        case Timeframe::Minute5: return std::chrono::minutes(5);
+        case Timeframe::Hour1: return std::chrono::hours(1);
+    }
+    return std::chrono::seconds(0);
+}
+
+CandleAggregator::CandleAggregator()
+    : newestNs_(std::numeric_limits<int64_t>::min()), lateTicks_(0) {
+    for (size_t i = 0; i < kTimeframeCount; ++i) {
+        builders_[i].durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            timeframeDuration(static_cast<Timeframe>(i))).count();
+    }
+}
+
+uint8_t CandleAggregator::addTick(double price, double volume, std::chrono::system_clock::time_point timestamp) {
+    return addTicks(TickRun{price, price, price, price, volume, timestamp, 1});
+}
+
+uint8_t CandleAggregator::addTicks(const TickRun& run) {
+    // Every tick of a run lies in the same 1s bar, so they share one outcome
+    int64_t ns = toNanoseconds(run.timestamp);
+    // Bars are epoch aligned and nested, so the open 1s bar starts no
+    // earlier than any other open bar: a tick it takes, every timeframe takes
+    const auto& finest = builders_[0];
+    if (finest.open && ns < finest.endNs - finest.durationNs) {
+        lateTicks_ += run.ticks;
+        return 0;
+    }
+    bool newest = ns >= newestNs_;
+    if (newest) {
+        newestNs_ = ns;
+    }
+    uint8_t closed = 0;
+    for (size_t i = 0; i < kTimeframeCount; ++i) {
+        auto& builder = builders_[i];
+        // The common case is one compare and an in-place update; bar
+        // boundaries are only recomputed on rollover
+        if (builder.open && ns < builder.endNs) {
+            builder.bar.high = std::max(builder.bar.high, run.high);
+            builder.bar.low = std::min(builder.bar.low, run.low);
+            if (newest) {
+                builder.bar.close = run.close;
+            }
+            builder.bar.volume += run.volume;
+            continue;
+        }
+        if (builder.open) {
+            builder.closed = builder.bar;
+            closed |= static_cast<uint8_t>(1u << i);
+        }
+        int64_t start = floorTo(ns, builder.durationNs);
+        builder.endNs = start + builder.durationNs;
+        builder.open = true;
+        builder.bar = OHLCV{run.open, run.high, run.low, run.close, run.volume, fromNanoseconds(start)};
+    }
+    return closed;
+}
+
+bool CandleAggregator::hasOpenBar(Timeframe timeframe) const {
+    return builders_[static_cast<size_t>(timeframe)].open;
+}
+
+const OHLCV& CandleAggregator::openBar(Timeframe timeframe) const {
+    return builders_[static_cast<size_t>(timeframe)].bar;
+}
+
+const OHLCV& CandleAggregator::closedBar(Timeframe timeframe) const {
+    return builders_[static_cast<size_t>(timeframe)].closed;
+}
+
+uint64_t CandleAggregator::lateTicks() const {
+    return lateTicks_;
+}
+
+void CandleAggregator::saveState(StateWriter& out) const {
+    for (const auto& builder : builders_) {
+        out.put(builder.durationNs);
+        out.put(builder.endNs);
+        out.put<uint8_t>(builder.open ? 1 : 0);
+        putBar(out, builder.bar);
+        putBar(out, builder.closed);
+    }
+    out.put(newestNs_);
+    out.put(lateTicks_);
+}
+
+void CandleAggregator::loadState(StateReader& in) {
+    std::array<Builder, kTimeframeCount> builders;
+    for (size_t i = 0; i < kTimeframeCount; ++i) {
+        auto& builder = builders[i];
+        builder.durationNs = in.get<int64_t>();
+        if (builder.durationNs != builders_[i].durationNs) {
+            throw std::runtime_error("Checkpointed candles use different timeframes");
+        }
+        builder.endNs = in.get<int64_t>();
+        builder.open = in.get<uint8_t>() != 0;
+        builder.bar = getBar(in);
+        builder.closed = getBar(in);
+    }
+    builders_ = builders;
+    newestNs_ = in.get<int64_t>();
+    lateTicks_ = in.get<uint64_t>();
+}
+
+} // namespace novacrypt
@@ -0,0 +1,77 @@
+#pragma once
+#include "../indicators/MarketData.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "../common/StateStream.h"
+
+namespace novacrypt {
+
+enum class Timeframe : uint8_t {
+    Second1,
+    Minute1,
+    Minute5,
+    Hour1
+};
+
+constexpr size_t kTimeframeCount = 4;
+
+const char* toString(Timeframe timeframe);
+std::chrono::seconds timeframeDuration(Timeframe timeframe);
+
+// Consecutive ticks from one 1s interval folded together, e.g. by a
+// conflating queue
+struct TickRun {
+    double open;   // first tick to arrive
+    double high;
+    double low;
+    double close;  // newest tick
+    double volume;
+    std::chrono::system_clock::time_point timestamp;  // newest tick
+    uint32_t ticks;
+};
+
+// Rolls one symbol's ticks into OHLCV bars for every timeframe in a single
+// pass. Bars are aligned to the Unix epoch and stamped with their open time.
+// A bar closes when the first tick of a later bar arrives; empty intervals
+// produce no bars. A tick older than the open 1s bar is counted and
+// dropped for every timeframe, since that interval has already been
+// emitted, so all timeframes see the same ticks. A tick out of order within
+// the open bar still counts towards volume, high and low, but the close
+// stays at the newest tick.
+class CandleAggregator {
+public:
+    CandleAggregator();
+
+    // Folds the tick into each timeframe's open bar. Returns a mask with bit
+    // i set when timeframe i's previous bar closed; read it with closedBar().
+    uint8_t addTick(double price, double volume, std::chrono::system_clock::time_point timestamp);
+    // The same for a run of ticks, with the result of adding them one by one
+    uint8_t addTicks(const TickRun& run);
+
+    bool hasOpenBar(Timeframe timeframe) const;
+    const OHLCV& openBar(Timeframe timeframe) const;
+    // Most recently closed bar; zeroed until the first close
+    const OHLCV& closedBar(Timeframe timeframe) const;
+    uint64_t lateTicks() const;
+
+    // Checkpoint the open and last closed bar of every timeframe
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+
+private:
+    struct Builder {
+        int64_t durationNs{0};
+        int64_t endNs{0};  // open bar covers [endNs - durationNs, endNs)
+        bool open{false};
+        OHLCV bar{};
+        OHLCV closed{};
+    };
+
+    std::array<Builder, kTimeframeCount> builders_;
+    int64_t newestNs_;  // timestamp of the tick that set the closes
+    uint64_t lateTicks_;
+};
+
+} // namespace novacrypt
@@ -0,0 +1,423 @@
+#include "CandleStore.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace novacrypt {
+
+namespace {
+
+constexpr char kCandleFileMagic[8] = {'N', 'C', 'C', 'A', 'N', 'D', 'L', 'E'};
+constexpr uint32_t kCandleFileVersion = 1;
+constexpr size_t kHeaderSize = 4096;
+constexpr size_t kColumns = 6;
+constexpr size_t kCacheLine = 64;
+// Rows per page, so every column starts on a page boundary
+constexpr size_t kRowsPerPage = kHeaderSize / sizeof(double);
+// Largest capacity whose file size fits in a size_t
+constexpr size_t kMaxCapacity = (std::numeric_limits<size_t>::max() - kHeaderSize) / (kColumns * sizeof(double)) / kRowsPerPage * kRowsPerPage;
+
+size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+size_t fileSizeFor(size_t capacity) {
+    return kHeaderSize + kColumns * capacity * sizeof(double);
+}
+
+size_t columnOffsetFor(size_t column, size_t capacity) {
+    return kHeaderSize + column * capacity * sizeof(double);
+}
+
+int64_t toNanoseconds(std::chrono::system_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+void validateHeader(const CandleFileHeader& header, size_t fileSize, const std::string& path) {
+    if (std::memcmp(header.magic, kCandleFileMagic, sizeof(kCandleFileMagic)) != 0) {
+        throw std::runtime_error("Not a candle file: " + path);
+    }
+    if (header.version != kCandleFileVersion || header.headerSize != kHeaderSize) {
+        throw std::runtime_error("Unsupported candle file version: " + path);
+    }
+    if (header.capacity > kMaxCapacity || header.count > header.capacity) {
+        throw std::runtime_error("Corrupt candle file: " + path);
+    }
+    // Offsets are only ever written in this layout; anything else could
+    // point columns outside the mapping
+    for (size_t i = 0; i < kColumns; ++i) {
+        if (header.columnOffsets[i] != columnOffsetFor(i, header.capacity)) {
+            throw std::runtime_error("Corrupt candle file: " + path);
+        }
+    }
+    if (fileSize < fileSizeFor(header.capacity)) {
+        throw std::runtime_error("Truncated candle file: " + path);
+    }
+}
+
+void* mapForWrite(int fd, size_t size, const std::string& path) {
+    if (::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        throw std::runtime_error("Failed to size candle file: " + path);
+    }
+    void* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map candle file: " + path);
+    }
+    return mapping;
+}
+
+} // namespace
+
+// CandleStore implementation
+CandleStore::CandleStore(size_t initialCapacity)
+    : timestamp_(nullptr), open_(nullptr), high_(nullptr), low_(nullptr),
+      close_(nullptr), volume_(nullptr), size_(0), capacity_(0)
+{
+    reserve(std::max<size_t>(initialCapacity, 1));
+}
+
+void CandleStore::append(const OHLCV& candle) {
+    append(toNanoseconds(candle.timestamp), candle.open, candle.high, candle.low,
+           candle.close, candle.volume);
+}
+
+void CandleStore::append(int64_t timestampNs, double open, double high, double low,
+                         double close, double volume) {
+    if (size_ == capacity_) {
+        reserve(capacity_ * 2);
+    }
+    timestamp_[size_] = timestampNs;
+    open_[size_] = open;
+    high_[size_] = high;
+    low_[size_] = low;
+    close_[size_] = close;
+    volume_[size_] = volume;
+    ++size_;
+}
+
+void CandleStore::reserve(size_t capacity) {
+    if (capacity <= capacity_) return;
+
+    // One allocation holding all columns, each padded to a cache line
+    size_t rows = roundUp(capacity, kCacheLine / sizeof(double));
+    void* block = std::aligned_alloc(kCacheLine, kColumns * rows * sizeof(double));
+    if (!block) {
+        throw std::bad_alloc();
+    }
+
+    char* base = static_cast<char*>(block);
+    auto* timestamp = reinterpret_cast<int64_t*>(base);
+    auto* open = reinterpret_cast<double*>(base + 1 * rows * sizeof(double));
+    auto* high = reinterpret_cast<double*>(base + 2 * rows * sizeof(double));
+    auto* low = reinterpret_cast<double*>(base + 3 * rows * sizeof(double));
+    auto* close = reinterpret_cast<double*>(base + 4 * rows * sizeof(double));
+    auto* volume = reinterpret_cast<double*>(base + 5 * rows * sizeof(double));
+    if (size_ > 0) {
+        std::memcpy(timestamp, timestamp_, size_ * sizeof(int64_t));
+        std::memcpy(open, open_, size_ * sizeof(double));
+        std::memcpy(high, high_, size_ * sizeof(double));
+        std::memcpy(low, low_, size_ * sizeof(double));
+        std::memcpy(close, close_, size_ * sizeof(double));
+        std::memcpy(volume, volume_, size_ * sizeof(double));
+    }
+
+    storage_.reset(block);
+    timestamp_ = timestamp;
+    open_ = open;
+    high_ = high;
+    low_ = low;
+    close_ = close;
+    volume_ = volume;
+    capacity_ = rows;
+}
+
+void CandleStore::clear() {
+    size_ = 0;
+}
+
+size_t CandleStore::size() const {
+    return size_;
+}
+
+size_t CandleStore::capacity() const {
+    return capacity_;
+}
+
+OHLCV CandleStore::at(size_t index) const {
+    return columns().at(index);
+}
+
+CandleColumns CandleStore::columns() const {
+    return CandleColumns{timestamp_, open_, high_, low_, close_, volume_, size_};
+}
+
+// CandleFileWriter implementation
+CandleFileWriter::CandleFileWriter(const std::string& path, size_t initialCapacity)
+    : path_(path), fd_(-1), mapping_(nullptr), mappingSize_(0), header_(nullptr)
+{
+    fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open candle file: " + path);
+    }
+
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("Failed to stat candle file: " + path);
+    }
+
+    try {
+        if (st.st_size == 0) {
+            if (initialCapacity > kMaxCapacity) {
+                throw std::invalid_argument("Candle file capacity too large");
+            }
+            size_t capacity = roundUp(std::max<size_t>(initialCapacity, 1), kRowsPerPage);
+            map(capacity);
+            std::memcpy(header_->magic, kCandleFileMagic, sizeof(kCandleFileMagic));
+            header_->version = kCandleFileVersion;
+            header_->headerSize = kHeaderSize;
+            header_->capacity = capacity;
+            header_->count = 0;
+            for (size_t i = 0; i < kColumns; ++i) {
+                header_->columnOffsets[i] = columnOffsetFor(i, capacity);
+            }
+        } else {
+            CandleFileHeader header;
+            if (::pread(fd_, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                throw std::runtime_error("Failed to read candle file header: " + path);
+            }
+            validateHeader(header, static_cast<size_t>(st.st_size), path);
+            map(header.capacity);
+        }
+    } catch (...) {
+        if (mapping_) {
+            ::munmap(mapping_, mappingSize_);
+        }
+        ::close(fd_);
+        throw;
+    }
+}
+
+CandleFileWriter::~CandleFileWriter() {
+    if (mapping_) {
+        ::msync(mapping_, mappingSize_, MS_ASYNC);
+        ::munmap(mapping_, mappingSize_);
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void CandleFileWriter::append(const OHLCV& candle) {
+    append(toNanoseconds(candle.timestamp), candle.open, candle.high, candle.low,
+           candle.close, candle.volume);
+}
+
+void CandleFileWriter::append(int64_t timestampNs, double open, double high, double low,
+                              double close, double volume) {
+    size_t count = header_->count;
+    if (count == header_->capacity) {
+        grow(count + 1);
+    }
+    reinterpret_cast<int64_t*>(column(0))[count] = timestampNs;
+    column(1)[count] = open;
+    column(2)[count] = high;
+    column(3)[count] = low;
+    column(4)[count] = close;
+    column(5)[count] = volume;
+    // Publish the row only after all of its columns are written
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->count = count + 1;
+}
+
+void CandleFileWriter::append(const CandleColumns& candles) {
+    size_t count = header_->count;
+    if (count + candles.size > header_->capacity) {
+        grow(count + candles.size);
+    }
+    std::memcpy(reinterpret_cast<int64_t*>(column(0)) + count, candles.timestamp,
+                candles.size * sizeof(int64_t));
+    std::memcpy(column(1) + count, candles.open, candles.size * sizeof(double));
+    std::memcpy(column(2) + count, candles.high, candles.size * sizeof(double));
+    std::memcpy(column(3) + count, candles.low, candles.size * sizeof(double));
+    std::memcpy(column(4) + count, candles.close, candles.size * sizeof(double));
+    std::memcpy(column(5) + count, candles.volume, candles.size * sizeof(double));
+    std::atomic_thread_fence(std::memory_order_release);
+    header_->count = count + candles.size;
+}
+
+void CandleFileWriter::sync() {
+    if (::msync(mapping_, mappingSize_, MS_SYNC) != 0) {
+        throw std::runtime_error("Failed to sync candle file: " + path_);
+    }
+}
+
+size_t CandleFileWriter::size() const {
+    return header_->count;
+}
+
+CandleColumns CandleFileWriter::columns() const {
+    return CandleColumns{reinterpret_cast<const int64_t*>(column(0)), column(1), column(2),
+                         column(3), column(4), column(5), static_cast<size_t>(header_->count)};
+}
+
+void CandleFileWriter::map(size_t capacity) {
+    mapping_ = mapForWrite(fd_, fileSizeFor(capacity), path_);
+    mappingSize_ = fileSizeFor(capacity);
+    header_ = static_cast<CandleFileHeader*>(mapping_);
+}
+
+void CandleFileWriter::grow(size_t minCapacity) {
+    size_t count = header_->count;
+    if (minCapacity > kMaxCapacity) {
+        throw std::runtime_error("Candle file too large: " + path_);
+    }
+    size_t newCapacity = roundUp(std::max<size_t>(std::min(header_->capacity, kMaxCapacity / 2) * 2, minCapacity),
+                                 kRowsPerPage);
+    size_t newSize = fileSizeFor(newCapacity);
+
+    // Committed rows are never moved in place: the grown copy is written
+    // beside the file and renamed over it once complete, so a crash leaves
+    // the old file intact and open readers keep a consistent mapping.
+    std::string temporary = path_ + ".grow";
+    int fd = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to create candle file: " + temporary);
+    }
+    void* mapping = nullptr;
+    try {
+        mapping = mapForWrite(fd, newSize, temporary);
+        auto* header = static_cast<CandleFileHeader*>(mapping);
+        *header = *header_;
+        header->capacity = newCapacity;
+        char* base = static_cast<char*>(mapping);
+        for (size_t i = 0; i < kColumns; ++i) {
+            header->columnOffsets[i] = columnOffsetFor(i, newCapacity);
+            std::memcpy(base + header->columnOffsets[i], column(i), count * sizeof(double));
+        }
+        if (::msync(mapping, newSize, MS_SYNC) != 0 ||
+            ::rename(temporary.c_str(), path_.c_str()) != 0) {
+            throw std::runtime_error("Failed to replace candle file: " + path_);
+        }
+    } catch (...) {
+        if (mapping) {
+            ::munmap(mapping, newSize);
+        }
+        ::close(fd);
+        ::unlink(temporary.c_str());
+        throw;
+    }
+
+    ::munmap(mapping_, mappingSize_);
+    ::close(fd_);
+    fd_ = fd;
+    mapping_ = mapping;
+    mappingSize_ = newSize;
+    header_ = static_cast<CandleFileHeader*>(mapping_);
+}
+
+double* CandleFileWriter::column(size_t index) const {
+    return reinterpret_cast<double*>(static_cast<char*>(mapping_) + header_->columnOffsets[index]);
+}
+
+// MappedCandleFile implementation
+MappedCandleFile::MappedCandleFile(const std::string& path)
+    : path_(path), fd_(-1), mapping_(nullptr), mappingSize_(0)
+{
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open candle file: " + path);
+    }
+    try {
+        map();
+    } catch (...) {
+        unmap();
+        ::close(fd_);
+        throw;
+    }
+}
+
+MappedCandleFile::~MappedCandleFile() {
+    unmap();
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+}
+
+void MappedCandleFile::refresh() {
+    // A grown file is a new one renamed over the path, so reopen by name
+    int fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open candle file: " + path_);
+    }
+    unmap();
+    ::close(fd_);
+    fd_ = fd;
+    map();
+}
+
+size_t MappedCandleFile::size() const {
+    return columns_.size;
+}
+
+OHLCV MappedCandleFile::at(size_t index) const {
+    return columns_.at(index);
+}
+
+CandleColumns MappedCandleFile::columns() const {
+    return columns_;
+}
+
+void MappedCandleFile::map() {
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+        throw std::runtime_error("Failed to stat candle file: " + path_);
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    if (size < kHeaderSize) {
+        throw std::runtime_error("Truncated candle file: " + path_);
+    }
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Failed to map candle file: " + path_);
+    }
+    // Validated as a copy, so a writer updating the header cannot change it
+    // between the checks and the use
+    CandleFileHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    try {
+        validateHeader(header, size, path_);
+    } catch (...) {
+        ::munmap(mapping, size);
+        throw;
+    }
+    mapping_ = mapping;
+    mappingSize_ = size;
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    const char* base = static_cast<const char*>(mapping_);
+    columns_.timestamp = reinterpret_cast<const int64_t*>(base + header.columnOffsets[0]);
+    columns_.open = reinterpret_cast<const double*>(base + header.columnOffsets[1]);
+    columns_.high = reinterpret_cast<const double*>(base + header.columnOffsets[2]);
+    columns_.low = reinterpret_cast<const double*>(base + header.columnOffsets[3]);
+    columns_.close = reinterpret_cast<const double*>(base + header.columnOffsets[4]);
+    columns_.volume = reinterpret_cast<const double*>(base + header.columnOffsets[5]);
+    columns_.size = header.count;
+}
+
+void MappedCandleFile::unmap() {
+    if (mapping_) {
+        ::munmap(const_cast<void*>(mapping_), mappingSize_);
+        mapping_ = nullptr;
+        mappingSize_ = 0;
+        columns_ = CandleColumns{};
+    }
+}
+
+} // namespace novacrypt
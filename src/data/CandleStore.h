@@ -0,0 +1,130 @@
+#pragma once
+#include "../indicators/MarketData.h"
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+namespace novacrypt {
+
+// In-memory columnar candle history. Each column is a separate 64-byte
+// aligned array, so batch kernels can stream a single field without touching
+// the others.
+class CandleStore {
+public:
+    explicit CandleStore(size_t initialCapacity = 1024);
+
+    void append(const OHLCV& candle);
+    void append(int64_t timestampNs, double open, double high, double low,
+                double close, double volume);
+
+    void reserve(size_t capacity);
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const;
+    OHLCV at(size_t index) const;
+
+    // Zero-copy view; invalidated by any append that grows the store
+    CandleColumns columns() const;
+
+private:
+    struct AlignedFree {
+        void operator()(void* ptr) const { std::free(ptr); }
+    };
+
+    std::unique_ptr<void, AlignedFree> storage_;
+    int64_t* timestamp_;
+    double* open_;
+    double* high_;
+    double* low_;
+    double* close_;
+    double* volume_;
+    size_t size_;
+    size_t capacity_;
+};
+
+// On-disk candle file layout (native byte order):
+//
+//   [header, one 4 KiB page][timestamp column][open][high][low][close][volume]
+//
+// Every column reserves `capacity` rows, so each one is contiguous and page
+// aligned, and a mapping of the file can be read in place. Rows are appended
+// into the reserved space and the header count is bumped afterwards, so
+// readers never see a partially written row, and committed rows are never
+// rewritten. Growing past the capacity copies the file at twice the capacity
+// under path + ".grow" and renames it over the original; readers keep the
+// old file mapped until they refresh().
+struct CandleFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t capacity;
+    uint64_t count;
+    uint64_t columnOffsets[6];
+};
+
+// Appends candles to a memory-mapped candle file, creating it if needed
+class CandleFileWriter {
+public:
+    explicit CandleFileWriter(const std::string& path, size_t initialCapacity = 1 << 16);
+    ~CandleFileWriter();
+
+    CandleFileWriter(const CandleFileWriter&) = delete;
+    CandleFileWriter& operator=(const CandleFileWriter&) = delete;
+
+    void append(const OHLCV& candle);
+    void append(int64_t timestampNs, double open, double high, double low,
+                double close, double volume);
+    void append(const CandleColumns& candles);
+
+    // Flush mapped pages to disk
+    void sync();
+
+    size_t size() const;
+    CandleColumns columns() const;
+
+private:
+    void map(size_t capacity);
+    void grow(size_t minCapacity);
+    double* column(size_t index) const;
+
+    std::string path_;
+    int fd_;
+    void* mapping_;
+    size_t mappingSize_;
+    CandleFileHeader* header_;
+};
+
+// Read-only memory mapping of a candle file. Opening costs one mmap and a
+// header check; there is no parse step. Throws std::runtime_error for a file
+// whose header does not describe exactly this layout, so column offsets read
+// from disk can never point outside the mapping.
+class MappedCandleFile {
+public:
+    explicit MappedCandleFile(const std::string& path);
+    ~MappedCandleFile();
+
+    MappedCandleFile(const MappedCandleFile&) = delete;
+    MappedCandleFile& operator=(const MappedCandleFile&) = delete;
+
+    // Pick up rows appended since opening, reopening the path in case the
+    // writer has grown the file since
+    void refresh();
+
+    size_t size() const;
+    OHLCV at(size_t index) const;
+    CandleColumns columns() const;
+
+private:
+    void map();
+    void unmap();
+
+    std::string path_;
+    int fd_;
+    const void* mapping_;
+    size_t mappingSize_;
+    CandleColumns columns_;
+};
+
+} // namespace novacrypt
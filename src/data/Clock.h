@@ -0,0 +1,57 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+namespace novacrypt {
+
+// Wall-clock source for freshness checks and latency accounting. Swapping in
+// a ManualClock lets captured data be replayed as if it were live.
+class Clock {
+public:
+    virtual ~Clock() = default;
+    virtual std::chrono::system_clock::time_point now() const = 0;
+};
+
+class SystemClock : public Clock {
+public:
+    std::chrono::system_clock::time_point now() const override {
+        return std::chrono::system_clock::now();
+    }
+
+    // Shared default instance
+    static std::shared_ptr<const Clock> instance() {
+        static const std::shared_ptr<const Clock> clock = std::make_shared<SystemClock>();
+        return clock;
+    }
+};
+
+// Clock that only moves when told to; safe to read while another thread sets it
+class ManualClock : public Clock {
+public:
+    explicit ManualClock(std::chrono::system_clock::time_point start = {})
+        : nanoseconds_(toNanoseconds(start)) {}
+
+    std::chrono::system_clock::time_point now() const override {
+        return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(nanoseconds_.load(std::memory_order_acquire))));
+    }
+
+    void set(std::chrono::system_clock::time_point time) {
+        nanoseconds_.store(toNanoseconds(time), std::memory_order_release);
+    }
+
+    void advance(std::chrono::nanoseconds delta) {
+        nanoseconds_.fetch_add(delta.count(), std::memory_order_acq_rel);
+    }
+
+private:
+    static int64_t toNanoseconds(std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+
+    std::atomic<int64_t> nanoseconds_;
+};
+
+} // namespace novacrypt
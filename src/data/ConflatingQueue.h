@@ -0,0 +1,182 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace novacrypt {
+
+// Last-value-wins merge: the pending update is simply replaced
+struct ReplaceMerge {
+    template<typename T>
+    bool operator()(T& pending, T&& incoming) const {
+        pending = std::move(incoming);
+        return true;
+    }
+};
+
+// Bounded FIFO that holds at most one pending update per key. Pushing a key
+// that is already queued merges into the pending entry in place (keeping its
+// queue position) instead of adding another, so a slow consumer receives
+// one up-to-date update per key. A merge may decline by returning false
+// without consuming the incoming update, which is then queued behind the
+// pending one and takes its place as the key's merge target. All storage is
+// allocated up front; when the queue is full the oldest entry is evicted.
+template<typename T, typename Merge = ReplaceMerge>
+class ConflatingQueue {
+public:
+    enum class PushResult {
+        Queued,     // new key appended
+        Coalesced,  // merged into a pending entry
+        Evicted     // appended after dropping the oldest entry
+    };
+
+    explicit ConflatingQueue(size_t capacity, Merge merge = Merge{})
+        : merge_(std::move(merge)),
+          values_(capacity),
+          slotKeys_(capacity),
+          order_(capacity),
+          head_(0),
+          count_(0)
+    {
+        if (capacity == 0) {
+            throw std::invalid_argument("ConflatingQueue capacity must be positive");
+        }
+        size_t tableSize = 1;
+        while (tableSize < capacity * 2) {
+            tableSize <<= 1;
+        }
+        table_.assign(tableSize, Entry{});
+        freeSlots_.reserve(capacity);
+        for (size_t i = capacity; i > 0; --i) {
+            freeSlots_.push_back(i - 1);
+        }
+    }
+
+    ConflatingQueue(const ConflatingQueue&) = delete;
+    ConflatingQueue& operator=(const ConflatingQueue&) = delete;
+
+    PushResult push(uint32_t key, T&& value) {
+        return push(key, std::move(value), [](T&) {});
+    }
+
+    // The same, passing an evicted entry to onEvict(T&) first; it runs
+    // under the queue's lock
+    template<typename OnEvict>
+    PushResult push(uint32_t key, T&& value, OnEvict&& onEvict) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        size_t index = find(key);
+        if (table_[index].key == key && merge_(values_[table_[index].slot], std::move(value))) {
+            return PushResult::Coalesced;
+        }
+
+        PushResult result = PushResult::Queued;
+        size_t count = count_.load(std::memory_order_relaxed);
+        if (count == values_.size()) {
+            onEvict(values_[order_[head_]]);
+            removeFront();
+            result = PushResult::Evicted;
+            index = find(key);
+            count = count_.load(std::memory_order_relaxed);
+        }
+        size_t slot = freeSlots_.back();
+        freeSlots_.pop_back();
+        values_[slot] = std::move(value);
+        slotKeys_[slot] = key;
+        table_[index] = Entry{key, slot};
+        order_[(head_ + count) % order_.size()] = slot;
+        count_.store(count + 1, std::memory_order_relaxed);
+        return result;
+    }
+
+    bool pop(T& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (count_.load(std::memory_order_relaxed) == 0) {
+            return false;
+        }
+        value = std::move(values_[order_[head_]]);
+        removeFront();
+        return true;
+    }
+
+    // Lock-free, so monitoring never contends with producers; the count is
+    // only written under the lock
+    size_t size() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    size_t capacity() const {
+        return values_.size();
+    }
+
+private:
+    static constexpr uint32_t kEmpty = UINT32_MAX;
+
+    struct Entry {
+        uint32_t key = kEmpty;
+        size_t slot = 0;
+    };
+
+    static size_t hash(uint32_t key) {
+        // Fibonacci hashing spreads consecutive symbol/source ids
+        return static_cast<size_t>((static_cast<uint64_t>(key) * 11400714819323198485ull) >> 32);
+    }
+
+    // Index of the key's entry, or of the empty entry where it would go
+    size_t find(uint32_t key) const {
+        size_t mask = table_.size() - 1;
+        size_t index = hash(key) & mask;
+        while (table_[index].key != kEmpty && table_[index].key != key) {
+            index = (index + 1) & mask;
+        }
+        return index;
+    }
+
+    void removeFront() {
+        size_t slot = order_[head_];
+        head_ = (head_ + 1) % order_.size();
+        count_.store(count_.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        // After a declined merge the key maps to a newer slot, which stays
+        size_t index = find(slotKeys_[slot]);
+        if (table_[index].key == slotKeys_[slot] && table_[index].slot == slot) {
+            erase(index);
+        }
+        freeSlots_.push_back(slot);
+    }
+
+    // Linear-probing delete with backward shift, so lookups need no tombstones
+    void erase(size_t hole) {
+        size_t mask = table_.size() - 1;
+        table_[hole] = Entry{};
+        size_t next = (hole + 1) & mask;
+        while (table_[next].key != kEmpty) {
+            size_t home = hash(table_[next].key) & mask;
+            // Move the entry back if the hole lies between its home and its position
+            if (((next - home) & mask) >= ((next - hole) & mask)) {
+                table_[hole] = table_[next];
+                table_[next] = Entry{};
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+    }
+
+    Merge merge_;
+    mutable std::mutex mutex_;
+    std::vector<T> values_;        // slot pool
+    std::vector<uint32_t> slotKeys_;
+    std::vector<size_t> freeSlots_;
+    std::vector<size_t> order_;    // ring of slots in arrival order
+    size_t head_;
+    std::atomic<size_t> count_;
+    std::vector<Entry> table_;     // key -> slot, open addressing
+};
+
+} // namespace novacrypt
@@ -1,163 +1,462 @@
 #include "DataQualityMetrics.h"
+#include "Tracing.h"
 #include <algorithm>
-#include <numeric>
+#include <stdexcept>
 #include <sstream>
 #include <iomanip>
 
 namespace novacrypt {
 
-DataQualityTracker::DataQualityTracker(size_t historySize)
-    : historySize_(historySize)
+namespace {
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+constexpr int64_t kDefaultLatencyWindowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::minutes(1)).count();
+
+} // namespace
+
+DataQualityTracker::DataQualityTracker(size_t historySize, std::chrono::milliseconds snapshotInterval,
+                                       std::shared_ptr<SourceRegistry> registry)
+    : historySize_(historySize),
+      snapshotIntervalNs_(std::chrono::duration_cast<std::chrono::nanoseconds>(snapshotInterval).count()),
+      nextSnapshotNs_(steadyNowNs() + snapshotIntervalNs_.load()),
+      latencyWindowNs_(kDefaultLatencyWindowNs),
+      nextRotationNs_(steadyNowNs() + kDefaultLatencyWindowNs),
+      registry_(registry ? std::move(registry) : std::make_shared<SourceRegistry>())
 {
+    slots_ = std::make_unique<std::atomic<SourceMetrics*>[]>(registry_->capacity());
+    for (size_t i = 0; i < registry_->capacity(); ++i) {
+        slots_[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+DataQualityTracker::~DataQualityTracker() {
+    for (size_t i = 0; i < registry_->capacity(); ++i) {
+        delete slots_[i].load(std::memory_order_relaxed);
+    }
+}
+
+SourceId DataQualityTracker::registerSource(const std::string& source) {
+    SourceId id = registry_->registerSource(source);
+    slot(id);
+    return id;
+}
+
+std::shared_ptr<SourceRegistry> DataQualityTracker::getSourceRegistry() const {
+    return registry_;
 }
 
 void DataQualityTracker::updateMetrics(const std::string& source, const DataQualityMetrics& metrics) {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto& sourceMetrics = sourceMetrics_[source];
-    updateSourceMetrics(sourceMetrics, metrics);
+    appendHistory(slot(registerSource(source)), metrics);
 }
 
-void DataQualityTracker::recordLatency(const std::string& source, std::chrono::milliseconds latency) {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto& metrics = sourceMetrics_[source];
-    metrics.latencyHistory.push_back(latency);
-    if (metrics.latencyHistory.size() > historySize_) {
-        metrics.latencyHistory.pop_front();
-    }
-    calculateMetrics(metrics);
+void DataQualityTracker::recordLatency(SourceId source, std::chrono::microseconds latency) {
+    // Clock skew can make feed timestamps land in the future; count those as zero
+    slot(source).latency.record(latency.count() > 0 ? static_cast<uint64_t>(latency.count()) : 0);
 }
 
-void DataQualityTracker::recordDataPoint(const std::string& source, bool isValid) {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto& metrics = sourceMetrics_[source];
-    metrics.totalDataPoints++;
+void DataQualityTracker::recordDataPoint(SourceId source, bool isValid) {
+    auto& counters = slot(source).counters;
+    counters.totalDataPoints.fetch_add(1, std::memory_order_relaxed);
     if (isValid) {
-        metrics.validDataPoints++;
+        counters.validDataPoints.fetch_add(1, std::memory_order_relaxed);
     } else {
-        metrics.rejectedDataPoints++;
+        counters.rejectedDataPoints.fetch_add(1, std::memory_order_relaxed);
     }
-    calculateMetrics(metrics);
 }
 
-void DataQualityTracker::recordPriceAccuracy(const std::string& source, bool isAccurate) {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto& metrics = sourceMetrics_[source];
+void DataQualityTracker::recordDataPoints(SourceId source, size_t valid, size_t rejected) {
+    auto& counters = slot(source).counters;
+    counters.totalDataPoints.fetch_add(valid + rejected, std::memory_order_relaxed);
+    counters.validDataPoints.fetch_add(valid, std::memory_order_relaxed);
+    counters.rejectedDataPoints.fetch_add(rejected, std::memory_order_relaxed);
+}
+
+void DataQualityTracker::recordPriceAccuracy(SourceId source, bool isAccurate) {
     if (isAccurate) {
-        metrics.accuratePricePoints++;
+        slot(source).counters.accuratePricePoints.fetch_add(1, std::memory_order_relaxed);
     }
-    calculateMetrics(metrics);
 }
 
-void DataQualityTracker::recordVolumeAccuracy(const std::string& source, bool isAccurate) {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto& metrics = sourceMetrics_[source];
+void DataQualityTracker::recordVolumeAccuracy(SourceId source, bool isAccurate) {
     if (isAccurate) {
-        metrics.accurateVolumePoints++;
+        slot(source).counters.accurateVolumePoints.fetch_add(1, std::memory_order_relaxed);
     }
-    calculateMetrics(metrics);
 }
 
-void DataQualityTracker::recordOrderBookAccuracy(const std::string& source, bool isAccurate) {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto& metrics = sourceMetrics_[source];
+void DataQualityTracker::recordOrderBookAccuracy(SourceId source, bool isAccurate) {
     if (isAccurate) {
-        metrics.accurateOrderBookPoints++;
+        slot(source).counters.accurateOrderBookPoints.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void DataQualityTracker::recordCoalesced(SourceId source, size_t count) {
+    slot(source).counters.coalescedDataPoints.fetch_add(count, std::memory_order_relaxed);
+}
+
+void DataQualityTracker::recordDropped(SourceId source, size_t count) {
+    slot(source).counters.droppedDataPoints.fetch_add(count, std::memory_order_relaxed);
+}
+
+void DataQualityTracker::recordLatency(const std::string& source, std::chrono::microseconds latency) {
+    recordLatency(registerSource(source), latency);
+}
+
+void DataQualityTracker::recordDataPoint(const std::string& source, bool isValid) {
+    recordDataPoint(registerSource(source), isValid);
+}
+
+void DataQualityTracker::recordPriceAccuracy(const std::string& source, bool isAccurate) {
+    recordPriceAccuracy(registerSource(source), isAccurate);
+}
+
+void DataQualityTracker::recordVolumeAccuracy(const std::string& source, bool isAccurate) {
+    recordVolumeAccuracy(registerSource(source), isAccurate);
+}
+
+void DataQualityTracker::recordOrderBookAccuracy(const std::string& source, bool isAccurate) {
+    recordOrderBookAccuracy(registerSource(source), isAccurate);
+}
+
+void DataQualityTracker::recordCoalesced(const std::string& source, size_t count) {
+    recordCoalesced(registerSource(source), count);
+}
+
+void DataQualityTracker::recordDropped(const std::string& source, size_t count) {
+    recordDropped(registerSource(source), count);
+}
+
+void DataQualityTracker::takeSnapshot() {
+    NOVACRYPT_TRACE_SCOPE("quality.snapshot");
+    rotateLatencyWindowIfDue(steadyNowNs());
+    size_t count = registry_->size();
+    for (size_t id = 0; id < count; ++id) {
+        auto* metrics = slots_[id].load(std::memory_order_acquire);
+        if (!metrics || metrics->counters.totalDataPoints.load(std::memory_order_relaxed) == 0) continue;
+        appendHistory(*metrics, calculateMetrics(*metrics));
+    }
+}
+
+bool DataQualityTracker::snapshotIfDue() {
+    int64_t now = steadyNowNs();
+    int64_t due = nextSnapshotNs_.load(std::memory_order_relaxed);
+    if (now < due) {
+        return false;
+    }
+    // Only the caller that advances the deadline takes the snapshot
+    if (!nextSnapshotNs_.compare_exchange_strong(due, now + snapshotIntervalNs_.load(std::memory_order_relaxed),
+                                                 std::memory_order_relaxed)) {
+        return false;
     }
-    calculateMetrics(metrics);
+    takeSnapshot();
+    return true;
+}
+
+void DataQualityTracker::setSnapshotInterval(std::chrono::milliseconds interval) {
+    int64_t intervalNs = std::chrono::duration_cast<std::chrono::nanoseconds>(interval).count();
+    snapshotIntervalNs_.store(intervalNs, std::memory_order_relaxed);
+    nextSnapshotNs_.store(steadyNowNs() + intervalNs, std::memory_order_relaxed);
+}
+
+void DataQualityTracker::setLatencyWindow(std::chrono::milliseconds window) {
+    int64_t windowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(window).count();
+    if (windowNs <= 0) {
+        throw std::invalid_argument("Latency window must be positive");
+    }
+    latencyWindowNs_.store(windowNs, std::memory_order_relaxed);
+    nextRotationNs_.store(steadyNowNs() + windowNs, std::memory_order_relaxed);
+}
+
+void DataQualityTracker::resetLatencyWindow() {
+    size_t count = registry_->size();
+    for (size_t id = 0; id < count; ++id) {
+        auto* metrics = slots_[id].load(std::memory_order_acquire);
+        if (!metrics) continue;
+        auto now = metrics->latency.snapshot();
+        std::lock_guard<std::mutex> lock(metrics->windowMutex);
+        metrics->windowStart = now;
+        metrics->nextWindowStart = std::move(now);
+    }
+    nextRotationNs_.store(steadyNowNs() + latencyWindowNs_.load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+}
+
+void DataQualityTracker::rotateLatencyWindowIfDue(int64_t now) {
+    int64_t due = nextRotationNs_.load(std::memory_order_relaxed);
+    if (now < due ||
+        !nextRotationNs_.compare_exchange_strong(due, now + latencyWindowNs_.load(std::memory_order_relaxed),
+                                                 std::memory_order_relaxed)) {
+        return;
+    }
+    size_t count = registry_->size();
+    for (size_t id = 0; id < count; ++id) {
+        auto* metrics = slots_[id].load(std::memory_order_acquire);
+        if (!metrics) continue;
+        auto current = metrics->latency.snapshot();
+        std::lock_guard<std::mutex> lock(metrics->windowMutex);
+        std::swap(metrics->windowStart, metrics->nextWindowStart);
+        metrics->nextWindowStart = std::move(current);
+    }
+}
+
+LatencyHistogram::Snapshot DataQualityTracker::recentLatency(const SourceMetrics& metrics) const {
+    auto current = metrics.latency.snapshot();
+    std::lock_guard<std::mutex> lock(metrics.windowMutex);
+    return current.since(metrics.windowStart);
+}
+
+DataQualityMetrics DataQualityTracker::getLatestMetrics(SourceId source) const {
+    const auto* metrics = findSlot(source);
+    if (!metrics) {
+        return DataQualityMetrics{};
+    }
+    return calculateMetrics(*metrics);
 }
 
 DataQualityMetrics DataQualityTracker::getLatestMetrics(const std::string& source) const {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto it = sourceMetrics_.find(source);
-    if (it == sourceMetrics_.end() || it->second.history.empty()) {
+    const auto* metrics = findSlot(source);
+    if (!metrics) {
         return DataQualityMetrics{};
     }
-    return it->second.history.back();
+    return calculateMetrics(*metrics);
+}
+
+LatencyHistogram::Snapshot DataQualityTracker::getLatencySnapshot(SourceId source) const {
+    const auto* metrics = findSlot(source);
+    return metrics ? metrics->latency.snapshot() : LatencyHistogram::Snapshot{};
+}
+
+LatencyHistogram::Snapshot DataQualityTracker::getRecentLatencySnapshot(SourceId source) const {
+    const auto* metrics = findSlot(source);
+    return metrics ? recentLatency(*metrics) : LatencyHistogram::Snapshot{};
+}
+
+DataQualityMetrics DataQualityTracker::getAggregateMetrics() const {
+    MetricsTotals totals;
+    size_t count = registry_->size();
+    for (size_t id = 0; id < count; ++id) {
+        if (const auto* metrics = slots_[id].load(std::memory_order_acquire)) {
+            accumulate(*metrics, totals);
+        }
+    }
+    return calculateMetrics(totals);
+}
+
+void DataQualityTracker::saveState(StateWriter& out) const {
+    std::vector<SourceId> sources;
+    size_t count = registry_->size();
+    for (size_t id = 0; id < count; ++id) {
+        if (slots_[id].load(std::memory_order_acquire)) {
+            sources.push_back(static_cast<SourceId>(id));
+        }
+    }
+    out.put<uint32_t>(static_cast<uint32_t>(sources.size()));
+    for (SourceId id : sources) {
+        const auto& metrics = *slots_[id].load(std::memory_order_acquire);
+        const auto& counters = metrics.counters;
+        out.putString(registry_->name(id));
+        out.put<uint64_t>(counters.totalDataPoints.load(std::memory_order_relaxed));
+        out.put<uint64_t>(counters.validDataPoints.load(std::memory_order_relaxed));
+        out.put<uint64_t>(counters.rejectedDataPoints.load(std::memory_order_relaxed));
+        out.put<uint64_t>(counters.accuratePricePoints.load(std::memory_order_relaxed));
+        out.put<uint64_t>(counters.accurateVolumePoints.load(std::memory_order_relaxed));
+        out.put<uint64_t>(counters.accurateOrderBookPoints.load(std::memory_order_relaxed));
+        out.put<uint64_t>(counters.coalescedDataPoints.load(std::memory_order_relaxed));
+        out.put<uint64_t>(counters.droppedDataPoints.load(std::memory_order_relaxed));
+        
+        // Only occupied buckets, as (index, count) pairs
+        auto latency = metrics.latency.snapshot();
+        uint32_t occupied = static_cast<uint32_t>(
+            std::count_if(latency.buckets.begin(), latency.buckets.end(), [](uint64_t n) { return n > 0; }));
+        out.put<uint64_t>(latency.sum);
+        out.put<double>(latency.sumSquares);
+        out.put<uint64_t>(latency.max);
+        out.put<uint32_t>(occupied);
+        for (size_t i = 0; i < latency.buckets.size(); ++i) {
+            if (latency.buckets[i] > 0) {
+                out.put<uint32_t>(static_cast<uint32_t>(i));
+                out.put<uint64_t>(latency.buckets[i]);
+            }
+        }
+    }
+}
+
+void DataQualityTracker::loadState(StateReader& in) {
+    uint32_t sources = in.get<uint32_t>();
+    for (uint32_t i = 0; i < sources; ++i) {
+        auto& metrics = slot(registerSource(in.getString()));
+        auto& counters = metrics.counters;
+        counters.totalDataPoints.store(in.get<uint64_t>(), std::memory_order_relaxed);
+        counters.validDataPoints.store(in.get<uint64_t>(), std::memory_order_relaxed);
+        counters.rejectedDataPoints.store(in.get<uint64_t>(), std::memory_order_relaxed);
+        counters.accuratePricePoints.store(in.get<uint64_t>(), std::memory_order_relaxed);
+        counters.accurateVolumePoints.store(in.get<uint64_t>(), std::memory_order_relaxed);
+        counters.accurateOrderBookPoints.store(in.get<uint64_t>(), std::memory_order_relaxed);
+        counters.coalescedDataPoints.store(in.get<uint64_t>(), std::memory_order_relaxed);
+        counters.droppedDataPoints.store(in.get<uint64_t>(), std::memory_order_relaxed);
+        
+        LatencyHistogram::Snapshot latency;
+        latency.sum = in.get<uint64_t>();
+        latency.sumSquares = in.get<double>();
+        latency.max = in.get<uint64_t>();
+        uint32_t occupied = in.get<uint32_t>();
+        for (uint32_t j = 0; j < occupied; ++j) {
+            uint32_t index = in.get<uint32_t>();
+            uint64_t count = in.get<uint64_t>();
+            if (index >= latency.buckets.size()) {
+                throw std::runtime_error("Corrupt checkpointed latency histogram");
+            }
+            latency.buckets[index] = count;
+            latency.count += count;
+        }
+        metrics.latency.restore(latency);
+        // The restored history predates this process; start a fresh window
+        std::lock_guard<std::mutex> lock(metrics.windowMutex);
+        metrics.windowStart = latency;
+        metrics.nextWindowStart = std::move(latency);
+    }
 }
 
 std::vector<DataQualityMetrics> DataQualityTracker::getMetricsHistory(const std::string& source) const {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto it = sourceMetrics_.find(source);
-    if (it == sourceMetrics_.end()) {
+    const auto* metrics = findSlot(source);
+    if (!metrics) {
         return {};
     }
-    return std::vector<DataQualityMetrics>(it->second.history.begin(), it->second.history.end());
+    std::lock_guard<std::mutex> lock(metrics->historyMutex);
+    return std::vector<DataQualityMetrics>(metrics->history.begin(), metrics->history.end());
 }
 
 double DataQualityTracker::getSourceReliability(const std::string& source) const {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto it = sourceMetrics_.find(source);
-    if (it == sourceMetrics_.end() || it->second.history.empty()) {
-        return 0.0;
-    }
-    return it->second.history.back().sourceReliability;
+    return getLatestMetrics(source).sourceReliability;
 }
 
 std::string DataQualityTracker::generateQualityReport(const std::string& source) const {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
-    auto it = sourceMetrics_.find(source);
-    if (it == sourceMetrics_.end() || it->second.history.empty()) {
+    const auto* metrics = findSlot(source);
+    if (!metrics || metrics->counters.totalDataPoints.load(std::memory_order_relaxed) == 0) {
         return "No data available for source: " + source;
     }
-    
-    const auto& metrics = it->second.history.back();
-    return formatMetrics(metrics);
+    return formatMetrics(calculateMetrics(*metrics));
 }
 
 std::string DataQualityTracker::generateSummaryReport() const {
-    std::lock_guard<std::mutex> lock(metricsMutex_);
+    NOVACRYPT_TRACE_SCOPE("quality.summary_report");
     std::stringstream ss;
     ss << "Data Quality Summary Report\n";
     ss << "=========================\n\n";
     
-    for (const auto& [source, metrics] : sourceMetrics_) {
-        if (metrics.history.empty()) continue;
+    MetricsTotals overall;
+    size_t count = registry_->size();
+    for (size_t id = 0; id < count; ++id) {
+        const auto* metrics = slots_[id].load(std::memory_order_acquire);
+        if (!metrics) continue;
+        
+        MetricsTotals totals;
+        accumulate(*metrics, totals);
+        if (totals.total == 0) continue;
+        accumulate(*metrics, overall);
         
-        ss << "Source: " << source << "\n";
+        ss << "Source: " << registry_->name(static_cast<SourceId>(id)) << "\n";
         ss << "------------------------\n";
-        ss << formatMetrics(metrics.history.back());
+        ss << formatMetrics(calculateMetrics(totals));
         ss << "\n";
     }
     
+    if (overall.total > 0) {
+        ss << "All Sources\n";
+        ss << "------------------------\n";
+        ss << formatMetrics(calculateMetrics(overall));
+    }
+    
     return ss.str();
 }
 
-void DataQualityTracker::updateSourceMetrics(SourceMetrics& metrics, const DataQualityMetrics& newMetrics) {
-    metrics.history.push_back(newMetrics);
+DataQualityTracker::SourceMetrics& DataQualityTracker::slot(SourceId source) {
+    if (source >= registry_->capacity()) {
+        throw std::out_of_range("Unknown source id");
+    }
+    auto* metrics = slots_[source].load(std::memory_order_acquire);
+    if (metrics) {
+        return *metrics;
+    }
+    std::lock_guard<std::mutex> lock(slotCreationMutex_);
+    metrics = slots_[source].load(std::memory_order_relaxed);
+    if (!metrics) {
+        metrics = new SourceMetrics();
+        slots_[source].store(metrics, std::memory_order_release);
+    }
+    return *metrics;
+}
+
+const DataQualityTracker::SourceMetrics* DataQualityTracker::findSlot(SourceId source) const {
+    if (source >= registry_->capacity()) {
+        return nullptr;
+    }
+    return slots_[source].load(std::memory_order_acquire);
+}
+
+const DataQualityTracker::SourceMetrics* DataQualityTracker::findSlot(const std::string& source) const {
+    auto id = registry_->find(source);
+    return id ? findSlot(*id) : nullptr;
+}
+
+void DataQualityTracker::appendHistory(SourceMetrics& metrics, const DataQualityMetrics& snapshot) {
+    std::lock_guard<std::mutex> lock(metrics.historyMutex);
+    metrics.history.push_back(snapshot);
     if (metrics.history.size() > historySize_) {
         metrics.history.pop_front();
     }
 }
 
-void DataQualityTracker::calculateMetrics(SourceMetrics& metrics) {
-    if (metrics.totalDataPoints == 0) return;
-    
+void DataQualityTracker::accumulate(const SourceMetrics& metrics, MetricsTotals& totals) const {
+    const auto& counters = metrics.counters;
+    totals.total += counters.totalDataPoints.load(std::memory_order_relaxed);
+    totals.valid += counters.validDataPoints.load(std::memory_order_relaxed);
+    totals.rejected += counters.rejectedDataPoints.load(std::memory_order_relaxed);
+    totals.accuratePrice += counters.accuratePricePoints.load(std::memory_order_relaxed);
+    totals.accurateVolume += counters.accurateVolumePoints.load(std::memory_order_relaxed);
+    totals.accurateOrderBook += counters.accurateOrderBookPoints.load(std::memory_order_relaxed);
+    totals.coalesced += counters.coalescedDataPoints.load(std::memory_order_relaxed);
+    totals.dropped += counters.droppedDataPoints.load(std::memory_order_relaxed);
+    totals.latency.merge(recentLatency(metrics));
+}
+
+DataQualityMetrics DataQualityTracker::calculateMetrics(const SourceMetrics& metrics) const {
+    MetricsTotals totals;
+    accumulate(metrics, totals);
+    return calculateMetrics(totals);
+}
+
+DataQualityMetrics DataQualityTracker::calculateMetrics(const MetricsTotals& totals) const {
     DataQualityMetrics newMetrics;
+    if (totals.total == 0) return newMetrics;
+    double total = static_cast<double>(totals.total);
     
-    // Calculate latency metrics
-    if (!metrics.latencyHistory.empty()) {
-        double sum = std::accumulate(metrics.latencyHistory.begin(), metrics.latencyHistory.end(), 0.0,
-            [](double acc, const auto& latency) { return acc + latency.count(); });
-        newMetrics.averageLatency = sum / metrics.latencyHistory.size();
-        
-        newMetrics.maxLatency = std::max_element(metrics.latencyHistory.begin(), metrics.latencyHistory.end())->count();
-        
-        double sq_sum = std::accumulate(metrics.latencyHistory.begin(), metrics.latencyHistory.end(), 0.0,
-            [&](double acc, const auto& latency) {
-                double diff = latency.count() - newMetrics.averageLatency;
-                return acc + diff * diff;
-            });
-        newMetrics.latencyStdDev = std::sqrt(sq_sum / metrics.latencyHistory.size());
-    }
+    // Calculate latency metrics from the recent window (microseconds)
+    const auto& latency = totals.latency;
+    newMetrics.averageLatency = latency.mean() / 1000.0;
+    newMetrics.maxLatency = static_cast<double>(latency.max) / 1000.0;
+    newMetrics.latencyStdDev = latency.standardDeviation() / 1000.0;
+    newMetrics.latencyP50 = static_cast<double>(latency.percentile(0.50));
+    newMetrics.latencyP99 = static_cast<double>(latency.percentile(0.99));
+    newMetrics.latencyP999 = static_cast<double>(latency.percentile(0.999));
     
     // Calculate completeness metrics
-    newMetrics.dataCompleteness = static_cast<double>(metrics.validDataPoints) / metrics.totalDataPoints * 100.0;
-    newMetrics.missingDataRate = static_cast<double>(metrics.rejectedDataPoints) / metrics.totalDataPoints * 100.0;
+    newMetrics.dataCompleteness = totals.valid / total * 100.0;
+    newMetrics.missingDataRate = totals.rejected / total * 100.0;
     
-    // Calculate accuracy metrics
-    newMetrics.priceAccuracy = static_cast<double>(metrics.accuratePricePoints) / metrics.totalDataPoints * 100.0;
-    newMetrics.volumeAccuracy = static_cast<double>(metrics.accurateVolumePoints) / metrics.totalDataPoints * 100.0;
-    newMetrics.orderBookAccuracy = static_cast<double>(metrics.accurateOrderBookPoints) / metrics.totalDataPoints * 100.0;
+    // Calculate accuracy metrics over the points that reached processing;
+    // coalesced and dropped ones never got there to be checked
+    size_t skipped = totals.coalesced + totals.dropped;
+    double evaluated = static_cast<double>(totals.total - std::min(skipped, totals.total));
+    if (evaluated > 0.0) {
+        newMetrics.priceAccuracy = totals.accuratePrice / evaluated * 100.0;
+        newMetrics.volumeAccuracy = totals.accurateVolume / evaluated * 100.0;
+        newMetrics.orderBookAccuracy = totals.accurateOrderBook / evaluated * 100.0;
+    }
     
     // Calculate source reliability
     newMetrics.sourceReliability = (newMetrics.dataCompleteness * 0.3 +
@@ -165,15 +464,14 @@ void DataQualityTracker::calculateMetrics(SourceMetrics& metrics) {
                                   newMetrics.volumeAccuracy * 0.2 +
                                   newMetrics.orderBookAccuracy * 0.2) / 100.0;
     
-    newMetrics.totalDataPoints = metrics.totalDataPoints;
-    newMetrics.validDataPoints = metrics.validDataPoints;
-    newMetrics.rejectedDataPoints = metrics.rejectedDataPoints;
+    newMetrics.totalDataPoints = totals.total;
+    newMetrics.validDataPoints = totals.valid;
+    newMetrics.rejectedDataPoints = totals.rejected;
+    newMetrics.coalescedDataPoints = totals.coalesced;
+    newMetrics.droppedDataPoints = totals.dropped;
     newMetrics.timestamp = std::chrono::system_clock::now();
     
-    metrics.history.push_back(newMetrics);
-    if (metrics.history.size() > historySize_) {
-        metrics.history.pop_front();
-    }
+    return newMetrics;
 }
 
 std::string DataQualityTracker::formatMetrics(const DataQualityMetrics& metrics) const {
@@ -185,7 +483,10 @@ std::string DataQualityTracker::formatMetrics(const DataQualityMetrics& metrics)
     ss << "Timeliness:\n";
     ss << "  Average Latency: " << metrics.averageLatency << " ms\n";
     ss << "  Max Latency: " << metrics.maxLatency << " ms\n";
-    ss << "  Latency StdDev: " << metrics.latencyStdDev << " ms\n\n";
+    ss << "  Latency StdDev: " << metrics.latencyStdDev << " ms\n";
+    ss << "  Latency p50: " << metrics.latencyP50 << " us\n";
+    ss << "  Latency p99: " << metrics.latencyP99 << " us\n";
+    ss << "  Latency p99.9: " << metrics.latencyP999 << " us\n\n";
     
     ss << "Completeness:\n";
     ss << "  Data Completeness: " << metrics.dataCompleteness << "%\n";
@@ -201,6 +502,8 @@ std::string DataQualityTracker::formatMetrics(const DataQualityMetrics& metrics)
     ss << "  Total Data Points: " << metrics.totalDataPoints << "\n";
     ss << "  Valid Data Points: " << metrics.validDataPoints << "\n";
     ss << "  Rejected Data Points: " << metrics.rejectedDataPoints << "\n";
+    ss << "  Coalesced Data Points: " << metrics.coalescedDataPoints << "\n";
+    ss << "  Dropped Data Points: " << metrics.droppedDataPoints << "\n";
     
     return ss.str();
 }
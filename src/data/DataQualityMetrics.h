@@ -2,19 +2,28 @@
 
 #include <string>
 #include <deque>
-#include <unordered_map>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
 #include <chrono>
 #include <vector>
+#include <cstdint>
 #include <cmath>
+#include "LatencyHistogram.h"
+#include "SourceRegistry.h"
+#include "../common/StateStream.h"
 
 namespace novacrypt {
 
 struct DataQualityMetrics {
-    // Timeliness metrics
+    // Timeliness metrics, over the tracker's recent latency window
     double averageLatency{0.0};  // in milliseconds
     double maxLatency{0.0};      // in milliseconds
     double latencyStdDev{0.0};   // in milliseconds
+    double latencyP50{0.0};      // in microseconds
+    double latencyP99{0.0};      // in microseconds
+    double latencyP999{0.0};     // in microseconds
     
     // Completeness metrics
     double dataCompleteness{0.0};  // percentage
@@ -32,53 +41,157 @@ struct DataQualityMetrics {
     size_t totalDataPoints{0};
     size_t validDataPoints{0};
     size_t rejectedDataPoints{0};
+    size_t coalescedDataPoints{0};  // accepted, then merged into a newer update before processing
+    size_t droppedDataPoints{0};    // accepted, then evicted from a full queue before processing
     
     // Timestamp of the metrics
     std::chrono::system_clock::time_point timestamp;
 };
 
+// Per-source quality tracker. Sources map to SourceId handles through a
+// SourceRegistry, and each source owns its own cache-line-aligned counters
+// and latency histogram, so feeds recording concurrently never touch the same
+// lock or cache line. Reports merge the per-source state on read.
 class DataQualityTracker {
 public:
-    explicit DataQualityTracker(size_t historySize = 1000);
+    // Snapshots are appended to each source's history at most once per
+    // snapshotInterval, never per recorded event. Pass a registry to share
+    // source handles with other components.
+    explicit DataQualityTracker(size_t historySize = 1000,
+                                std::chrono::milliseconds snapshotInterval = std::chrono::seconds(1),
+                                std::shared_ptr<SourceRegistry> registry = nullptr);
+    ~DataQualityTracker();
+    
+    DataQualityTracker(const DataQualityTracker&) = delete;
+    DataQualityTracker& operator=(const DataQualityTracker&) = delete;
+    
+    SourceId registerSource(const std::string& source);
+    std::shared_ptr<SourceRegistry> getSourceRegistry() const;
     
     // Update metrics for a specific data source
     void updateMetrics(const std::string& source, const DataQualityMetrics& metrics);
     
-    // Record individual metrics
-    void recordLatency(const std::string& source, std::chrono::milliseconds latency);
+    // Record individual metrics. The SourceId overloads are the hot path;
+    // the string overloads resolve the handle first.
+    void recordLatency(SourceId source, std::chrono::microseconds latency);
+    void recordDataPoint(SourceId source, bool isValid);
+    // A whole batch at once, e.g. from sentiment batch ingestion
+    void recordDataPoints(SourceId source, size_t valid, size_t rejected);
+    void recordPriceAccuracy(SourceId source, bool isAccurate);
+    void recordVolumeAccuracy(SourceId source, bool isAccurate);
+    void recordOrderBookAccuracy(SourceId source, bool isAccurate);
+    // Accepted updates that a conflating queue merged away; accuracy rates
+    // exclude them since they never reach processing
+    void recordCoalesced(SourceId source, size_t count = 1);
+    // Accepted updates evicted from a full queue; likewise excluded
+    void recordDropped(SourceId source, size_t count = 1);
+    void recordLatency(const std::string& source, std::chrono::microseconds latency);
     void recordDataPoint(const std::string& source, bool isValid);
     void recordPriceAccuracy(const std::string& source, bool isAccurate);
     void recordVolumeAccuracy(const std::string& source, bool isAccurate);
     void recordOrderBookAccuracy(const std::string& source, bool isAccurate);
+    void recordCoalesced(const std::string& source, size_t count = 1);
+    void recordDropped(const std::string& source, size_t count = 1);
+    
+    // Append a snapshot of every source to its history
+    void takeSnapshot();
+    // takeSnapshot() if the snapshot interval has elapsed; cheap otherwise
+    bool snapshotIfDue();
+    void setSnapshotInterval(std::chrono::milliseconds interval);
     
-    // Get metrics
+    // Latency metrics cover the last one to two windows (default one
+    // minute), so a long-running process keeps reporting current latency.
+    // Windows rotate as snapshots are taken. Counters and the cumulative
+    // histograms from getLatencySnapshot() are unaffected.
+    void setLatencyWindow(std::chrono::milliseconds window);
+    // Restart every source's latency window from now
+    void resetLatencyWindow();
+    
+    // Get metrics; latest values are computed from the live counters
+    DataQualityMetrics getLatestMetrics(SourceId source) const;
     DataQualityMetrics getLatestMetrics(const std::string& source) const;
+    // All sources merged into one set of metrics
+    DataQualityMetrics getAggregateMetrics() const;
+    // Copy of the source's feed latency histogram (microseconds) since
+    // startup; empty for sources that never recorded
+    LatencyHistogram::Snapshot getLatencySnapshot(SourceId source) const;
+    // The same, restricted to the current latency window
+    LatencyHistogram::Snapshot getRecentLatencySnapshot(SourceId source) const;
     std::vector<DataQualityMetrics> getMetricsHistory(const std::string& source) const;
     double getSourceReliability(const std::string& source) const;
     
+    // Checkpoint every source's counters and latency histogram, keyed by
+    // source name. Snapshot histories are not included. Saving may run while
+    // feeds record; load before ingest starts, since it replaces the counts.
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+    
     // Generate reports
     std::string generateQualityReport(const std::string& source) const;
     std::string generateSummaryReport() const;
 
 private:
-    struct SourceMetrics {
+    struct alignas(64) SourceCounters {
+        std::atomic<size_t> totalDataPoints{0};
+        std::atomic<size_t> validDataPoints{0};
+        std::atomic<size_t> rejectedDataPoints{0};
+        std::atomic<size_t> accuratePricePoints{0};
+        std::atomic<size_t> accurateVolumePoints{0};
+        std::atomic<size_t> accurateOrderBookPoints{0};
+        std::atomic<size_t> coalescedDataPoints{0};
+        std::atomic<size_t> droppedDataPoints{0};
+    };
+    
+    // Merged view of one or more sources' state
+    struct MetricsTotals {
+        size_t total{0};
+        size_t valid{0};
+        size_t rejected{0};
+        size_t accuratePrice{0};
+        size_t accurateVolume{0};
+        size_t accurateOrderBook{0};
+        size_t coalesced{0};
+        size_t dropped{0};
+        LatencyHistogram::Snapshot latency;  // microseconds, latency window only
+    };
+    
+    struct alignas(64) SourceMetrics {
+        SourceCounters counters;
+        
+        LatencyHistogram latency;  // microseconds, since startup
+        
+        // Cumulative histogram as of the last two window rotations; the
+        // recent window is everything recorded since the older one
+        alignas(64) mutable std::mutex windowMutex;
+        LatencyHistogram::Snapshot windowStart;
+        LatencyHistogram::Snapshot nextWindowStart;
+        
+        alignas(64) mutable std::mutex historyMutex;
         std::deque<DataQualityMetrics> history;
-        std::deque<std::chrono::milliseconds> latencyHistory;
-        size_t totalDataPoints{0};
-        size_t validDataPoints{0};
-        size_t rejectedDataPoints{0};
-        size_t accuratePricePoints{0};
-        size_t accurateVolumePoints{0};
-        size_t accurateOrderBookPoints{0};
     };
     
-    void updateSourceMetrics(SourceMetrics& metrics, const DataQualityMetrics& newMetrics);
-    void calculateMetrics(SourceMetrics& metrics);
+    SourceMetrics& slot(SourceId source);
+    const SourceMetrics* findSlot(SourceId source) const;
+    const SourceMetrics* findSlot(const std::string& source) const;
+    void appendHistory(SourceMetrics& metrics, const DataQualityMetrics& snapshot);
+    void rotateLatencyWindowIfDue(int64_t now);
+    LatencyHistogram::Snapshot recentLatency(const SourceMetrics& metrics) const;
+    void accumulate(const SourceMetrics& metrics, MetricsTotals& totals) const;
+    DataQualityMetrics calculateMetrics(const MetricsTotals& totals) const;
+    DataQualityMetrics calculateMetrics(const SourceMetrics& metrics) const;
     std::string formatMetrics(const DataQualityMetrics& metrics) const;
     
     size_t historySize_;
-    std::unordered_map<std::string, SourceMetrics> sourceMetrics_;
-    mutable std::mutex metricsMutex_;
+    std::atomic<int64_t> snapshotIntervalNs_;
+    std::atomic<int64_t> nextSnapshotNs_;
+    std::atomic<int64_t> latencyWindowNs_;
+    std::atomic<int64_t> nextRotationNs_;
+    
+    std::shared_ptr<SourceRegistry> registry_;
+    // Indexed by SourceId; slots are created on first use and never freed
+    // until destruction, so recording needs only an acquire load
+    std::unique_ptr<std::atomic<SourceMetrics*>[]> slots_;
+    std::mutex slotCreationMutex_;
 };
 
 } // namespace novacrypt 
\ No newline at end of file
@@ -0,0 +1,243 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ThreadAffinity.h"
+
+namespace novacrypt {
+
+// What a subscriber queue does when a new event arrives while it is full
+enum class OverflowPolicy {
+    Drop,      // discard the incoming event
+    Conflate,  // overwrite the newest pending event, so the subscriber catches up to the latest
+    Block      // make the publisher wait for room
+};
+
+struct SubscriberOptions {
+    std::string name;
+    size_t capacity = 1024;
+    OverflowPolicy overflow = OverflowPolicy::Drop;
+    // Core or node and idle policy of the dispatch thread
+    ThreadPlacement placement;
+};
+
+struct SubscriberStats {
+    uint64_t id{0};
+    std::string name;
+    uint64_t published{0};   // events offered to the subscriber
+    uint64_t delivered{0};   // events handed to its callback
+    uint64_t dropped{0};
+    uint64_t conflated{0};
+    size_t queueDepth{0};    // current lag, in events
+    size_t maxQueueDepth{0};
+};
+
+// Subscription ids are unique across every FanOut in the process
+inline uint64_t nextSubscriptionId() {
+    static std::atomic<uint64_t> next{1};
+    return next.fetch_add(1, std::memory_order_relaxed);
+}
+
+// One-to-many event dispatch. Every subscriber gets its own bounded queue,
+// overflow policy and dispatch thread, so a slow consumer only ever delays
+// itself (or, with Block, the publisher it opted to throttle). Handlers
+// must not subscribe or unsubscribe on the FanOut that is calling them.
+template<typename T>
+class FanOut {
+public:
+    using Handler = std::function<void(const T&)>;
+
+    FanOut() = default;
+    ~FanOut() { clear(); }
+
+    FanOut(const FanOut&) = delete;
+    FanOut& operator=(const FanOut&) = delete;
+
+    uint64_t subscribe(Handler handler, SubscriberOptions options = {}) {
+        auto subscriber = std::make_shared<Subscriber>(nextSubscriptionId(), std::move(handler),
+                                                       std::move(options));
+        subscriber->thread = std::thread(&Subscriber::run, subscriber.get());
+        std::unique_lock<std::shared_mutex> lock(subscribersMutex_);
+        subscribers_.push_back(subscriber);
+        return subscriber->id;
+    }
+
+    // Stops the subscriber's thread after it drains what is already queued
+    bool unsubscribe(uint64_t id) {
+        std::shared_ptr<Subscriber> removed;
+        {
+            std::unique_lock<std::shared_mutex> lock(subscribersMutex_);
+            auto it = std::find_if(subscribers_.begin(), subscribers_.end(),
+                                   [id](const auto& subscriber) { return subscriber->id == id; });
+            if (it == subscribers_.end()) {
+                return false;
+            }
+            removed = *it;
+            subscribers_.erase(it);
+        }
+        removed->shutdown();
+        return true;
+    }
+
+    void clear() {
+        std::vector<std::shared_ptr<Subscriber>> removed;
+        {
+            std::unique_lock<std::shared_mutex> lock(subscribersMutex_);
+            removed.swap(subscribers_);
+        }
+        for (auto& subscriber : removed) {
+            subscriber->shutdown();
+        }
+    }
+
+    void publish(const T& event) {
+        std::shared_lock<std::shared_mutex> lock(subscribersMutex_);
+        for (auto& subscriber : subscribers_) {
+            subscriber->offer(event);
+        }
+    }
+
+    bool empty() const {
+        std::shared_lock<std::shared_mutex> lock(subscribersMutex_);
+        return subscribers_.empty();
+    }
+
+    std::vector<SubscriberStats> stats() const {
+        std::shared_lock<std::shared_mutex> lock(subscribersMutex_);
+        std::vector<SubscriberStats> result;
+        result.reserve(subscribers_.size());
+        for (const auto& subscriber : subscribers_) {
+            result.push_back(subscriber->stats());
+        }
+        return result;
+    }
+
+private:
+    struct Subscriber {
+        Subscriber(uint64_t subscriberId, Handler callback, SubscriberOptions subscriberOptions)
+            : id(subscriberId),
+              handler(std::move(callback)),
+              options(std::move(subscriberOptions)),
+              slots(std::max<size_t>(options.capacity, 1)),
+              head(0),
+              count(0),
+              stopping(false)
+        {
+        }
+
+        void offer(const T& event) {
+            published.fetch_add(1, std::memory_order_relaxed);
+            std::unique_lock<std::mutex> lock(mutex);
+            if (count == slots.size()) {
+                switch (options.overflow) {
+                    case OverflowPolicy::Drop:
+                        dropped.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    case OverflowPolicy::Conflate:
+                        slots[(head + count - 1) % slots.size()] = event;
+                        conflated.fetch_add(1, std::memory_order_relaxed);
+                        return;
+                    case OverflowPolicy::Block:
+                        notFull.wait(lock, [this] { return count < slots.size() || stopping; });
+                        if (stopping) {
+                            dropped.fetch_add(1, std::memory_order_relaxed);
+                            return;
+                        }
+                        break;
+                }
+            }
+            slots[(head + count) % slots.size()] = event;
+            ++count;
+            depth.store(count, std::memory_order_relaxed);
+            if (count > maxDepth.load(std::memory_order_relaxed)) {
+                maxDepth.store(count, std::memory_order_relaxed);
+            }
+            lock.unlock();
+            notEmpty.notify_one();
+        }
+
+        void run() {
+            applyPlacement(options.placement);
+            T event;
+            for (;;) {
+                spinUntil(options.placement.wait, options.placement.spinTime, [this] {
+                    return depth.load(std::memory_order_relaxed) > 0 ||
+                           stopping.load(std::memory_order_relaxed);
+                });
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    notEmpty.wait(lock, [this] { return count > 0 || stopping; });
+                    if (count == 0) {
+                        return;
+                    }
+                    event = std::move(slots[head]);
+                    head = (head + 1) % slots.size();
+                    --count;
+                    depth.store(count, std::memory_order_relaxed);
+                }
+                notFull.notify_one();
+                handler(event);
+                delivered.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        void shutdown() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            notEmpty.notify_all();
+            notFull.notify_all();
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+
+        SubscriberStats stats() const {
+            SubscriberStats result;
+            result.id = id;
+            result.name = options.name;
+            result.published = published.load(std::memory_order_relaxed);
+            result.delivered = delivered.load(std::memory_order_relaxed);
+            result.dropped = dropped.load(std::memory_order_relaxed);
+            result.conflated = conflated.load(std::memory_order_relaxed);
+            result.maxQueueDepth = maxDepth.load(std::memory_order_relaxed);
+            result.queueDepth = depth.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        const uint64_t id;
+        Handler handler;
+        const SubscriberOptions options;
+
+        mutable std::mutex mutex;
+        std::condition_variable notEmpty;
+        std::condition_variable notFull;
+        std::vector<T> slots;
+        size_t head;
+        size_t count;
+        std::atomic<bool> stopping;  // written under mutex, read lock-free while spinning
+        std::thread thread;
+
+        std::atomic<uint64_t> published{0};
+        std::atomic<uint64_t> delivered{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> conflated{0};
+        std::atomic<size_t> depth{0};  // mirrors count so stats() never takes the queue lock
+        std::atomic<size_t> maxDepth{0};
+    };
+
+    std::vector<std::shared_ptr<Subscriber>> subscribers_;
+    mutable std::shared_mutex subscribersMutex_;
+};
+
+} // namespace novacrypt
@@ -0,0 +1,149 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace novacrypt {
+
+// Vector with the first N elements stored inline. Messages that fit never
+// touch the heap when built, copied or moved; deeper ones spill into a heap
+// buffer that grows geometrically. Restricted to trivially copyable element
+// types so copies are plain memcpy.
+template<typename T, size_t N>
+class InlineVector {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "InlineVector elements must be trivially copyable");
+    static_assert(N > 0, "InlineVector needs inline capacity");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    InlineVector() = default;
+
+    InlineVector(std::initializer_list<T> values) {
+        assign(values.begin(), values.end());
+    }
+
+    InlineVector(const std::vector<T>& values) {
+        assign(values.data(), values.data() + values.size());
+    }
+
+    InlineVector(const InlineVector& other) {
+        assign(other.begin(), other.end());
+    }
+
+    InlineVector(InlineVector&& other) noexcept {
+        takeFrom(other);
+    }
+
+    InlineVector& operator=(const InlineVector& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    InlineVector& operator=(InlineVector&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        if (other.heap_) {
+            takeFrom(other);
+        } else {
+            // Inline source: copy into our storage and keep any spill buffer
+            std::memcpy(data(), other.inline_, other.size_ * sizeof(T));
+            size_ = other.size_;
+            other.size_ = 0;
+        }
+        return *this;
+    }
+
+    InlineVector& operator=(const std::vector<T>& values) {
+        assign(values.data(), values.data() + values.size());
+        return *this;
+    }
+
+    void assign(const T* first, const T* last) {
+        size_t count = static_cast<size_t>(last - first);
+        clear();
+        reserve(count);
+        if (count > 0) {
+            std::memcpy(data(), first, count * sizeof(T));
+        }
+        size_ = count;
+    }
+
+    void push_back(const T& value) {
+        if (size_ == capacity_) {
+            reserve(capacity_ * 2);
+        }
+        data()[size_++] = value;
+    }
+
+    template<typename... Args>
+    T& emplace_back(Args&&... args) {
+        push_back(T{std::forward<Args>(args)...});
+        return back();
+    }
+
+    void pop_back() { --size_; }
+    void clear() { size_ = 0; }
+
+    // Capacity never shrinks, so a reused message keeps its spill buffer
+    void reserve(size_t capacity) {
+        if (capacity <= capacity_) return;
+        std::unique_ptr<T[]> grown(new T[capacity]);
+        if (size_ > 0) {
+            std::memcpy(grown.get(), data(), size_ * sizeof(T));
+        }
+        heap_ = std::move(grown);
+        capacity_ = capacity;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+    bool isInline() const { return !heap_; }
+
+    T* data() { return heap_ ? heap_.get() : inline_; }
+    const T* data() const { return heap_ ? heap_.get() : inline_; }
+
+    T& operator[](size_t index) { return data()[index]; }
+    const T& operator[](size_t index) const { return data()[index]; }
+    T& front() { return data()[0]; }
+    const T& front() const { return data()[0]; }
+    T& back() { return data()[size_ - 1]; }
+    const T& back() const { return data()[size_ - 1]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size_; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+
+private:
+    void takeFrom(InlineVector& other) {
+        if (other.heap_) {
+            heap_ = std::move(other.heap_);
+            capacity_ = other.capacity_;
+        } else {
+            capacity_ = N;
+            std::memcpy(inline_, other.inline_, other.size_ * sizeof(T));
+        }
+        size_ = other.size_;
+        other.size_ = 0;
+        other.capacity_ = N;
+    }
+
+    T inline_[N];
+    std::unique_ptr<T[]> heap_;
+    size_t size_{0};
+    size_t capacity_{N};
+};
+
+} // namespace novacrypt
@@ -0,0 +1,118 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+#include <cmath>
+
+namespace novacrypt {
+
+LatencyHistogram::LatencyHistogram()
+    : sum_(0), sumSquares_(0.0), max_(0)
+{
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+    Snapshot result;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        uint64_t count = buckets_[i].load(std::memory_order_relaxed);
+        result.buckets[i] = count;
+        result.count += count;
+    }
+    result.sum = sum_.load(std::memory_order_relaxed);
+    result.sumSquares = sumSquares_.load(std::memory_order_relaxed);
+    result.max = max_.load(std::memory_order_relaxed);
+    return result;
+}
+
+void LatencyHistogram::restore(const Snapshot& snapshot) {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        buckets_[i].store(i < snapshot.buckets.size() ? snapshot.buckets[i] : 0, std::memory_order_relaxed);
+    }
+    sum_.store(snapshot.sum, std::memory_order_relaxed);
+    sumSquares_.store(snapshot.sumSquares, std::memory_order_relaxed);
+    max_.store(snapshot.max, std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    sum_.store(0, std::memory_order_relaxed);
+    sumSquares_.store(0.0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::bucketLowest(size_t index) {
+    if (index < kExactBuckets) {
+        return index;
+    }
+    size_t offset = index - kExactBuckets;
+    unsigned shift = static_cast<unsigned>(offset / kSubBucketCount) + 1;
+    uint64_t sub = kSubBucketCount + offset % kSubBucketCount;
+    return sub << shift;
+}
+
+uint64_t LatencyHistogram::bucketHighest(size_t index) {
+    if (index < kExactBuckets) {
+        return index;
+    }
+    unsigned shift = static_cast<unsigned>((index - kExactBuckets) / kSubBucketCount) + 1;
+    return bucketLowest(index) + ((uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::Snapshot::merge(const Snapshot& other) {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
+    max = std::max(max, other.max);
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Snapshot::since(const Snapshot& earlier) const {
+    Snapshot result;
+    size_t highest = kBucketCount;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        uint64_t before = i < earlier.buckets.size() ? earlier.buckets[i] : 0;
+        uint64_t count = buckets[i] > before ? buckets[i] - before : 0;
+        result.buckets[i] = count;
+        result.count += count;
+        if (count > 0) {
+            highest = i;
+        }
+    }
+    result.sum = sum > earlier.sum ? sum - earlier.sum : 0;
+    result.sumSquares = std::max(0.0, sumSquares - earlier.sumSquares);
+    result.max = highest == kBucketCount ? 0 : std::min(bucketHighest(highest), max);
+    return result;
+}
+
+uint64_t LatencyHistogram::Snapshot::percentile(double quantile) const {
+    if (count == 0) return 0;
+    quantile = std::clamp(quantile, 0.0, 1.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(quantile * count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // Never report beyond the largest value actually recorded
+            return std::min(bucketHighest(i), max);
+        }
+    }
+    return max;
+}
+
+double LatencyHistogram::Snapshot::mean() const {
+    return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+}
+
+double LatencyHistogram::Snapshot::standardDeviation() const {
+    if (count == 0) return 0.0;
+    double average = mean();
+    double variance = sumSquares / count - average * average;
+    return variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
+
+} // namespace novacrypt
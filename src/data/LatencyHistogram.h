@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace novacrypt {
+
+// HDR-style log-bucketed histogram with constant memory. Values below 64 get
+// exact buckets; above that each power of two is split into 32 linear
+// sub-buckets, so any recorded value is reported within ~3% of its true
+// value. Recording is a few uncontended atomic updates and never allocates.
+class LatencyHistogram {
+public:
+    static constexpr unsigned kSubBucketBits = 5;
+    static constexpr size_t kSubBucketCount = size_t(1) << kSubBucketBits;
+    static constexpr size_t kExactBuckets = kSubBucketCount * 2;
+    static constexpr size_t kBucketCount = kExactBuckets + (64 - kSubBucketBits - 1) * kSubBucketCount;
+    
+    // Plain copy of the histogram; used for percentile queries and for
+    // merging several sources
+    struct Snapshot {
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(kBucketCount, 0);
+        uint64_t count{0};
+        uint64_t sum{0};
+        double sumSquares{0.0};
+        uint64_t max{0};
+        
+        void merge(const Snapshot& other);
+        // What the same histogram recorded after `earlier` was taken. The
+        // max is that of the highest occupied bucket, so like percentiles
+        // it is exact to within a bucket.
+        Snapshot since(const Snapshot& earlier) const;
+        
+        // Highest value equivalent to the bucket holding the given quantile
+        // (0.0 to 1.0); 0 when empty
+        uint64_t percentile(double quantile) const;
+        double mean() const;
+        double standardDeviation() const;
+    };
+    
+    LatencyHistogram();
+    
+    void record(uint64_t value) {
+        buckets_[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+        // Squares are kept as a double so second-long latencies cannot overflow
+        double squares = sumSquares_.load(std::memory_order_relaxed);
+        double square = static_cast<double>(value) * static_cast<double>(value);
+        while (!sumSquares_.compare_exchange_weak(squares, squares + square, std::memory_order_relaxed)) {
+        }
+        uint64_t previous = max_.load(std::memory_order_relaxed);
+        while (value > previous &&
+               !max_.compare_exchange_weak(previous, value, std::memory_order_relaxed)) {
+        }
+    }
+    
+    Snapshot snapshot() const;
+    // Replace the contents with a snapshot, e.g. one restored from a checkpoint
+    void restore(const Snapshot& snapshot);
+    void reset();
+    
+    static size_t bucketIndex(uint64_t value) {
+        if (value < kExactBuckets) {
+            return static_cast<size_t>(value);
+        }
+        unsigned msb = 63 - static_cast<unsigned>(__builtin_clzll(value));
+        unsigned shift = msb - kSubBucketBits;
+        size_t sub = static_cast<size_t>(value >> shift) - kSubBucketCount;
+        return kExactBuckets + (msb - kSubBucketBits - 1) * kSubBucketCount + sub;
+    }
+    static uint64_t bucketLowest(size_t index);
+    static uint64_t bucketHighest(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<double> sumSquares_;
+    std::atomic<uint64_t> max_;
+};
+
+} // namespace novacrypt
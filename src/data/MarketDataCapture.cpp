@@ -0,0 +1,392 @@
+#include "MarketDataCapture.h"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <sys/stat.h>
+
+namespace novacrypt {
+
+namespace {
+
+constexpr char kCaptureFileMagic[8] = {'N', 'C', 'C', 'A', 'P', 'T', 'U', 'R'};
+constexpr uint32_t kCaptureFileVersion = 1;
+// The writer is woken early once this much is buffered
+constexpr size_t kWriteThreshold = 1 << 20;
+constexpr auto kWriteInterval = std::chrono::milliseconds(50);
+
+constexpr size_t kMarketDataPayload = sizeof(int64_t) + 3 * sizeof(double) + sizeof(SymbolId);
+constexpr size_t kOrderBookFixedPayload = sizeof(int64_t) + sizeof(double) + sizeof(uint8_t) +
+                                          sizeof(SymbolId) + 2 * sizeof(uint32_t);
+constexpr size_t kLevelPayload = 2 * sizeof(double);
+
+int64_t toNanoseconds(std::chrono::system_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+std::chrono::system_clock::time_point fromNanoseconds(int64_t nanoseconds) {
+    return std::chrono::system_clock::time_point(
+        std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+}
+
+// Sequential decoder over one record payload
+class PayloadReader {
+public:
+    PayloadReader(const char* data, size_t size) : data_(data), remaining_(size) {}
+
+    template<typename T>
+    T get() {
+        T value{};
+        if (remaining_ < sizeof(T)) {
+            throw std::runtime_error("Corrupt capture record");
+        }
+        std::memcpy(&value, data_, sizeof(T));
+        data_ += sizeof(T);
+        remaining_ -= sizeof(T);
+        return value;
+    }
+
+    size_t remaining() const { return remaining_; }
+
+private:
+    const char* data_;
+    size_t remaining_;
+};
+
+void readLevels(PayloadReader& reader, uint32_t count, OrderBookUpdate::Levels& levels) {
+    // Check the count against the payload before reserving for it
+    if (count > reader.remaining() / kLevelPayload) {
+        throw std::runtime_error("Corrupt capture record");
+    }
+    levels.clear();
+    levels.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        double price = reader.get<double>();
+        double volume = reader.get<double>();
+        levels.push_back(OrderBookUpdate::Level{price, volume});
+    }
+}
+
+} // namespace
+
+// CaptureWriter implementation
+CaptureWriter::CaptureWriter(const std::string& path, std::shared_ptr<SourceRegistry> registry,
+                             std::shared_ptr<const Clock> clock, size_t maxBufferedBytes)
+    : file_(nullptr),
+      path_(path),
+      registry_(std::move(registry)),
+      clock_(clock ? std::move(clock) : SystemClock::instance()),
+      maxBufferedBytes_(maxBufferedBytes),
+      bufferedRecords_(0),
+      flushRequested_(0),
+      flushCompleted_(0),
+      stopping_(false)
+{
+    if (!registry_) {
+        throw std::invalid_argument("CaptureWriter needs a source registry");
+    }
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        throw std::runtime_error("Failed to open capture file: " + path);
+    }
+    CaptureFileHeader header{};
+    std::memcpy(header.magic, kCaptureFileMagic, sizeof(kCaptureFileMagic));
+    header.version = kCaptureFileVersion;
+    header.headerSize = sizeof(CaptureFileHeader);
+    if (std::fwrite(&header, sizeof(header), 1, file_) != 1) {
+        std::fclose(file_);
+        throw std::runtime_error("Failed to write capture file header: " + path);
+    }
+    bytesWritten_.store(sizeof(header), std::memory_order_relaxed);
+    buffer_.reserve(kWriteThreshold * 2);
+    sourceWritten_.assign(registry_->capacity(), false);
+    writer_ = std::thread(&CaptureWriter::writerLoop, this);
+}
+
+CaptureWriter::~CaptureWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+    std::fclose(file_);
+}
+
+void CaptureWriter::capture(const MarketDataUpdate& data) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!beginRecord(CaptureRecordType::MarketData, data.source, kMarketDataPayload)) {
+        return;
+    }
+    put(toNanoseconds(data.timestamp));
+    put(data.price);
+    put(data.volume);
+    put(data.confidence);
+    put(data.symbol);
+    bool wake = buffer_.size() >= kWriteThreshold;
+    lock.unlock();
+    if (wake) {
+        wake_.notify_one();
+    }
+}
+
+void CaptureWriter::capture(const OrderBookUpdate& data) {
+    size_t payload = kOrderBookFixedPayload + (data.bids.size() + data.asks.size()) * kLevelPayload;
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!beginRecord(CaptureRecordType::OrderBook, data.source, payload)) {
+        return;
+    }
+    put(toNanoseconds(data.timestamp));
+    put(data.confidence);
+    put(static_cast<uint8_t>(data.type));
+    put(data.symbol);
+    put(static_cast<uint32_t>(data.bids.size()));
+    put(static_cast<uint32_t>(data.asks.size()));
+    for (const auto* side : {&data.bids, &data.asks}) {
+        for (const auto& level : *side) {
+            put(level.price);
+            put(level.volume);
+        }
+    }
+    bool wake = buffer_.size() >= kWriteThreshold;
+    lock.unlock();
+    if (wake) {
+        wake_.notify_one();
+    }
+}
+
+void CaptureWriter::captureSentiment(SourceId source, double sentiment) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!beginRecord(CaptureRecordType::Sentiment, source, sizeof(double))) {
+        return;
+    }
+    put(sentiment);
+    bool wake = buffer_.size() >= kWriteThreshold;
+    lock.unlock();
+    if (wake) {
+        wake_.notify_one();
+    }
+}
+
+void CaptureWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t ticket = ++flushRequested_;
+    wake_.notify_one();
+    flushed_.wait(lock, [&] { return flushCompleted_ >= ticket; });
+    if (failed_.load(std::memory_order_relaxed)) {
+        throw std::runtime_error("Failed to write capture file: " + path_);
+    }
+}
+
+uint64_t CaptureWriter::recordsCaptured() const {
+    return recordsCaptured_.load(std::memory_order_relaxed);
+}
+
+uint64_t CaptureWriter::recordsDropped() const {
+    return recordsDropped_.load(std::memory_order_relaxed);
+}
+
+uint64_t CaptureWriter::bytesWritten() const {
+    return bytesWritten_.load(std::memory_order_relaxed);
+}
+
+bool CaptureWriter::failed() const {
+    return failed_.load(std::memory_order_relaxed);
+}
+
+bool CaptureWriter::beginRecord(CaptureRecordType type, SourceId source, size_t payloadSize) {
+    bool named = source < sourceWritten_.size() && sourceWritten_[source];
+    bool nameSource = !named && registry_->contains(source);
+    const std::string* name = nameSource ? &registry_->name(source) : nullptr;
+    size_t needed = sizeof(CaptureRecordHeader) + payloadSize +
+                    (name ? sizeof(CaptureRecordHeader) + name->size() : 0);
+    if (buffer_.size() + needed > maxBufferedBytes_ || failed_.load(std::memory_order_relaxed)) {
+        recordsDropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    int64_t now = toNanoseconds(clock_->now());
+    if (name) {
+        put(CaptureRecordHeader{CaptureRecordType::Source, 0, source,
+                                static_cast<uint32_t>(name->size()), now});
+        buffer_.insert(buffer_.end(), name->begin(), name->end());
+        sourceWritten_[source] = true;
+    }
+    put(CaptureRecordHeader{type, 0, source, static_cast<uint32_t>(payloadSize), now});
+    ++bufferedRecords_;
+    recordsCaptured_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+template<typename T>
+void CaptureWriter::put(const T& value) {
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    buffer_.insert(buffer_.end(), bytes, bytes + sizeof(T));
+}
+
+void CaptureWriter::writerLoop() {
+    std::vector<char> writing;
+    writing.reserve(buffer_.capacity());
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        wake_.wait_for(lock, kWriteInterval, [this] {
+            return stopping_ || flushRequested_ != flushCompleted_ || buffer_.size() >= kWriteThreshold;
+        });
+        uint64_t ticket = flushRequested_;
+        bool stop = stopping_;
+        writing.swap(buffer_);
+        uint64_t records = bufferedRecords_;
+        bufferedRecords_ = 0;
+        lock.unlock();
+
+        bool ok = true;
+        if (!writing.empty()) {
+            size_t written = std::fwrite(writing.data(), 1, writing.size(), file_);
+            bytesWritten_.fetch_add(written, std::memory_order_relaxed);
+            ok = written == writing.size();
+            writing.clear();
+        }
+        if (ok && (ticket != flushCompleted_ || stop)) {
+            ok = std::fflush(file_) == 0;
+        }
+        if (!ok) {
+            // Anything written after a partial record would be misread, so
+            // the capture ends here
+            failed_.store(true, std::memory_order_relaxed);
+            recordsDropped_.fetch_add(records, std::memory_order_relaxed);
+        }
+
+        lock.lock();
+        if (ticket != flushCompleted_) {
+            flushCompleted_ = ticket;
+            flushed_.notify_all();
+        }
+        if (stop && buffer_.empty()) {
+            return;
+        }
+    }
+}
+
+// CaptureReader implementation
+CaptureReader::CaptureReader(const std::string& path)
+    : file_(std::fopen(path.c_str(), "rb")),
+      path_(path),
+      offset_(0),
+      fileSize_(0),
+      truncated_(false)
+{
+    if (!file_) {
+        throw std::runtime_error("Failed to open capture file: " + path);
+    }
+    CaptureFileHeader header{};
+    if (std::fread(&header, sizeof(header), 1, file_) != 1 ||
+        std::memcmp(header.magic, kCaptureFileMagic, sizeof(kCaptureFileMagic)) != 0) {
+        std::fclose(file_);
+        throw std::runtime_error("Not a capture file: " + path);
+    }
+    if (header.version != kCaptureFileVersion || header.headerSize != sizeof(CaptureFileHeader)) {
+        std::fclose(file_);
+        throw std::runtime_error("Unsupported capture file version: " + path);
+    }
+    offset_ = sizeof(header);
+}
+
+CaptureReader::~CaptureReader() {
+    std::fclose(file_);
+}
+
+bool CaptureReader::next(CaptureRecord& record) {
+    for (;;) {
+        CaptureRecordHeader header{};
+        size_t got = std::fread(&header, 1, sizeof(header), file_);
+        offset_ += got;
+        if (got != sizeof(header)) {
+            truncated_ = got != 0;
+            return false;
+        }
+        // A corrupt size must not turn into a huge allocation
+        if (!available(header.size)) {
+            truncated_ = true;
+            return false;
+        }
+        payload_.resize(header.size);
+        if (!read(payload_.data(), header.size)) {
+            truncated_ = true;
+            return false;
+        }
+
+        if (header.type == CaptureRecordType::Source) {
+            if (sourceNames_.size() <= header.source) {
+                sourceNames_.resize(static_cast<size_t>(header.source) + 1);
+            }
+            sourceNames_[header.source].assign(payload_.data(), payload_.size());
+            continue;
+        }
+
+        PayloadReader reader(payload_.data(), payload_.size());
+        record.type = header.type;
+        record.captureTime = fromNanoseconds(header.captureNs);
+        record.source = header.source;
+        switch (header.type) {
+            case CaptureRecordType::MarketData: {
+                auto& data = record.marketData;
+                data.timestamp = fromNanoseconds(reader.get<int64_t>());
+                data.price = reader.get<double>();
+                data.volume = reader.get<double>();
+                data.confidence = reader.get<double>();
+                data.symbol = reader.get<SymbolId>();
+                data.source = header.source;
+                return true;
+            }
+            case CaptureRecordType::OrderBook: {
+                auto& data = record.orderBook;
+                data.timestamp = fromNanoseconds(reader.get<int64_t>());
+                data.confidence = reader.get<double>();
+                data.type = static_cast<OrderBookUpdate::Type>(reader.get<uint8_t>());
+                data.symbol = reader.get<SymbolId>();
+                uint32_t bidCount = reader.get<uint32_t>();
+                uint32_t askCount = reader.get<uint32_t>();
+                readLevels(reader, bidCount, data.bids);
+                readLevels(reader, askCount, data.asks);
+                data.source = header.source;
+                return true;
+            }
+            case CaptureRecordType::Sentiment:
+                record.sentiment = reader.get<double>();
+                return true;
+            default:
+                // Unknown record types from newer writers are skipped
+                continue;
+        }
+    }
+}
+
+const std::string& CaptureReader::sourceName(SourceId source) const {
+    static const std::string unnamed;
+    return source < sourceNames_.size() ? sourceNames_[source] : unnamed;
+}
+
+bool CaptureReader::truncated() const {
+    return truncated_;
+}
+
+bool CaptureReader::read(void* data, size_t size) {
+    size_t got = size == 0 ? 0 : std::fread(data, 1, size, file_);
+    offset_ += got;
+    return got == size;
+}
+
+bool CaptureReader::available(uint64_t bytes) {
+    if (fileSize_ >= offset_ && fileSize_ - offset_ >= bytes) {
+        return true;
+    }
+    struct stat st;
+    if (::fstat(::fileno(file_), &st) != 0) {
+        throw std::runtime_error("Failed to stat capture file: " + path_);
+    }
+    fileSize_ = static_cast<uint64_t>(st.st_size);
+    return fileSize_ >= offset_ && fileSize_ - offset_ >= bytes;
+}
+
+} // namespace novacrypt
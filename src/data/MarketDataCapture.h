@@ -0,0 +1,156 @@
+#pragma once
+#include "MarketDataPipeline.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace novacrypt {
+
+// Capture file layout (native byte order), append only:
+//
+//   [CaptureFileHeader][record][record]...
+//
+// Each record is a CaptureRecordHeader followed by `size` payload bytes.
+// Record headers carry the capture time, so a replay can reproduce the
+// original pacing and freshness. A source's name is written once, in a Source
+// record ahead of its first data record, so replays can re-intern handles in
+// a different registry. A crash can only lose a trailing partial record.
+struct CaptureFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+};
+
+enum class CaptureRecordType : uint8_t {
+    Source,      // payload: source name
+    MarketData,
+    OrderBook,
+    Sentiment
+};
+
+struct CaptureRecordHeader {
+    CaptureRecordType type;
+    uint8_t reserved;
+    SourceId source;
+    uint32_t size;       // payload bytes
+    int64_t captureNs;   // capture clock, ns since epoch
+};
+
+// Records what enters a pipeline's push methods. Producers only encode into
+// an in-memory buffer; a background thread writes it out, so the capture
+// never does I/O on the hot path. If the writer falls behind by more than
+// maxBufferedBytes, new records are dropped and counted instead of blocking.
+// A failed or short write (e.g. a full disk) ends the capture: the file is
+// left ending in at most one partial record, later records are dropped and
+// counted, and flush() throws.
+class CaptureWriter {
+public:
+    CaptureWriter(const std::string& path, std::shared_ptr<SourceRegistry> registry,
+                  std::shared_ptr<const Clock> clock = nullptr,
+                  size_t maxBufferedBytes = 64 << 20);
+    // Writes everything still buffered
+    ~CaptureWriter();
+
+    CaptureWriter(const CaptureWriter&) = delete;
+    CaptureWriter& operator=(const CaptureWriter&) = delete;
+
+    void capture(const MarketDataUpdate& data);
+    void capture(const OrderBookUpdate& data);
+    void captureSentiment(SourceId source, double sentiment);
+
+    // Blocks until every record captured so far is on disk; throws
+    // std::runtime_error if a write has failed
+    void flush();
+
+    // Records accepted into the buffer, including any later lost to a
+    // failed write
+    uint64_t recordsCaptured() const;
+    // Records refused by a full buffer or a failed capture, plus those in a
+    // write that failed
+    uint64_t recordsDropped() const;
+    uint64_t bytesWritten() const;
+    bool failed() const;
+
+private:
+    // Appends a record header (and the source's name record if needed);
+    // returns false if the buffer is full. Caller holds mutex_.
+    bool beginRecord(CaptureRecordType type, SourceId source, size_t payloadSize);
+    template<typename T>
+    void put(const T& value);
+    void writerLoop();
+
+    std::FILE* file_;
+    std::string path_;
+    std::shared_ptr<SourceRegistry> registry_;
+    std::shared_ptr<const Clock> clock_;
+    size_t maxBufferedBytes_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    std::vector<char> buffer_;     // filled by producers
+    uint64_t bufferedRecords_;     // records in buffer_
+    std::vector<bool> sourceWritten_;
+    uint64_t flushRequested_;
+    uint64_t flushCompleted_;
+    bool stopping_;
+    std::thread writer_;
+
+    std::atomic<uint64_t> recordsCaptured_{0};
+    std::atomic<uint64_t> recordsDropped_{0};
+    std::atomic<uint64_t> bytesWritten_{0};
+    std::atomic<bool> failed_{false};
+};
+
+// One decoded data record. Only the member matching `type` is filled;
+// source handles are the ones that were live at capture time.
+struct CaptureRecord {
+    CaptureRecordType type{CaptureRecordType::MarketData};
+    std::chrono::system_clock::time_point captureTime;
+    SourceId source{kInvalidSourceId};
+    MarketDataUpdate marketData{};
+    OrderBookUpdate orderBook{};
+    double sentiment{0.0};
+};
+
+// Sequential reader for capture files. Source records are consumed
+// internally and exposed through sourceName().
+class CaptureReader {
+public:
+    explicit CaptureReader(const std::string& path);
+    ~CaptureReader();
+
+    CaptureReader(const CaptureReader&) = delete;
+    CaptureReader& operator=(const CaptureReader&) = delete;
+
+    // False at the end of the file, or at a trailing partial record
+    bool next(CaptureRecord& record);
+
+    // Empty if the capture never named the handle
+    const std::string& sourceName(SourceId source) const;
+    // True if reading stopped at a partial record
+    bool truncated() const;
+
+private:
+    bool read(void* data, size_t size);
+    // True if the file holds `bytes` more past the read position; the size
+    // is re-read only when the cached one falls short, as a live capture
+    // may still be growing
+    bool available(uint64_t bytes);
+
+    std::FILE* file_;
+    std::string path_;
+    uint64_t offset_;
+    uint64_t fileSize_;
+    std::vector<std::string> sourceNames_;
+    std::vector<char> payload_;
+    bool truncated_;
+};
+
+} // namespace novacrypt
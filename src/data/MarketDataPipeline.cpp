@@ -2,31 +2,137 @@
 #include <chrono>
 #include <algorithm>
 #include <stdexcept>
+#include "MarketDataCapture.h"
+#include "ThreadAffinity.h"
+#include "Tracing.h"
+#include "WarmupLoader.h"
 
 namespace novacrypt {
 
-MarketDataPipeline::MarketDataPipeline()
-    : running_(false),
+MarketDataPipeline::MarketDataPipeline(std::shared_ptr<DataQualityTracker> qualityTracker)
+    : qualityTracker_(qualityTracker ? std::move(qualityTracker) : std::make_shared<DataQualityTracker>()),
+      sourceRegistry_(qualityTracker_->getSourceRegistry()),
+      clock_(SystemClock::instance()),
+      running_(false),
+      consumerWaiting_(false),
+      pendingUpdates_(false),
+      checkpointRequest_(nullptr),
+      checkpointPending_(false),
+      processingActive_(false),
       updateInterval_(std::chrono::milliseconds(100)),
-      maxQueueSize_(1000)
+      maxQueueSize_(1000),
+      producerMode_(ProducerMode::Multi),
+      processingMode_(ProcessingMode::EventDriven),
+      marketDataQueueMode_(QueueMode::Fifo),
+      orderBookQueueMode_(QueueMode::Fifo),
+      symbols_(std::make_unique<std::atomic<SymbolState*>[]>(kMaxSymbols)),
+      lastMarketDataSymbol_(0),
+      lastOrderBookSymbol_(0),
+      latestSentiment_(std::make_unique<std::atomic<double>[]>(sourceRegistry_->capacity())),
+      evictedBookUpdates_(std::make_unique<std::atomic<uint32_t>[]>(kMaxSymbols)),
+      rejectedBookUpdates_(std::make_unique<std::atomic<uint32_t>[]>(kMaxSymbols)),
+      bookUpdatesEvicted_(false)
 {
-    indicatorManager_ = std::make_unique<IndicatorManager>();
+    for (size_t i = 0; i < kMaxSymbols; ++i) {
+        symbols_[i].store(nullptr, std::memory_order_relaxed);
+        evictedBookUpdates_[i].store(0, std::memory_order_relaxed);
+        rejectedBookUpdates_[i].store(0, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < sourceRegistry_->capacity(); ++i) {
+        latestSentiment_[i].store(0.0, std::memory_order_relaxed);
+    }
+    createQueues();
     sentimentAnalyzer_ = std::make_unique<SentimentAnalyzer>();
 }
 
 MarketDataPipeline::~MarketDataPipeline() {
     stop();
+    for (size_t i = 0; i < kMaxSymbols; ++i) {
+        delete symbols_[i].load(std::memory_order_relaxed);
+    }
 }
 
 void MarketDataPipeline::start() {
     if (running_) return;
     running_ = true;
-    processingThread_ = std::thread(&MarketDataPipeline::processLoop, this);
+    {
+        std::lock_guard<std::mutex> lock(checkpointMutex_);
+        processingActive_ = true;
+    }
+    if (!placement_.pinned()) {
+        processingThread_ = std::thread(&MarketDataPipeline::processLoop, this);
+        return;
+    }
+    // The queues were already allocated on the placement's node when it was
+    // set, so nothing producers push into changes here
+    processingThread_ = std::thread([this] {
+        applyPlacement(placement_);
+        processLoop();
+    });
+}
+
+void MarketDataPipeline::setCpuAffinity(int core) {
+    ThreadPlacement placement = placement_;
+    placement.core = core;
+    setThreadPlacement(placement);
+}
+
+void MarketDataPipeline::setThreadPlacement(const ThreadPlacement& placement) {
+    if (running_) {
+        throw std::runtime_error("Cannot change thread placement while the pipeline is running");
+    }
+    placement_ = placement;
+    createQueues();
+}
+
+ThreadPlacement MarketDataPipeline::getThreadPlacement() const {
+    return placement_;
+}
+
+void MarketDataPipeline::applyWarmup(WarmupResult&& warmup) {
+    if (running_) {
+        throw std::runtime_error("Cannot apply warm-up state while the pipeline is running");
+    }
+    for (auto& warmed : warmup.symbols) {
+        if (!warmed || warmed->symbol >= kMaxSymbols) {
+            continue;
+        }
+        auto& state = symbolState(warmed->symbol);
+        state.candles = warmed->candles;
+        for (size_t i = 0; i < kTimeframeCount; ++i) {
+            auto timeframe = static_cast<Timeframe>(i);
+            state.timeframeIndicators[i] = std::move(warmed->timeframeIndicators[i]);
+            if (warmed->bars[i] > 0) {
+                state.closedBars[i].store(warmed->closedBars[i]);
+            }
+            if (state.candles.hasOpenBar(timeframe)) {
+                state.openBars[i].store(state.candles.openBar(timeframe));
+            }
+        }
+        if (warmed->hasTick) {
+            MarketDataUpdate tick = warmed->lastTick;
+            tick.source = warmed->lastTickSource.empty() ? kInvalidSourceId
+                                                         : registerSource(warmed->lastTickSource);
+            state.latestMarketData.store(tick);
+            lastMarketDataSymbol_.store(warmed->symbol, std::memory_order_release);
+        }
+    }
+    if (warmup.sentiment) {
+        sentimentAnalyzer_ = std::move(warmup.sentiment);
+    }
+    for (const auto& entry : warmup.latestSentiment) {
+        if (!entry.first.empty()) {
+            latestSentiment_[registerSource(entry.first)].store(entry.second, std::memory_order_relaxed);
+        }
+    }
 }
 
 void MarketDataPipeline::stop() {
     if (!running_) return;
-    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(queueConditionMutex_);
+        running_ = false;
+    }
     queueCondition_.notify_all();
     if (processingThread_.joinable()) {
         processingThread_.join();
@@ -34,48 +140,189 @@ void MarketDataPipeline::stop() {
 }
 
 void MarketDataPipeline::pushMarketData(const MarketDataUpdate& data) {
+    pushMarketData(MarketDataUpdate(data));
+}
+
+void MarketDataPipeline::pushMarketData(MarketDataUpdate&& data) {
+    if (captureWriter_) {
+        captureWriter_->capture(data);
+    }
     if (!validateMarketData(data)) {
-        qualityTracker_.recordDataPoint(data.source, false);
+        if (sourceRegistry_->contains(data.source)) {
+            qualityTracker_->recordDataPoint(data.source, false);
+        }
         throw std::runtime_error("Invalid market data received");
     }
-    auto now = std::chrono::system_clock::now();
-    auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(now - data.timestamp);
-    qualityTracker_.recordLatency(data.source, latency);
-    qualityTracker_.recordDataPoint(data.source, true);
-    pushToQueue(marketDataQueue_, data, marketDataMutex_);
+    recordAccepted(data.source, data.timestamp);
+    if (marketDataConflatingQueue_) {
+        ConflatedTick tick;
+        static_cast<MarketDataUpdate&>(tick) = data;
+        tick.run = TickRun{data.price, data.price, data.price, data.price, data.volume, data.timestamp, 1};
+        pushToQueue(*marketDataConflatingQueue_, std::move(tick));
+    } else {
+        pushToQueue(*marketDataQueue_, std::move(data));
+    }
 }
 
 void MarketDataPipeline::pushOrderBook(const OrderBookUpdate& data) {
+    pushOrderBook(OrderBookUpdate(data));
+}
+
+void MarketDataPipeline::pushOrderBook(OrderBookUpdate&& data) {
+    if (captureWriter_) {
+        captureWriter_->capture(data);
+    }
     if (!validateOrderBook(data)) {
-        qualityTracker_.recordDataPoint(data.source, false);
+        if (sourceRegistry_->contains(data.source)) {
+            qualityTracker_->recordDataPoint(data.source, false);
+            if (data.symbol < kMaxSymbols) {
+                // Later deltas build on this one, so the book is out of sync
+                rejectedBookUpdates_[data.symbol].fetch_add(1, std::memory_order_release);
+            }
+        }
         throw std::runtime_error("Invalid order book data received");
     }
-    auto now = std::chrono::system_clock::now();
-    auto latency = std::chrono::duration_cast<std::chrono::milliseconds>(now - data.timestamp);
-    qualityTracker_.recordLatency(data.source, latency);
-    qualityTracker_.recordDataPoint(data.source, true);
-    pushToQueue(orderBookQueue_, data, orderBookMutex_);
+    recordAccepted(data.source, data.timestamp);
+    if (orderBookConflatingQueue_) {
+        pushToQueue(*orderBookConflatingQueue_, std::move(data));
+    } else {
+        pushToQueue(*orderBookQueue_, std::move(data));
+    }
 }
 
-void MarketDataPipeline::pushSentimentData(const std::string& source, double sentiment) {
-    qualityTracker_.recordDataPoint(source, true);
+void MarketDataPipeline::pushSentimentData(SourceId source, double sentiment) {
+    if (captureWriter_) {
+        captureWriter_->captureSentiment(source, sentiment);
+    }
+    if (!sourceRegistry_->contains(source)) {
+        throw std::runtime_error("Sentiment data from unregistered source");
+    }
+    qualityTracker_->recordDataPoint(source, true);
     updateSentiment(source, sentiment);
 }
 
+void MarketDataPipeline::pushSentimentData(const std::string& source, double sentiment) {
+    pushSentimentData(registerSource(source), sentiment);
+}
+
+size_t MarketDataPipeline::pushSentimentBatch(SourceId source, SentimentSource channel, SentimentSpan items) {
+    if (!sourceRegistry_->contains(source)) {
+        throw std::runtime_error("Sentiment data from unregistered source");
+    }
+    size_t accepted = sentimentAnalyzer_->ingest(channel, items);
+    qualityTracker_->recordDataPoints(source, accepted, items.size - accepted);
+    if (accepted == 0) {
+        return 0;
+    }
+    const ScoredSentiment* newest = nullptr;
+    for (const auto& item : items) {
+        if (SentimentAnalyzer::isValid(item) && (!newest || item.timestamp >= newest->timestamp)) {
+            newest = &item;
+        }
+    }
+    updateSentiment(source, newest->score);
+    return accepted;
+}
+
+size_t MarketDataPipeline::pushSentimentBatch(const std::string& source, SentimentSource channel,
+                                              SentimentSpan items) {
+    return pushSentimentBatch(registerSource(source), channel, items);
+}
+
+void MarketDataPipeline::setCaptureWriter(std::shared_ptr<CaptureWriter> writer) {
+    captureWriter_ = std::move(writer);
+}
+
+void MarketDataPipeline::setClock(std::shared_ptr<const Clock> clock) {
+    // Producers and the processing thread read clock_ without a lock
+    if (running_) {
+        throw std::runtime_error("Cannot change the clock while the pipeline is running");
+    }
+    clock_ = clock ? std::move(clock) : SystemClock::instance();
+}
+
+std::shared_ptr<const Clock> MarketDataPipeline::getClock() const {
+    return clock_;
+}
+
+SourceId MarketDataPipeline::registerSource(const std::string& name) {
+    return qualityTracker_->registerSource(name);
+}
+
+std::shared_ptr<SourceRegistry> MarketDataPipeline::getSourceRegistry() const {
+    return sourceRegistry_;
+}
+
 MarketDataUpdate MarketDataPipeline::getLatestMarketData() {
-    std::lock_guard<std::mutex> lock(dataMutex_);
-    return latestMarketData_;
+    return getLatestMarketData(lastMarketDataSymbol_.load(std::memory_order_acquire));
+}
+
+MarketDataUpdate MarketDataPipeline::getLatestMarketData(SymbolId symbol) {
+    const auto* state = findSymbolState(symbol);
+    return state ? state->latestMarketData.load() : MarketDataUpdate{};
 }
 
 OrderBookUpdate MarketDataPipeline::getLatestOrderBook() {
-    std::lock_guard<std::mutex> lock(dataMutex_);
-    return latestOrderBook_;
+    return getLatestOrderBook(lastOrderBookSymbol_.load(std::memory_order_acquire));
+}
+
+OrderBookUpdate MarketDataPipeline::getLatestOrderBook(SymbolId symbol) {
+    OrderBookUpdate book;
+    const auto* state = findSymbolState(symbol);
+    if (!state) {
+        return book;
+    }
+    OrderBookSnapshot snapshot = state->latestOrderBook.load();
+    book.bids.assign(snapshot.bids, snapshot.bids + snapshot.bidCount);
+    book.asks.assign(snapshot.asks, snapshot.asks + snapshot.askCount);
+    book.timestamp = snapshot.timestamp;
+    book.source = snapshot.source;
+    book.confidence = snapshot.confidence;
+    book.symbol = snapshot.symbol;
+    return book;
+}
+
+OrderBookSnapshot MarketDataPipeline::getOrderBookSnapshot(SymbolId symbol) {
+    const auto* state = findSymbolState(symbol);
+    return state ? state->latestOrderBook.load() : OrderBookSnapshot{};
+}
+
+OrderBookMetrics MarketDataPipeline::getOrderBookMetrics() {
+    return getOrderBookMetrics(lastOrderBookSymbol_.load(std::memory_order_acquire));
+}
+
+OrderBookMetrics MarketDataPipeline::getOrderBookMetrics(SymbolId symbol) {
+    return getOrderBookSnapshot(symbol).metrics;
+}
+
+double MarketDataPipeline::getLatestSentiment(SourceId source) {
+    if (!sourceRegistry_->contains(source)) {
+        return 0.0;
+    }
+    return latestSentiment_[source].load(std::memory_order_relaxed);
 }
 
 double MarketDataPipeline::getLatestSentiment(const std::string& source) {
-    std::lock_guard<std::mutex> lock(dataMutex_);
-    auto it = latestSentiment_.find(source);
-    return it != latestSentiment_.end() ? it->second : 0.0;
+    auto id = sourceRegistry_->find(source);
+    return id ? getLatestSentiment(*id) : 0.0;
+}
+
+OHLCV MarketDataPipeline::getOpenBar(SymbolId symbol, Timeframe timeframe) {
+    const auto* state = findSymbolState(symbol);
+    return state ? state->openBars[static_cast<size_t>(timeframe)].load() : OHLCV{};
+}
+
+OHLCV MarketDataPipeline::getLastClosedBar(SymbolId symbol, Timeframe timeframe) {
+    const auto* state = findSymbolState(symbol);
+    return state ? state->closedBars[static_cast<size_t>(timeframe)].load() : OHLCV{};
+}
+
+const SentimentAnalyzer& MarketDataPipeline::getSentimentAnalyzer() const {
+    return *sentimentAnalyzer_;
+}
+
+std::vector<double> MarketDataPipeline::getSentimentFeatures() const {
+    return sentimentAnalyzer_->getSentimentFeatures();
 }
 
 void MarketDataPipeline::setUpdateInterval(std::chrono::milliseconds interval) {
@@ -83,10 +330,70 @@ void MarketDataPipeline::setUpdateInterval(std::chrono::milliseconds interval) {
 }
 
 void MarketDataPipeline::setMaxQueueSize(size_t size) {
+    if (running_) {
+        throw std::runtime_error("Cannot resize queues while the pipeline is running");
+    }
     maxQueueSize_ = size;
+    createQueues();
+}
+
+void MarketDataPipeline::setProducerMode(ProducerMode mode) {
+    if (running_) {
+        throw std::runtime_error("Cannot change producer mode while the pipeline is running");
+    }
+    producerMode_ = mode;
+    createQueues();
+}
+
+void MarketDataPipeline::setMarketDataQueueMode(QueueMode mode) {
+    if (running_) {
+        throw std::runtime_error("Cannot change queue mode while the pipeline is running");
+    }
+    marketDataQueueMode_ = mode;
+    createQueues();
+}
+
+void MarketDataPipeline::setOrderBookQueueMode(QueueMode mode) {
+    if (running_) {
+        throw std::runtime_error("Cannot change queue mode while the pipeline is running");
+    }
+    orderBookQueueMode_ = mode;
+    createQueues();
+}
+
+MarketDataPipeline::QueueMode MarketDataPipeline::getMarketDataQueueMode() const {
+    return marketDataQueueMode_;
+}
+
+MarketDataPipeline::QueueMode MarketDataPipeline::getOrderBookQueueMode() const {
+    return orderBookQueueMode_;
+}
+
+void MarketDataPipeline::setProcessingMode(ProcessingMode mode) {
+    {
+        std::lock_guard<std::mutex> lock(queueConditionMutex_);
+        processingMode_ = mode;
+    }
+    queueCondition_.notify_all();
+}
+
+MarketDataPipeline::ProcessingMode MarketDataPipeline::getProcessingMode() const {
+    return processingMode_;
+}
+
+size_t MarketDataPipeline::getMarketDataQueueSize() const {
+    return marketDataConflatingQueue_ ? marketDataConflatingQueue_->size() : marketDataQueue_->size();
+}
+
+size_t MarketDataPipeline::getOrderBookQueueSize() const {
+    return orderBookConflatingQueue_ ? orderBookConflatingQueue_->size() : orderBookQueue_->size();
 }
 
 bool MarketDataPipeline::validateMarketData(const MarketDataUpdate& data) const {
+    NOVACRYPT_TRACE_SCOPE("pipeline.validate_market_data");
+    if (!sourceRegistry_->contains(data.source) || data.symbol >= kMaxSymbols) {
+        return false;
+    }
     if (!checkDataFreshness(data.timestamp)) {
         return false;
     }
@@ -103,12 +410,31 @@ bool MarketDataPipeline::validateMarketData(const MarketDataUpdate& data) const
 }
 
 bool MarketDataPipeline::validateOrderBook(const OrderBookUpdate& data) const {
+    NOVACRYPT_TRACE_SCOPE("pipeline.validate_order_book");
+    if (!sourceRegistry_->contains(data.source) || data.symbol >= kMaxSymbols) {
+        return false;
+    }
     if (!checkDataFreshness(data.timestamp)) {
         return false;
     }
     if (data.confidence < 0.0 || data.confidence > 1.0) {
         return false;
     }
+    if (data.type == OrderBookUpdate::Type::Delta) {
+        // Diffs only carry changed levels; crossing is checked against the
+        // maintained book when they are applied
+        if (data.bids.empty() && data.asks.empty()) {
+            return false;
+        }
+        for (const auto* side : {&data.bids, &data.asks}) {
+            for (const auto& level : *side) {
+                if (level.price <= 0.0 || level.volume < 0.0) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
     if (data.bids.empty() || data.asks.empty()) {
         return false;
     }
@@ -150,86 +476,630 @@ void MarketDataPipeline::setSentimentCallback(SentimentCallback callback) {
     sentimentCallback_ = std::move(callback);
 }
 
+void MarketDataPipeline::setMarketDataBatchCallback(MarketDataBatchCallback callback) {
+    marketDataBatchCallback_ = std::move(callback);
+}
+
+void MarketDataPipeline::setOrderBookBatchCallback(OrderBookBatchCallback callback) {
+    orderBookBatchCallback_ = std::move(callback);
+}
+
+void MarketDataPipeline::setBarCallback(BarCallback callback) {
+    barCallback_ = std::move(callback);
+}
+
+uint64_t MarketDataPipeline::subscribeMarketData(MarketDataCallback callback, SubscriberOptions options) {
+    return marketDataSubscribers_.subscribe(std::move(callback), std::move(options));
+}
+
+uint64_t MarketDataPipeline::subscribeOrderBook(OrderBookCallback callback, SubscriberOptions options) {
+    return orderBookSubscribers_.subscribe(std::move(callback), std::move(options));
+}
+
+uint64_t MarketDataPipeline::subscribeSentiment(SentimentUpdateCallback callback, SubscriberOptions options) {
+    return sentimentSubscribers_.subscribe(std::move(callback), std::move(options));
+}
+
+bool MarketDataPipeline::unsubscribe(uint64_t subscriptionId) {
+    return marketDataSubscribers_.unsubscribe(subscriptionId) ||
+           orderBookSubscribers_.unsubscribe(subscriptionId) ||
+           sentimentSubscribers_.unsubscribe(subscriptionId);
+}
+
+std::vector<SubscriberStats> MarketDataPipeline::getSubscriberStats() const {
+    std::vector<SubscriberStats> stats = marketDataSubscribers_.stats();
+    auto orderBookStats = orderBookSubscribers_.stats();
+    auto sentimentStats = sentimentSubscribers_.stats();
+    stats.insert(stats.end(), orderBookStats.begin(), orderBookStats.end());
+    stats.insert(stats.end(), sentimentStats.begin(), sentimentStats.end());
+    return stats;
+}
+
 DataQualityMetrics MarketDataPipeline::getDataQualityMetrics(const std::string& source) const {
-    return qualityTracker_.getLatestMetrics(source);
+    return qualityTracker_->getLatestMetrics(source);
 }
 
 std::string MarketDataPipeline::generateDataQualityReport(const std::string& source) const {
-    return qualityTracker_.generateQualityReport(source);
+    return qualityTracker_->generateQualityReport(source);
 }
 
 std::string MarketDataPipeline::generateDataQualitySummary() const {
-    return qualityTracker_.generateSummaryReport();
+    return qualityTracker_->generateSummaryReport();
+}
+
+std::shared_ptr<DataQualityTracker> MarketDataPipeline::getQualityTracker() const {
+    return qualityTracker_;
 }
 
 void MarketDataPipeline::processLoop() {
+    NOVACRYPT_TRACE_THREAD_NAME("market-data-pipeline");
     while (running_) {
-        MarketDataUpdate marketData;
-        OrderBookUpdate orderBook;
-        if (popFromQueue(marketDataQueue_, marketData, marketDataMutex_)) {
-            processMarketData(marketData);
+        if (processingMode_ == ProcessingMode::EventDriven) {
+            // Keep going without a wait while a checkpoint is being sliced
+            if (!checkpointPending_.load(std::memory_order_acquire)) {
+                waitForUpdates();
+            }
+            drainQueues();
+        } else {
+            pollQueues();
+        }
+        if (checkpointPending_.load(std::memory_order_acquire)) {
+            serviceCheckpoint(false);
+        }
+        qualityTracker_->snapshotIfDue();
+    }
+    // Hand symbol state back to callers, finishing any checkpoint first
+    serviceCheckpoint(true);
+}
+
+void MarketDataPipeline::pollQueues() {
+    MarketDataUpdate marketData;
+    OrderBookUpdate orderBook;
+    if (marketDataConflatingQueue_) {
+        ConflatedTick tick;
+        if (popFromQueue(*marketDataConflatingQueue_, tick)) {
+            processMarketData(tick, tick.run);
+        }
+    } else if (popFromQueue(*marketDataQueue_, marketData)) {
+        processMarketData(marketData);
+    }
+    invalidateEvictedBooks();
+    bool haveOrderBook = orderBookConflatingQueue_ ? popFromQueue(*orderBookConflatingQueue_, orderBook)
+                                                   : popFromQueue(*orderBookQueue_, orderBook);
+    if (haveOrderBook) {
+        processOrderBook(orderBook);
+    }
+    std::this_thread::sleep_for(updateInterval_);
+}
+
+void MarketDataPipeline::waitForUpdates() {
+    // Spinning leaves consumerWaiting_ clear, so producers skip the wake-up
+    bool ready = spinUntil(placement_.wait, placement_.spinTime, [this] {
+        return !queuesEmpty() || !running_ || processingMode_ != ProcessingMode::EventDriven ||
+               checkpointPending_.load(std::memory_order_relaxed);
+    });
+    if (ready) {
+        return;
+    }
+    
+    // Announce the wait before the final emptiness check; producers check the
+    // flag after publishing, so one side always sees the other
+    consumerWaiting_.store(true, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!queuesEmpty()) {
+        consumerWaiting_.store(false, std::memory_order_relaxed);
+        return;
+    }
+    
+    std::unique_lock<std::mutex> lock(queueConditionMutex_);
+    queueCondition_.wait_for(lock, updateInterval_, [this] {
+        return pendingUpdates_ || !running_ ||
+               processingMode_ != ProcessingMode::EventDriven;
+    });
+    pendingUpdates_ = false;
+    consumerWaiting_.store(false, std::memory_order_relaxed);
+}
+
+void MarketDataPipeline::drainQueues() {
+    NOVACRYPT_TRACE_SCOPE("pipeline.drain");
+    NOVACRYPT_TRACE_COUNTER("pipeline.market_data_queue_depth", getMarketDataQueueSize());
+    NOVACRYPT_TRACE_COUNTER("pipeline.order_book_queue_depth", getOrderBookQueueSize());
+    if (marketDataConflatingQueue_) {
+        drainQueue(*marketDataConflatingQueue_, conflatedTickBatch_);
+        marketDataBatch_.clear();
+        for (const auto& tick : conflatedTickBatch_) {
+            processMarketData(tick, tick.run);
+            marketDataBatch_.push_back(tick);
         }
-        if (popFromQueue(orderBookQueue_, orderBook, orderBookMutex_)) {
-            processOrderBook(orderBook);
+    } else {
+        drainQueue(*marketDataQueue_, marketDataBatch_);
+        for (const auto& data : marketDataBatch_) {
+            processMarketData(data);
         }
-        std::this_thread::sleep_for(updateInterval_);
+    }
+    if (!marketDataBatch_.empty() && marketDataBatchCallback_) {
+        marketDataBatchCallback_(marketDataBatch_);
+    }
+    
+    invalidateEvictedBooks();
+    if (orderBookConflatingQueue_) {
+        drainQueue(*orderBookConflatingQueue_, orderBookBatch_);
+    } else {
+        drainQueue(*orderBookQueue_, orderBookBatch_);
+    }
+    for (const auto& data : orderBookBatch_) {
+        processOrderBook(data);
+    }
+    if (!orderBookBatch_.empty() && orderBookBatchCallback_) {
+        orderBookBatchCallback_(orderBookBatch_);
     }
 }
 
 void MarketDataPipeline::processMarketData(const MarketDataUpdate& data) {
+    processMarketData(data, TickRun{data.price, data.price, data.price, data.price, data.volume, data.timestamp, 1});
+}
+
+void MarketDataPipeline::processMarketData(const MarketDataUpdate& data, const TickRun& run) {
+    NOVACRYPT_TRACE_SCOPE("pipeline.process_market_data");
+    // Feed timestamp to processing: time in queue plus upstream delay
+    NOVACRYPT_TRACE_COUNTER("pipeline.market_data_age_us",
+        std::chrono::duration_cast<std::chrono::microseconds>(clock_->now() - data.timestamp).count());
+    auto& state = symbolState(data.symbol);
+    state.latestMarketData.store(data);
+    lastMarketDataSymbol_.store(data.symbol, std::memory_order_release);
+    updateCandles(data.symbol, state, run);
     {
-        std::lock_guard<std::mutex> lock(dataMutex_);
-        latestMarketData_ = data;
+        NOVACRYPT_TRACE_SCOPE("pipeline.market_data_callback");
+        if (marketDataCallback_) {
+            marketDataCallback_(data);
+        }
+        marketDataSubscribers_.publish(data);
     }
-    if (marketDataCallback_) {
-        marketDataCallback_(data);
+    qualityTracker_->recordPriceAccuracy(data.source, data.confidence >= 0.95);
+    qualityTracker_->recordVolumeAccuracy(data.source, data.confidence >= 0.90);
+}
+
+void MarketDataPipeline::updateCandles(SymbolId symbol, SymbolState& state, const TickRun& run) {
+    NOVACRYPT_TRACE_SCOPE("pipeline.update_candles");
+    // One pass over the ticks serves every timeframe
+    uint8_t closed = state.candles.addTicks(run);
+    for (size_t i = 0; i < kTimeframeCount; ++i) {
+        auto timeframe = static_cast<Timeframe>(i);
+        if (closed & (1u << i)) {
+            const OHLCV& bar = state.candles.closedBar(timeframe);
+            state.timeframeIndicators[i].update(bar);
+            state.closedBars[i].store(bar);
+            if (barCallback_) {
+                barCallback_(symbol, timeframe, bar, state.timeframeIndicators[i]);
+            }
+        }
+        state.openBars[i].store(state.candles.openBar(timeframe));
     }
-    qualityTracker_.recordPriceAccuracy(data.source, data.confidence >= 0.95);
-    qualityTracker_.recordVolumeAccuracy(data.source, data.confidence >= 0.90);
 }
 
 void MarketDataPipeline::processOrderBook(const OrderBookUpdate& data) {
-    {
-        std::lock_guard<std::mutex> lock(dataMutex_);
-        latestOrderBook_ = data;
+    NOVACRYPT_TRACE_SCOPE("pipeline.process_order_book");
+    NOVACRYPT_TRACE_COUNTER("pipeline.order_book_age_us",
+        std::chrono::duration_cast<std::chrono::microseconds>(clock_->now() - data.timestamp).count());
+    bool applied = false;
+    auto& state = symbolState(data.symbol);
+    auto& book = state.indicators.getOrderBook();
+    if (data.type == OrderBookUpdate::Type::Snapshot) {
+        applied = book.applySnapshot(data.bids, data.asks);
+        state.bookValid = applied;
+        state.bookSource = data.source;
+    } else if (state.bookValid && data.source == state.bookSource) {
+        // A rejected level means the feed and the book disagree
+        applied = book.applyDeltas(data.bids, data.asks);
+        state.bookValid = applied;
     }
-    if (orderBookCallback_) {
-        orderBookCallback_(data);
+    // Checked after applying, so a loss racing with this update invalidates
+    // the book rather than being cleared by it
+    uint32_t lost = rejectedBookUpdates_[data.symbol].exchange(0, std::memory_order_acquire) +
+                    evictedBookUpdates_[data.symbol].exchange(0, std::memory_order_acquire);
+    if (lost > 0) {
+        invalidateBook(state, lost);
+    }
+    publishOrderBook(state, data);
+    lastOrderBookSymbol_.store(data.symbol, std::memory_order_release);
+    {
+        NOVACRYPT_TRACE_SCOPE("pipeline.order_book_callback");
+        if (orderBookCallback_) {
+            orderBookCallback_(data);
+        }
+        orderBookSubscribers_.publish(data);
     }
-    qualityTracker_.recordOrderBookAccuracy(data.source, data.confidence >= 0.95);
+    qualityTracker_->recordOrderBookAccuracy(data.source, applied && data.confidence >= 0.95);
 }
 
-void MarketDataPipeline::updateSentiment(const std::string& source, double sentiment) {
-    std::lock_guard<std::mutex> lock(dataMutex_);
-    latestSentiment_[source] = sentiment;
+void MarketDataPipeline::updateSentiment(SourceId source, double sentiment) {
+    latestSentiment_[source].store(sentiment, std::memory_order_relaxed);
     if (sentimentCallback_) {
-        sentimentCallback_(source, sentiment);
+        sentimentCallback_(sourceRegistry_->name(source), sentiment);
     }
+    sentimentSubscribers_.publish(SentimentUpdate{source, sentiment});
 }
 
-template<typename T>
-void MarketDataPipeline::pushToQueue(std::queue<T>& queue, const T& data, std::mutex& mutex) {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (queue.size() >= maxQueueSize_) {
-        queue.pop();
+void MarketDataPipeline::saveSymbolState(StateWriter& out, size_t symbolsPerSlice) {
+    std::unique_lock<std::mutex> lock(checkpointMutex_);
+    if (!processingActive_) {
+        // Nobody else touches symbol state; holding the lock keeps start() out
+        for (size_t symbol = 0; symbol < kMaxSymbols; ++symbol) {
+            if (const auto* state = symbols_[symbol].load(std::memory_order_acquire)) {
+                saveSymbol(static_cast<SymbolId>(symbol), *state, out);
+            }
+        }
+        return;
+    }
+    CheckpointRequest request{&out, 0, std::max<size_t>(symbolsPerSlice, 1), false};
+    checkpointRequest_ = &request;
+    checkpointPending_.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> wake(queueConditionMutex_);
+        pendingUpdates_ = true;
+    }
+    queueCondition_.notify_one();
+    checkpointDone_.wait(lock, [&request] { return request.done; });
+}
+
+void MarketDataPipeline::serviceCheckpoint(bool finish) {
+    std::lock_guard<std::mutex> lock(checkpointMutex_);
+    if (finish) {
+        processingActive_ = false;
+    }
+    CheckpointRequest* request = checkpointRequest_;
+    if (!request) {
+        return;
+    }
+    size_t written = 0;
+    while (request->nextSymbol < kMaxSymbols && (finish || written < request->symbolsPerSlice)) {
+        size_t symbol = request->nextSymbol++;
+        if (const auto* state = symbols_[symbol].load(std::memory_order_relaxed)) {
+            saveSymbol(static_cast<SymbolId>(symbol), *state, *request->out);
+            ++written;
+        }
+    }
+    if (request->nextSymbol == kMaxSymbols) {
+        request->done = true;
+        checkpointRequest_ = nullptr;
+        checkpointPending_.store(false, std::memory_order_release);
+        checkpointDone_.notify_all();
+    }
+}
+
+void MarketDataPipeline::saveSymbol(SymbolId symbol, const SymbolState& state, StateWriter& out) const {
+    out.put(symbol);
+    size_t block = out.beginBlock();
+    MarketDataUpdate tick = state.latestMarketData.load();
+    out.put(tick.price);
+    out.put(tick.volume);
+    out.putTime(tick.timestamp);
+    out.put(tick.confidence);
+    out.putString(sourceRegistry_->contains(tick.source) ? sourceRegistry_->name(tick.source) : std::string());
+    state.candles.saveState(out);
+    for (size_t i = 0; i < kTimeframeCount; ++i) {
+        state.timeframeIndicators[i].saveState(out);
+        out.put(state.closedBars[i].load());
+    }
+    out.endBlock(block);
+}
+
+void MarketDataPipeline::loadSymbolState(StateReader& in) {
+    while (!in.atEnd()) {
+        auto symbol = in.get<SymbolId>();
+        StateReader payload = in.block();
+        loadSymbol(symbol, payload);
+    }
+}
+
+void MarketDataPipeline::loadSymbol(SymbolId symbol, StateReader& payload) {
+    if (running_) {
+        throw std::runtime_error("Cannot load symbol state while the pipeline is running");
+    }
+    if (symbol >= kMaxSymbols) {
+        throw std::runtime_error("Checkpointed symbol handle out of range");
+    }
+    MarketDataUpdate tick{};
+    tick.symbol = symbol;
+    tick.price = payload.get<double>();
+    tick.volume = payload.get<double>();
+    tick.timestamp = payload.getTime();
+    tick.confidence = payload.get<double>();
+    std::string source = payload.getString();
+    tick.source = source.empty() ? kInvalidSourceId : registerSource(source);
+    
+    auto& state = symbolState(symbol);
+    state.candles.loadState(payload);
+    for (size_t i = 0; i < kTimeframeCount; ++i) {
+        auto timeframe = static_cast<Timeframe>(i);
+        state.timeframeIndicators[i].loadState(payload);
+        state.closedBars[i].store(payload.get<OHLCV>());
+        state.openBars[i].store(state.candles.hasOpenBar(timeframe) ? state.candles.openBar(timeframe) : OHLCV{});
+    }
+    state.latestMarketData.store(tick);
+    if (tick.timestamp != std::chrono::system_clock::time_point{}) {
+        lastMarketDataSymbol_.store(symbol, std::memory_order_release);
+    }
+}
+
+void MarketDataPipeline::saveSentimentState(StateWriter& out) const {
+    size_t sources = sourceRegistry_->size();
+    out.put<uint32_t>(static_cast<uint32_t>(sources));
+    for (size_t id = 0; id < sources; ++id) {
+        out.putString(sourceRegistry_->name(static_cast<SourceId>(id)));
+        out.put(latestSentiment_[id].load(std::memory_order_relaxed));
+    }
+    sentimentAnalyzer_->saveState(out);
+}
+
+void MarketDataPipeline::loadSentimentState(StateReader& in) {
+    uint32_t sources = in.get<uint32_t>();
+    for (uint32_t i = 0; i < sources; ++i) {
+        SourceId source = registerSource(in.getString());
+        latestSentiment_[source].store(in.get<double>(), std::memory_order_relaxed);
+    }
+    sentimentAnalyzer_->loadState(in);
+}
+
+MarketDataPipeline::SymbolState& MarketDataPipeline::symbolState(SymbolId symbol) {
+    // Only the processing thread creates states, so no creation race
+    auto* state = symbols_[symbol].load(std::memory_order_relaxed);
+    if (!state) {
+        state = new SymbolState();
+        symbols_[symbol].store(state, std::memory_order_release);
+    }
+    return *state;
+}
+
+const MarketDataPipeline::SymbolState* MarketDataPipeline::findSymbolState(SymbolId symbol) const {
+    return symbol < kMaxSymbols ? symbols_[symbol].load(std::memory_order_acquire) : nullptr;
+}
+
+void MarketDataPipeline::publishOrderBook(SymbolState& state, const OrderBookUpdate& data) {
+    const auto& book = state.indicators.getOrderBook();
+    OrderBookSnapshot snapshot{};
+    snapshot.timestamp = data.timestamp;
+    snapshot.source = data.source;
+    snapshot.symbol = data.symbol;
+    snapshot.confidence = data.confidence;
+    snapshot.valid = state.bookValid;
+    snapshot.lostUpdates = state.lostBookUpdates;
+    if (!state.bookValid) {
+        state.latestOrderBook.store(snapshot);
+        return;
+    }
+    
+    auto& metrics = snapshot.metrics;
+    metrics.bestBid = book.bestBid();
+    metrics.bestAsk = book.bestAsk();
+    metrics.spread = book.spread();
+    metrics.midPrice = book.midPrice();
+    metrics.bidDepth = book.depth(BookSide::Bid);
+    metrics.askDepth = book.depth(BookSide::Ask);
+    metrics.imbalance = book.imbalance();
+    metrics.slippageEstimate = book.slippageEstimate();
+    
+    snapshot.bidCount = static_cast<uint32_t>(std::min(book.levelCount(BookSide::Bid), OrderBookSnapshot::kDepth));
+    snapshot.askCount = static_cast<uint32_t>(std::min(book.levelCount(BookSide::Ask), OrderBookSnapshot::kDepth));
+    for (uint32_t i = 0; i < snapshot.bidCount; ++i) {
+        const auto& level = book.level(BookSide::Bid, i);
+        snapshot.bids[i] = OrderBookUpdate::Level{level.price, level.quantity};
+    }
+    for (uint32_t i = 0; i < snapshot.askCount; ++i) {
+        const auto& level = book.level(BookSide::Ask, i);
+        snapshot.asks[i] = OrderBookUpdate::Level{level.price, level.quantity};
+    }
+    state.latestOrderBook.store(snapshot);
+}
+
+void MarketDataPipeline::createQueues() {
+    if (placement_.pinned()) {
+        // First touch from a thread placed like the processing thread, so
+        // the queues live on its NUMA node
+        std::thread([this] {
+            applyPlacement(placement_);
+            allocateQueues();
+        }).join();
+    } else {
+        allocateQueues();
+    }
+}
+
+void MarketDataPipeline::allocateQueues() {
+    marketDataQueue_.reset();
+    marketDataConflatingQueue_.reset();
+    if (marketDataQueueMode_ == QueueMode::Conflating) {
+        marketDataConflatingQueue_ = std::make_unique<ConflatingQueue<ConflatedTick, TickMerge>>(maxQueueSize_);
+        conflatedTickBatch_.reserve(maxQueueSize_);
+    } else {
+        marketDataQueue_ = std::make_unique<RingBuffer<MarketDataUpdate>>(maxQueueSize_, producerMode_);
+    }
+    orderBookQueue_.reset();
+    orderBookConflatingQueue_.reset();
+    if (orderBookQueueMode_ == QueueMode::Conflating) {
+        orderBookConflatingQueue_ = std::make_unique<ConflatingQueue<OrderBookUpdate, OrderBookMerge>>(maxQueueSize_);
+    } else {
+        orderBookQueue_ = std::make_unique<RingBuffer<OrderBookUpdate>>(maxQueueSize_, producerMode_);
+    }
+    marketDataBatch_.reserve(maxQueueSize_);
+    orderBookBatch_.reserve(maxQueueSize_);
+}
+
+bool MarketDataPipeline::queuesEmpty() const {
+    return getMarketDataQueueSize() == 0 && getOrderBookQueueSize() == 0;
+}
+
+void MarketDataPipeline::wakeConsumer() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!consumerWaiting_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(queueConditionMutex_);
+        pendingUpdates_ = true;
     }
-    queue.push(data);
     queueCondition_.notify_one();
 }
 
+void MarketDataPipeline::recordAccepted(SourceId source,
+                                        std::chrono::system_clock::time_point timestamp) {
+    auto now = clock_->now();
+    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(now - timestamp);
+    qualityTracker_->recordLatency(source, latency);
+    qualityTracker_->recordDataPoint(source, true);
+}
+
+void MarketDataPipeline::recordDropped(const MarketDataUpdate& data) {
+    qualityTracker_->recordDropped(data.source);
+}
+
+void MarketDataPipeline::recordDropped(const OrderBookUpdate& data) {
+    qualityTracker_->recordDropped(data.source);
+    evictedBookUpdates_[data.symbol].fetch_add(1, std::memory_order_release);
+    bookUpdatesEvicted_.store(true, std::memory_order_release);
+}
+
+void MarketDataPipeline::invalidateEvictedBooks() {
+    // Evictions are rare, so a full scan behind one flag is cheap enough
+    if (!bookUpdatesEvicted_.exchange(false, std::memory_order_acquire)) {
+        return;
+    }
+    for (size_t symbol = 0; symbol < kMaxSymbols; ++symbol) {
+        if (uint32_t lost = evictedBookUpdates_[symbol].exchange(0, std::memory_order_acquire)) {
+            auto& state = symbolState(static_cast<SymbolId>(symbol));
+            invalidateBook(state, lost);
+            // Readers see the invalid book now, not at the symbol's next update
+            OrderBookSnapshot snapshot = state.latestOrderBook.load();
+            snapshot.symbol = static_cast<SymbolId>(symbol);
+            snapshot.valid = false;
+            snapshot.lostUpdates = state.lostBookUpdates;
+            snapshot.metrics = OrderBookMetrics{};
+            snapshot.bidCount = 0;
+            snapshot.askCount = 0;
+            state.latestOrderBook.store(snapshot);
+        }
+    }
+}
+
+void MarketDataPipeline::invalidateBook(SymbolState& state, uint32_t lost) {
+    state.bookValid = false;
+    state.lostBookUpdates += lost;
+}
+
+template<typename T>
+void MarketDataPipeline::pushToQueue(RingBuffer<T>& queue, T&& data) {
+    queue.push(std::move(data), [this](const T& dropped) { recordDropped(dropped); });
+    wakeConsumer();
+}
+
+template<typename T, typename Merge>
+void MarketDataPipeline::pushToQueue(ConflatingQueue<T, Merge>& queue, T&& data) {
+    SourceId source = data.source;
+    uint32_t key = (static_cast<uint32_t>(data.symbol) << 16) | source;
+    auto result = queue.push(key, std::move(data), [this](const T& dropped) { recordDropped(dropped); });
+    if (result == ConflatingQueue<T, Merge>::PushResult::Coalesced) {
+        qualityTracker_->recordCoalesced(source);
+    }
+    wakeConsumer();
+}
+
 template<typename T>
-bool MarketDataPipeline::popFromQueue(std::queue<T>& queue, T& data, std::mutex& mutex) {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (queue.empty()) {
+bool MarketDataPipeline::popFromQueue(RingBuffer<T>& queue, T& data) {
+    return queue.pop(data);
+}
+
+template<typename T, typename Merge>
+bool MarketDataPipeline::popFromQueue(ConflatingQueue<T, Merge>& queue, T& data) {
+    return queue.pop(data);
+}
+
+template<typename Queue, typename T>
+void MarketDataPipeline::drainQueue(Queue& queue, std::vector<T>& batch) {
+    // Bounded by capacity so a flooded stream cannot starve the other one
+    batch.clear();
+    T data;
+    for (size_t i = 0; i < queue.capacity() && queue.pop(data); ++i) {
+        batch.push_back(std::move(data));
+    }
+}
+
+namespace {
+
+// Applies one level change to a best-first side of a book snapshot
+void mergeSnapshotLevel(OrderBookUpdate::Levels& levels, const OrderBookUpdate::Level& change, bool bids) {
+    auto* first = levels.begin();
+    auto* last = levels.end();
+    auto* it = std::find_if(first, last, [&](const OrderBookUpdate::Level& level) {
+        return bids ? level.price <= change.price : level.price >= change.price;
+    });
+    bool found = it != last && it->price == change.price;
+    if (found && change.volume == 0.0) {
+        std::copy(it + 1, last, it);
+        levels.pop_back();
+    } else if (found) {
+        it->volume = change.volume;
+    } else if (change.volume > 0.0) {
+        size_t index = static_cast<size_t>(it - first);
+        levels.push_back(change);
+        std::rotate(levels.begin() + index, levels.end() - 1, levels.end());
+    }
+}
+
+// Folds a later diff into an earlier one; the later volume wins per price
+void mergeDeltaLevel(OrderBookUpdate::Levels& levels, const OrderBookUpdate::Level& change) {
+    auto it = std::find_if(levels.begin(), levels.end(), [&](const OrderBookUpdate::Level& level) {
+        return level.price == change.price;
+    });
+    if (it != levels.end()) {
+        it->volume = change.volume;
+    } else {
+        levels.push_back(change);
+    }
+}
+
+} // namespace
+
+bool MarketDataPipeline::OrderBookMerge::operator()(OrderBookUpdate& pending, OrderBookUpdate&& incoming) const {
+    if (incoming.type == OrderBookUpdate::Type::Snapshot) {
+        pending = std::move(incoming);
+        return true;
+    }
+    // A diff on top of a pending snapshot yields the updated snapshot; on top
+    // of a pending diff it yields their combined diff
+    bool snapshot = pending.type == OrderBookUpdate::Type::Snapshot;
+    for (const auto& level : incoming.bids) {
+        snapshot ? mergeSnapshotLevel(pending.bids, level, true) : mergeDeltaLevel(pending.bids, level);
+    }
+    for (const auto& level : incoming.asks) {
+        snapshot ? mergeSnapshotLevel(pending.asks, level, false) : mergeDeltaLevel(pending.asks, level);
+    }
+    pending.timestamp = incoming.timestamp;
+    pending.confidence = incoming.confidence;
+    return true;
+}
+
+bool MarketDataPipeline::TickMerge::operator()(ConflatedTick& pending, ConflatedTick&& incoming) const {
+    // The 1s bar is the finest timeframe; coarser bars nest inside it
+    if (std::chrono::floor<std::chrono::seconds>(pending.run.timestamp) !=
+        std::chrono::floor<std::chrono::seconds>(incoming.run.timestamp)) {
         return false;
     }
-    data = queue.front();
-    queue.pop();
+    auto& run = pending.run;
+    run.high = std::max(run.high, incoming.run.high);
+    run.low = std::min(run.low, incoming.run.low);
+    run.volume += incoming.run.volume;
+    run.ticks += incoming.run.ticks;
+    // The newest tick stands for the run, as the candles' close does
+    if (incoming.run.timestamp >= run.timestamp) {
+        run.close = incoming.run.close;
+        run.timestamp = incoming.run.timestamp;
+        static_cast<MarketDataUpdate&>(pending) = incoming;
+    }
     return true;
 }
 
 bool MarketDataPipeline::checkDataFreshness(const std::chrono::system_clock::time_point& timestamp) const {
-    auto now = std::chrono::system_clock::now();
+    auto now = clock_->now();
     auto age = std::chrono::duration_cast<std::chrono::seconds>(now - timestamp);
     return age.count() <= 60;
 }
@@ -5,63 +5,239 @@
 #include <memory>
 #include <thread>
 #include <atomic>
-#include <queue>
 #include <mutex>
 #include <condition_variable>
+#include <vector>
 #include <functional>
+#include "CandleAggregator.h"
+#include "Clock.h"
+#include "ConflatingQueue.h"
 #include "DataQualityMetrics.h"
-#include <unordered_map>
+#include "FanOut.h"
+#include "InlineVector.h"
+#include "RingBuffer.h"
+#include "Seqlock.h"
+#include "SourceRegistry.h"
+#include "../common/StateStream.h"
+#include "ThreadAffinity.h"
 
 namespace novacrypt {
 
+class CaptureWriter;
+struct WarmupResult;
+
+// Message types are allocation free: sources are interned SourceId handles
+// (see MarketDataPipeline::registerSource) and book levels live inline up to
+// kInlineLevels per side.
 struct MarketDataUpdate {
     double price;
     double volume;
     std::chrono::system_clock::time_point timestamp;
-    std::string source;
+    SourceId source{kInvalidSourceId};
     double confidence;
+    SymbolId symbol{0};
 };
 
 struct OrderBookUpdate {
+    // Snapshot replaces the whole book (levels best first). Delta lists only
+    // changed levels; a level with zero volume is removed.
+    enum class Type {
+        Snapshot,
+        Delta
+    };
+    
     struct Level {
         double price;
         double volume;
     };
-    std::vector<Level> bids;
-    std::vector<Level> asks;
+    // Deeper books spill to the heap
+    static constexpr size_t kInlineLevels = 32;
+    using Levels = InlineVector<Level, kInlineLevels>;
+    
+    Levels bids;
+    Levels asks;
     std::chrono::system_clock::time_point timestamp;
-    std::string source;
+    SourceId source{kInvalidSourceId};
     double confidence;
+    Type type{Type::Snapshot};
+    SymbolId symbol{0};
 };
 
+inline double levelQuantity(const OrderBookUpdate::Level& level) {
+    return level.volume;
+}
+
+// Top-of-book view of the pipeline's maintained order book
+struct OrderBookMetrics {
+    double bestBid{0.0};
+    double bestAsk{0.0};
+    double spread{0.0};
+    double midPrice{0.0};
+    double bidDepth{0.0};
+    double askDepth{0.0};
+    double imbalance{0.0};
+    double slippageEstimate{0.0};
+};
+
+// Latest sentiment value from one source, as delivered to subscribers
+struct SentimentUpdate {
+    SourceId source{kInvalidSourceId};
+    double sentiment{0.0};
+};
+
+// Fixed-depth copy of a maintained book, published to readers through a
+// double buffer so polling it never blocks the processing thread
+struct OrderBookSnapshot {
+    static constexpr size_t kDepth = 20;
+    
+    std::chrono::system_clock::time_point timestamp;
+    SourceId source{kInvalidSourceId};
+    SymbolId symbol{0};
+    double confidence{0.0};
+    // False until a snapshot arrives and after any book update for the
+    // symbol is lost; levels and metrics are then left empty
+    bool valid{false};
+    uint64_t lostUpdates{0};  // book updates dropped or rejected since startup
+    OrderBookMetrics metrics;
+    uint32_t bidCount{0};
+    uint32_t askCount{0};
+    OrderBookUpdate::Level bids[kDepth];  // best first
+    OrderBookUpdate::Level asks[kDepth];
+};
+
+// Ingest pipeline for up to kMaxSymbols instruments, processed on one
+// worker thread. Each symbol keeps its own latest tick, order book and
+// indicator state. ShardedMarketDataPipeline spreads symbols over several
+// of these.
 class MarketDataPipeline {
 public:
-    MarketDataPipeline();
+    static constexpr size_t kMaxSymbols = 1024;
+    
+    // Pass a tracker to share quality accounting (and source handles) with
+    // other pipelines
+    explicit MarketDataPipeline(std::shared_ptr<DataQualityTracker> qualityTracker = nullptr);
     ~MarketDataPipeline();
     
     // Start/Stop the pipeline
     void start();
     void stop();
+    // Pin the processing thread to a core on the next start(); -1 unpins
+    void setCpuAffinity(int core);
+    // Core or NUMA node and idle policy of the processing thread. When
+    // pinned, the queues are rebuilt right away by a thread placed the same
+    // way, so they are allocated on its node, as is all per-symbol state.
+    // Like the other queue setters this discards queued updates, and no
+    // thread may push while it runs. Throws while running.
+    void setThreadPlacement(const ThreadPlacement& placement);
+    ThreadPlacement getThreadPlacement() const;
+    // Installs state primed by a WarmupLoader: the symbols' candle builders,
+    // timeframe indicators and latest bars and ticks, the sentiment analyzer
+    // and the latest sentiment per source. Throws while running.
+    void applyWarmup(WarmupResult&& warmup);
     
     // Data input methods - only accept real data
     void pushMarketData(const MarketDataUpdate& data);
+    void pushMarketData(MarketDataUpdate&& data);
     void pushOrderBook(const OrderBookUpdate& data);
+    void pushOrderBook(OrderBookUpdate&& data);
+    void pushSentimentData(SourceId source, double sentiment);
     void pushSentimentData(const std::string& source, double sentiment);
+    // Scored items from one scraper channel, folded into the sentiment
+    // analyzer's per-producer buffers rather than the market data queues.
+    // Invalid items count as rejected for the source. The newest accepted
+    // score becomes the source's latest sentiment and is published once per
+    // batch. Returns the number accepted; batches are not captured.
+    size_t pushSentimentBatch(SourceId source, SentimentSource channel, SentimentSpan items);
+    size_t pushSentimentBatch(const std::string& source, SentimentSource channel, SentimentSpan items);
+    
+    // Record every pushed update (valid or not) to a capture file; nullptr
+    // stops. Set while no other thread is pushing.
+    void setCaptureWriter(std::shared_ptr<CaptureWriter> writer);
+    // Clock used for freshness checks and feed latency; nullptr restores the
+    // system clock. Replays install a clock that follows the capture times.
+    // Set while no other thread is pushing; throws while running.
+    void setClock(std::shared_ptr<const Clock> clock);
+    std::shared_ptr<const Clock> getClock() const;
+    
+    // Intern a source name; updates must carry a registered handle
+    SourceId registerSource(const std::string& name);
+    std::shared_ptr<SourceRegistry> getSourceRegistry() const;
     
-    // Get processed data
+    // Get processed data. The symbol-less overloads return whichever symbol
+    // was updated most recently. Reads never take a lock: ticks are
+    // published through a seqlock and books through a double buffer, so
+    // pollers cannot stall processing.
     MarketDataUpdate getLatestMarketData();
+    MarketDataUpdate getLatestMarketData(SymbolId symbol);
+    // The maintained book (built from all snapshots and diffs so far), as a
+    // snapshot message holding the top OrderBookSnapshot::kDepth levels
     OrderBookUpdate getLatestOrderBook();
+    OrderBookUpdate getLatestOrderBook(SymbolId symbol);
+    OrderBookSnapshot getOrderBookSnapshot(SymbolId symbol);
+    OrderBookMetrics getOrderBookMetrics();
+    OrderBookMetrics getOrderBookMetrics(SymbolId symbol);
+    double getLatestSentiment(SourceId source);
     double getLatestSentiment(const std::string& source);
+    // Candles built from the symbol's ticks, per timeframe. The open bar is
+    // still being updated; both are zeroed before the first tick or close.
+    OHLCV getOpenBar(SymbolId symbol, Timeframe timeframe);
+    OHLCV getLastClosedBar(SymbolId symbol, Timeframe timeframe);
+    // Aggregates over everything pushed through pushSentimentBatch
+    const SentimentAnalyzer& getSentimentAnalyzer() const;
+    std::vector<double> getSentimentFeatures() const;
+    
+    // Processing modes: Polling pops one update per stream every updateInterval_,
+    // EventDriven blocks until data arrives and drains each queue in one batch
+    enum class ProcessingMode {
+        Polling,
+        EventDriven
+    };
+    
+    // Queue modes, chosen per stream: Fifo keeps every update and drops the
+    // oldest when full; Conflating keeps one pending update per source and
+    // symbol, merging newer ones into it in place (book diffs are folded
+    // together, snapshots replace) and evicting the oldest key when full.
+    // Ticks only merge within one 1s interval and keep the merged ticks'
+    // volume, high and low, so candles match what Fifo mode builds.
+    // Coalesced and dropped updates are counted by the quality tracker
+    // against their source.
+    //
+    // The maintained order book is built from one source's snapshot and
+    // that source's deltas. A book update that is dropped from either queue
+    // or rejected by validation leaves it out of sync, so the book is marked
+    // invalid (see OrderBookSnapshot::valid) and deltas are ignored until
+    // the next snapshot is processed. A rejection, or an eviction while a
+    // batch is being drained, is only noticed after the symbol's next
+    // update, so a snapshot right behind it may not resync the book; the
+    // one after it will.
+    enum class QueueMode {
+        Fifo,
+        Conflating
+    };
     
     // Configuration
     void setUpdateInterval(std::chrono::milliseconds interval);
     void setMaxQueueSize(size_t size);
+    void setMarketDataQueueMode(QueueMode mode);
+    void setOrderBookQueueMode(QueueMode mode);
+    QueueMode getMarketDataQueueMode() const;
+    QueueMode getOrderBookQueueMode() const;
+    void setProducerMode(ProducerMode mode);
+    void setProcessingMode(ProcessingMode mode);
+    ProcessingMode getProcessingMode() const;
+    
+    // Queue depths
+    size_t getMarketDataQueueSize() const;
+    size_t getOrderBookQueueSize() const;
     
     // Data validation
     bool validateMarketData(const MarketDataUpdate& data) const;
     bool validateOrderBook(const OrderBookUpdate& data) const;
     
-    // Callbacks for data updates
+    // Callbacks for data updates. These run synchronously: market data and
+    // order book callbacks on the processing thread, the sentiment callback
+    // on the pushing thread (concurrently if several threads push). Use the
+    // subscribe* methods below to keep slow consumers off those threads.
     using MarketDataCallback = std::function<void(const MarketDataUpdate&)>;
     using OrderBookCallback = std::function<void(const OrderBookUpdate&)>;
     using SentimentCallback = std::function<void(const std::string&, double)>;
@@ -69,62 +245,215 @@ public:
     void setMarketDataCallback(MarketDataCallback callback);
     void setOrderBookCallback(OrderBookCallback callback);
     void setSentimentCallback(SentimentCallback callback);
+    
+    // Batch callbacks, invoked once per drained batch in EventDriven mode
+    using MarketDataBatchCallback = std::function<void(const std::vector<MarketDataUpdate>&)>;
+    using OrderBookBatchCallback = std::function<void(const std::vector<OrderBookUpdate>&)>;
+    
+    void setMarketDataBatchCallback(MarketDataBatchCallback callback);
+    void setOrderBookBatchCallback(OrderBookBatchCallback callback);
+    
+    // Closed candles, on the processing thread, after the timeframe's
+    // indicators have been updated with the bar. The indicators may only be
+    // read inside the callback.
+    using BarCallback = std::function<void(SymbolId, Timeframe, const OHLCV&, const IndicatorManager&)>;
+    void setBarCallback(BarCallback callback);
+    
+    // Asynchronous subscribers, each with its own bounded queue, overflow
+    // policy and dispatch thread. Subscribing is safe while running.
+    using SentimentUpdateCallback = std::function<void(const SentimentUpdate&)>;
+    uint64_t subscribeMarketData(MarketDataCallback callback, SubscriberOptions options = {});
+    uint64_t subscribeOrderBook(OrderBookCallback callback, SubscriberOptions options = {});
+    uint64_t subscribeSentiment(SentimentUpdateCallback callback, SubscriberOptions options = {});
+    bool unsubscribe(uint64_t subscriptionId);
+    // Delivery and lag counters for every subscriber
+    std::vector<SubscriberStats> getSubscriberStats() const;
 
     // Data quality methods
     DataQualityMetrics getDataQualityMetrics(const std::string& source) const;
     std::string generateDataQualityReport(const std::string& source) const;
     std::string generateDataQualitySummary() const;
+    std::shared_ptr<DataQualityTracker> getQualityTracker() const;
+    
+    // Checkpoint support (see PipelineCheckpointer). saveSymbolState appends
+    // one framed entry per symbol: its latest tick, candle builder, timeframe
+    // indicators and closed bars. While running, the processing thread
+    // serializes symbolsPerSlice symbols at a time between batches, so ingest
+    // keeps flowing during a snapshot; the call blocks until every symbol is
+    // written. Loading throws while running.
+    void saveSymbolState(StateWriter& out, size_t symbolsPerSlice = 16);
+    void loadSymbolState(StateReader& in);
+    // One entry's payload, for callers that route entries across shards
+    void loadSymbol(SymbolId symbol, StateReader& payload);
+    // Latest sentiment per source and the sentiment analyzer; any thread
+    void saveSentimentState(StateWriter& out) const;
+    void loadSentimentState(StateReader& in);
 
 private:
+    // Per-symbol processing state, created on the symbol's first update.
+    // The indicators and candle builder are only touched by the processing
+    // thread; bars are published to readers through seqlocks.
+    struct SymbolState {
+        Seqlock<MarketDataUpdate> latestMarketData;
+        DoubleBuffer<OrderBookSnapshot> latestOrderBook;
+        IndicatorManager indicators;  // holds the order book
+        bool bookValid{false};        // in sync with bookSource's feed
+        SourceId bookSource{kInvalidSourceId};
+        uint64_t lostBookUpdates{0};
+        CandleAggregator candles;
+        std::array<IndicatorManager, kTimeframeCount> timeframeIndicators;  // fed closed bars
+        std::array<Seqlock<OHLCV>, kTimeframeCount> openBars;
+        std::array<Seqlock<OHLCV>, kTimeframeCount> closedBars;
+    };
+    
+    // Folds a newer book update into a pending one
+    struct OrderBookMerge {
+        bool operator()(OrderBookUpdate& pending, OrderBookUpdate&& incoming) const;
+    };
+    
+    // A conflated tick: the newest of the merged ticks, plus the run of
+    // ticks it stands for so candles still see every tick's volume and price
+    struct ConflatedTick : MarketDataUpdate {
+        TickRun run;
+    };
+    // Merges ticks of the same 1s bar and declines the rest, so no run
+    // straddles a bar boundary on any timeframe
+    struct TickMerge {
+        bool operator()(ConflatedTick& pending, ConflatedTick&& incoming) const;
+    };
+    
+    // Possibly shared with other pipelines
+    std::shared_ptr<DataQualityTracker> qualityTracker_;
+    std::shared_ptr<SourceRegistry> sourceRegistry_;
+    
     // Pipeline components
-    std::unique_ptr<IndicatorManager> indicatorManager_;
     std::unique_ptr<SentimentAnalyzer> sentimentAnalyzer_;
+    std::shared_ptr<CaptureWriter> captureWriter_;
+    std::shared_ptr<const Clock> clock_;
     
-    // Data queues with validation
-    std::queue<MarketDataUpdate> marketDataQueue_;
-    std::queue<OrderBookUpdate> orderBookQueue_;
+    // Ingest queues, rebuilt when the size, producer mode, queue mode or
+    // thread placement changes. Each stream uses the lock-free ring in Fifo
+    // mode and the conflating queue otherwise; the unused one is null.
+    std::unique_ptr<RingBuffer<MarketDataUpdate>> marketDataQueue_;
+    std::unique_ptr<RingBuffer<OrderBookUpdate>> orderBookQueue_;
+    std::unique_ptr<ConflatingQueue<ConflatedTick, TickMerge>> marketDataConflatingQueue_;
+    std::unique_ptr<ConflatingQueue<OrderBookUpdate, OrderBookMerge>> orderBookConflatingQueue_;
+    
+    // A saveSymbolState call being served by the processing thread
+    struct CheckpointRequest {
+        StateWriter* out;
+        size_t nextSymbol;
+        size_t symbolsPerSlice;
+        bool done;
+    };
     
     // Threading
     std::thread processingThread_;
     std::atomic<bool> running_;
-    std::mutex marketDataMutex_;
-    std::mutex orderBookMutex_;
-    std::mutex dataMutex_;
+    ThreadPlacement placement_;
+    std::mutex queueConditionMutex_;
     std::condition_variable queueCondition_;
+    std::atomic<bool> consumerWaiting_;
+    bool pendingUpdates_;
+    // Checkpoint hand-off; the request and processingActive_ are guarded by
+    // checkpointMutex_, and processingActive_ means the processing thread
+    // owns the symbol state
+    std::mutex checkpointMutex_;
+    std::condition_variable checkpointDone_;
+    CheckpointRequest* checkpointRequest_;
+    std::atomic<bool> checkpointPending_;
+    bool processingActive_;
     
     // Configuration
     std::chrono::milliseconds updateInterval_;
     size_t maxQueueSize_;
+    ProducerMode producerMode_;
+    std::atomic<ProcessingMode> processingMode_;
+    QueueMode marketDataQueueMode_;
+    QueueMode orderBookQueueMode_;
     
-    // Latest processed data
-    MarketDataUpdate latestMarketData_;
-    OrderBookUpdate latestOrderBook_;
-    std::unordered_map<std::string, double> latestSentiment_;
+    // Batches reused across wakeups so draining does not reallocate
+    std::vector<MarketDataUpdate> marketDataBatch_;
+    std::vector<ConflatedTick> conflatedTickBatch_;
+    std::vector<OrderBookUpdate> orderBookBatch_;
+    
+    // Latest processed data. Symbol slots are published once with release
+    // ordering and freed only on destruction.
+    std::unique_ptr<std::atomic<SymbolState*>[]> symbols_;  // indexed by SymbolId
+    std::atomic<SymbolId> lastMarketDataSymbol_;
+    std::atomic<SymbolId> lastOrderBookSymbol_;
+    std::unique_ptr<std::atomic<double>[]> latestSentiment_;  // indexed by SourceId
+    // Book updates lost on the ingest side since the processing thread last
+    // looked, indexed by SymbolId. An evicted update is older than anything
+    // still queued, so evictions are applied before the next pop; a rejected
+    // one may be newer, so rejections only count after the next update.
+    std::unique_ptr<std::atomic<uint32_t>[]> evictedBookUpdates_;
+    std::unique_ptr<std::atomic<uint32_t>[]> rejectedBookUpdates_;
+    std::atomic<bool> bookUpdatesEvicted_;
     
     // Callbacks
     MarketDataCallback marketDataCallback_;
     OrderBookCallback orderBookCallback_;
     SentimentCallback sentimentCallback_;
+    MarketDataBatchCallback marketDataBatchCallback_;
+    OrderBookBatchCallback orderBookBatchCallback_;
+    BarCallback barCallback_;
+    
+    // Subscriber fan-out; declared last so dispatch threads stop first
+    FanOut<MarketDataUpdate> marketDataSubscribers_;
+    FanOut<OrderBookUpdate> orderBookSubscribers_;
+    FanOut<SentimentUpdate> sentimentSubscribers_;
     
     // Processing methods
     void processLoop();
+    void pollQueues();
+    void waitForUpdates();
+    void drainQueues();
     void processMarketData(const MarketDataUpdate& data);
+    // run covers the ticks a conflating queue merged into data
+    void processMarketData(const MarketDataUpdate& data, const TickRun& run);
+    void updateCandles(SymbolId symbol, SymbolState& state, const TickRun& run);
     void processOrderBook(const OrderBookUpdate& data);
-    void updateSentiment(const std::string& source, double sentiment);
+    void updateSentiment(SourceId source, double sentiment);
+    SymbolState& symbolState(SymbolId symbol);
+    const SymbolState* findSymbolState(SymbolId symbol) const;
+    void publishOrderBook(SymbolState& state, const OrderBookUpdate& data);
+    // Processing thread: write the next slice of a pending checkpoint, or
+    // all of it when finishing
+    void serviceCheckpoint(bool finish);
+    void saveSymbol(SymbolId symbol, const SymbolState& state, StateWriter& out) const;
+    
+    // Queue management
+    // Rebuilds the queues, on the placement's node when pinned
+    void createQueues();
+    void allocateQueues();
+    bool queuesEmpty() const;
+    void wakeConsumer();
+    void recordAccepted(SourceId source, std::chrono::system_clock::time_point timestamp);
+    // An accepted update evicted from a full queue; any producer thread
+    void recordDropped(const MarketDataUpdate& data);
+    void recordDropped(const OrderBookUpdate& data);
+    // Processing thread: marks books that lost updates as out of sync
+    void invalidateEvictedBooks();
+    void invalidateBook(SymbolState& state, uint32_t lost);
     
-    // Queue management with validation
     template<typename T>
-    void pushToQueue(std::queue<T>& queue, const T& data, std::mutex& mutex);
+    void pushToQueue(RingBuffer<T>& queue, T&& data);
+    template<typename T, typename Merge>
+    void pushToQueue(ConflatingQueue<T, Merge>& queue, T&& data);
     
     template<typename T>
-    bool popFromQueue(std::queue<T>& queue, T& data, std::mutex& mutex);
+    bool popFromQueue(RingBuffer<T>& queue, T& data);
+    template<typename T, typename Merge>
+    bool popFromQueue(ConflatingQueue<T, Merge>& queue, T& data);
+    
+    template<typename Queue, typename T>
+    void drainQueue(Queue& queue, std::vector<T>& batch);
     
     // Data quality checks
     bool checkDataFreshness(const std::chrono::system_clock::time_point& timestamp) const;
     bool checkDataConsistency(const OHLCV& data) const;
     bool checkOrderBookConsistency(const OrderBook& data) const;
-
-    DataQualityTracker qualityTracker_;
 };
 
 } // namespace novacrypt 
\ No newline at end of file
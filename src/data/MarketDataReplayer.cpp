@@ -0,0 +1,154 @@
+#include "MarketDataReplayer.h"
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace novacrypt {
+
+namespace {
+
+std::shared_ptr<const Clock> currentClock(MarketDataPipeline& pipeline) {
+    return pipeline.getClock();
+}
+
+std::shared_ptr<const Clock> currentClock(ShardedMarketDataPipeline& pipeline) {
+    return pipeline.shard(0).getClock();
+}
+
+bool pushSentiment(MarketDataPipeline& pipeline, SourceId source, double sentiment) {
+    pipeline.pushSentimentData(source, sentiment);
+    return true;
+}
+
+bool pushSentiment(ShardedMarketDataPipeline&, SourceId, double) {
+    return false;
+}
+
+int64_t toNanoseconds(std::chrono::system_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+} // namespace
+
+MarketDataReplayer::MarketDataReplayer(std::string path, ReplayOptions options)
+    : path_(std::move(path)),
+      options_(options)
+{
+    if (options_.speed < 0.0) {
+        throw std::invalid_argument("Replay speed must not be negative");
+    }
+}
+
+ReplayStats MarketDataReplayer::replay(MarketDataPipeline& pipeline) {
+    return replayInto(pipeline);
+}
+
+ReplayStats MarketDataReplayer::replay(ShardedMarketDataPipeline& pipeline) {
+    return replayInto(pipeline);
+}
+
+template<typename Pipeline>
+ReplayStats MarketDataReplayer::replayInto(Pipeline& pipeline) {
+    CaptureReader reader(path_);
+    ReplayStats stats;
+
+    auto clock = std::make_shared<ManualClock>();
+    auto previousClock = currentClock(pipeline);
+    pipeline.setClock(clock);
+    pipeline.start();
+
+    // Captured handle -> handle in the target registry, resolved on first use
+    std::vector<SourceId> sourceMap;
+    auto mapSource = [&](SourceId captured) {
+        if (captured >= sourceMap.size()) {
+            sourceMap.resize(static_cast<size_t>(captured) + 1, kInvalidSourceId);
+        }
+        if (sourceMap[captured] == kInvalidSourceId) {
+            const auto& name = reader.sourceName(captured);
+            if (!name.empty()) {
+                sourceMap[captured] = pipeline.registerSource(name);
+            }
+        }
+        return sourceMap[captured];
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    bool started = false;
+    std::chrono::system_clock::time_point firstCapture;
+    CaptureRecord record;
+    try {
+        while (reader.next(record)) {
+            if (options_.speed > 0.0) {
+                if (!started) {
+                    firstCapture = record.captureTime;
+                    started = true;
+                }
+                auto offset = std::chrono::nanoseconds(static_cast<int64_t>(
+                    (toNanoseconds(record.captureTime) - toNanoseconds(firstCapture)) / options_.speed));
+                std::this_thread::sleep_until(start + offset);
+            }
+            clock->set(record.captureTime);
+
+            SourceId source = mapSource(record.source);
+            try {
+                switch (record.type) {
+                    case CaptureRecordType::MarketData:
+                        record.marketData.source = source;
+                        pipeline.pushMarketData(std::move(record.marketData));
+                        ++stats.marketData;
+                        break;
+                    case CaptureRecordType::OrderBook:
+                        record.orderBook.source = source;
+                        pipeline.pushOrderBook(std::move(record.orderBook));
+                        ++stats.orderBooks;
+                        break;
+                    case CaptureRecordType::Sentiment:
+                        if (pushSentiment(pipeline, source, record.sentiment)) {
+                            ++stats.sentiment;
+                        } else {
+                            ++stats.skipped;
+                        }
+                        break;
+                    default:
+                        ++stats.skipped;
+                        break;
+                }
+            } catch (const std::runtime_error&) {
+                ++stats.rejected;
+            }
+        }
+        // Stopping with nothing queued means every update was processed
+        while (pipeline.getMarketDataQueueSize() + pipeline.getOrderBookQueueSize() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    } catch (...) {
+        pipeline.stop();
+        pipeline.setClock(previousClock);
+        throw;
+    }
+
+    stats.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start);
+    stats.truncated = reader.truncated();
+    pipeline.stop();
+    pipeline.setClock(previousClock);
+    return stats;
+}
+
+CandleStore MarketDataReplayer::loadTicks(const std::string& path, SymbolId symbol) {
+    CaptureReader reader(path);
+    CandleStore candles;
+    CaptureRecord record;
+    while (reader.next(record)) {
+        if (record.type != CaptureRecordType::MarketData || record.marketData.symbol != symbol) {
+            continue;
+        }
+        const auto& tick = record.marketData;
+        candles.append(toNanoseconds(tick.timestamp), tick.price, tick.price, tick.price,
+                       tick.price, tick.volume);
+    }
+    return candles;
+}
+
+} // namespace novacrypt
@@ -0,0 +1,60 @@
+#pragma once
+#include "CandleStore.h"
+#include "MarketDataCapture.h"
+#include "ShardedMarketDataPipeline.h"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace novacrypt {
+
+struct ReplayOptions {
+    // Playback rate relative to capture time: 1 is real time, 2 twice as
+    // fast. 0 replays as fast as the pipeline accepts updates.
+    double speed = 0.0;
+};
+
+struct ReplayStats {
+    uint64_t marketData{0};
+    uint64_t orderBooks{0};
+    uint64_t sentiment{0};
+    uint64_t rejected{0};  // updates the pipeline refused, as it did live
+    uint64_t skipped{0};   // records the target cannot accept
+    bool truncated{false};
+    std::chrono::nanoseconds elapsed{0};
+
+    uint64_t events() const { return marketData + orderBooks + sentiment; }
+    double eventsPerSecond() const {
+        return elapsed.count() > 0 ? events() * 1e9 / static_cast<double>(elapsed.count()) : 0.0;
+    }
+};
+
+// Feeds a capture file back into a pipeline. While replaying, the pipeline
+// runs on a ManualClock that tracks each record's capture time, so freshness
+// checks and latency accounting see what they saw live no matter how fast
+// the playback runs. Sources are re-interned in the target by name.
+class MarketDataReplayer {
+public:
+    explicit MarketDataReplayer(std::string path, ReplayOptions options = {});
+
+    // Takes a stopped pipeline (the clock cannot change under a running
+    // one): installs the replay clock, starts the pipeline, feeds the
+    // capture and waits for the queues to drain, then stops it and restores
+    // its clock. Throws std::runtime_error if the pipeline is running.
+    ReplayStats replay(MarketDataPipeline& pipeline);
+    // Sharded pipelines take no sentiment; those records are skipped
+    ReplayStats replay(ShardedMarketDataPipeline& pipeline);
+
+    // One symbol's ticks as single-price candles, ready for
+    // Backtester::run(candles.columns())
+    static CandleStore loadTicks(const std::string& path, SymbolId symbol);
+
+private:
+    template<typename Pipeline>
+    ReplayStats replayInto(Pipeline& pipeline);
+
+    std::string path_;
+    ReplayOptions options_;
+};
+
+} // namespace novacrypt
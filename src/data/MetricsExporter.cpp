@@ -0,0 +1,512 @@
+#include "MetricsExporter.h"
+#include "MarketDataPipeline.h"
+#include "ShardedMarketDataPipeline.h"
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace novacrypt {
+
+namespace {
+
+// Bucket bounds of the exported feed latency histogram, in microseconds
+constexpr uint64_t kLatencyBounds[] = {50, 100, 250, 500, 1000, 2500, 5000, 10000,
+                                       25000, 50000, 100000, 250000, 1000000};
+constexpr size_t kLatencyBoundCount = sizeof(kLatencyBounds) / sizeof(kLatencyBounds[0]);
+
+constexpr int kPollTimeoutMs = 100;
+constexpr size_t kMaxRequestBytes = 4096;
+
+// Builds Prometheus text exposition format. Callers emit every sample of a
+// family right after its header.
+class PageWriter {
+public:
+    explicit PageWriter(std::string& out) : out_(out) {}
+
+    void family(const char* name, const char* type, const char* help) {
+        out_ += "# HELP ";
+        out_ += name;
+        out_ += ' ';
+        out_ += help;
+        out_ += "\n# TYPE ";
+        out_ += name;
+        out_ += ' ';
+        out_ += type;
+        out_ += '\n';
+    }
+
+    // labels holds name/value pairs
+    void sample(const char* name, std::initializer_list<std::pair<const char*, const std::string*>> labels,
+                double value, const char* suffix = "") {
+        out_ += name;
+        out_ += suffix;
+        if (labels.size() > 0) {
+            out_ += '{';
+            bool first = true;
+            for (const auto& label : labels) {
+                if (!first) out_ += ',';
+                first = false;
+                out_ += label.first;
+                out_ += "=\"";
+                appendEscaped(*label.second);
+                out_ += '"';
+            }
+            out_ += '}';
+        }
+        out_ += ' ';
+        appendValue(value);
+        out_ += '\n';
+    }
+
+private:
+    void appendEscaped(const std::string& value) {
+        for (char c : value) {
+            switch (c) {
+                case '\\': out_ += "\\\\"; break;
+                case '"': out_ += "\\\""; break;
+                case '\n': out_ += "\\n"; break;
+                default: out_ += c; break;
+            }
+        }
+    }
+
+    void appendValue(double value) {
+        if (std::isnan(value)) {
+            out_ += "NaN";
+        } else if (std::isinf(value)) {
+            out_ += value > 0 ? "+Inf" : "-Inf";
+        } else {
+            char buffer[32];
+            std::snprintf(buffer, sizeof(buffer), "%.10g", value);
+            out_ += buffer;
+        }
+    }
+
+    std::string& out_;
+};
+
+struct ShardView {
+    const std::string* pipeline;
+    std::string shard;
+    const MarketDataPipeline* instance;
+};
+
+struct SourceView {
+    std::string name;
+    DataQualityMetrics metrics;
+    LatencyHistogram::Snapshot latency;
+};
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool sendAll(int socket, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = ::send(socket, data, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+} // namespace
+
+MetricsExporter::MetricsExporter(MetricsExporterOptions options)
+    : options_(std::move(options)),
+      hasPerformance_(false),
+      page_(std::make_shared<const std::string>()),
+      running_(false),
+      listenSocket_(-1),
+      boundPort_(-1),
+      scrapes_(0),
+      exportErrors_(0),
+      lastRenderNs_(0)
+{
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::addPipeline(const std::string& name, const MarketDataPipeline& pipeline) {
+    if (running_) {
+        throw std::runtime_error("Register metrics sources before starting the exporter");
+    }
+    pipelines_.push_back(PipelineEntry{name, &pipeline, nullptr});
+}
+
+void MetricsExporter::addPipeline(const std::string& name, const ShardedMarketDataPipeline& pipeline) {
+    if (running_) {
+        throw std::runtime_error("Register metrics sources before starting the exporter");
+    }
+    pipelines_.push_back(PipelineEntry{name, nullptr, &pipeline});
+}
+
+void MetricsExporter::addQualityTracker(std::shared_ptr<const DataQualityTracker> tracker) {
+    if (running_) {
+        throw std::runtime_error("Register metrics sources before starting the exporter");
+    }
+    // Pipelines sharing a tracker would otherwise export its sources twice
+    if (tracker && std::find(trackers_.begin(), trackers_.end(), tracker) == trackers_.end()) {
+        trackers_.push_back(std::move(tracker));
+    }
+}
+
+void MetricsExporter::publishPerformance(const PerformanceMetrics& metrics) {
+    std::lock_guard<std::mutex> lock(performanceWriteMutex_);
+    performance_.store(metrics);
+    hasPerformance_.store(true, std::memory_order_release);
+}
+
+void MetricsExporter::start() {
+    if (running_) return;
+
+    if (options_.port >= 0) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            throw std::runtime_error(std::string("Cannot create metrics socket: ") + std::strerror(errno));
+        }
+        int reuse = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(options_.port));
+        if (::inet_pton(AF_INET, options_.bindAddress.c_str(), &address.sin_addr) != 1) {
+            ::close(fd);
+            throw std::runtime_error("Invalid metrics bind address: " + options_.bindAddress);
+        }
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, 16) < 0) {
+            std::string error = std::strerror(errno);
+            ::close(fd);
+            throw std::runtime_error("Cannot listen on " + options_.bindAddress + ":" +
+                                     std::to_string(options_.port) + ": " + error);
+        }
+        socklen_t length = sizeof(address);
+        ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length);
+        listenSocket_ = fd;
+        boundPort_ = ntohs(address.sin_port);
+    }
+
+    // Scrapers never see an empty page once start() returns
+    publish(render());
+    running_ = true;
+    collectThread_ = std::thread(&MetricsExporter::collectLoop, this);
+    if (listenSocket_ >= 0) {
+        serveThread_ = std::thread(&MetricsExporter::serveLoop, this);
+    }
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (collectThread_.joinable()) {
+        collectThread_.join();
+    }
+    if (serveThread_.joinable()) {
+        serveThread_.join();
+    }
+    if (listenSocket_ >= 0) {
+        ::close(listenSocket_);
+        listenSocket_ = -1;
+        boundPort_ = -1;
+    }
+}
+
+bool MetricsExporter::isRunning() const {
+    return running_;
+}
+
+int MetricsExporter::boundPort() const {
+    return boundPort_;
+}
+
+std::shared_ptr<const std::string> MetricsExporter::latest() const {
+    std::lock_guard<std::mutex> lock(pageMutex_);
+    return page_;
+}
+
+std::string MetricsExporter::render() const {
+    std::vector<ShardView> shards;
+    for (const auto& entry : pipelines_) {
+        if (entry.pipeline) {
+            shards.push_back(ShardView{&entry.name, "0", entry.pipeline});
+        } else {
+            for (size_t i = 0; i < entry.sharded->shardCount(); ++i) {
+                shards.push_back(ShardView{&entry.name, std::to_string(i), &entry.sharded->shard(i)});
+            }
+        }
+    }
+
+    std::vector<SourceView> sources;
+    for (const auto& tracker : trackers_) {
+        auto registry = tracker->getSourceRegistry();
+        size_t count = registry->size();
+        for (size_t id = 0; id < count; ++id) {
+            auto source = static_cast<SourceId>(id);
+            sources.push_back(SourceView{registry->name(source), tracker->getLatestMetrics(source),
+                                         tracker->getLatencySnapshot(source)});
+        }
+    }
+
+    std::string out;
+    out.reserve(4096 + 2048 * sources.size());
+    PageWriter page(out);
+    static const std::string kMarketData = "market_data";
+    static const std::string kOrderBook = "order_book";
+
+    page.family("novacrypt_pipeline_queue_depth", "gauge", "Updates waiting in a pipeline ingest queue.");
+    for (const auto& shard : shards) {
+        page.sample("novacrypt_pipeline_queue_depth",
+                    {{"pipeline", shard.pipeline}, {"shard", &shard.shard}, {"stream", &kMarketData}},
+                    static_cast<double>(shard.instance->getMarketDataQueueSize()));
+        page.sample("novacrypt_pipeline_queue_depth",
+                    {{"pipeline", shard.pipeline}, {"shard", &shard.shard}, {"stream", &kOrderBook}},
+                    static_cast<double>(shard.instance->getOrderBookQueueSize()));
+    }
+
+    struct SubscriberView {
+        const ShardView* shard;
+        std::string name;
+        SubscriberStats stats;
+    };
+    std::vector<SubscriberView> subscribers;
+    for (const auto& shard : shards) {
+        for (auto& stats : shard.instance->getSubscriberStats()) {
+            std::string name = stats.name.empty() ? std::to_string(stats.id) : stats.name;
+            subscribers.push_back(SubscriberView{&shard, std::move(name), std::move(stats)});
+        }
+    }
+    page.family("novacrypt_subscriber_queue_depth", "gauge", "Events queued for an asynchronous subscriber.");
+    for (const auto& subscriber : subscribers) {
+        page.sample("novacrypt_subscriber_queue_depth",
+                    {{"pipeline", subscriber.shard->pipeline}, {"shard", &subscriber.shard->shard},
+                     {"subscriber", &subscriber.name}},
+                    static_cast<double>(subscriber.stats.queueDepth));
+    }
+    page.family("novacrypt_subscriber_max_queue_depth", "gauge", "Deepest subscriber queue seen.");
+    for (const auto& subscriber : subscribers) {
+        page.sample("novacrypt_subscriber_max_queue_depth",
+                    {{"pipeline", subscriber.shard->pipeline}, {"shard", &subscriber.shard->shard},
+                     {"subscriber", &subscriber.name}},
+                    static_cast<double>(subscriber.stats.maxQueueDepth));
+    }
+    page.family("novacrypt_subscriber_events_total", "counter", "Subscriber events by outcome.");
+    for (const auto& subscriber : subscribers) {
+        static const std::string kOutcomes[] = {"published", "delivered", "dropped", "conflated"};
+        const uint64_t values[] = {subscriber.stats.published, subscriber.stats.delivered,
+                                   subscriber.stats.dropped, subscriber.stats.conflated};
+        for (size_t i = 0; i < 4; ++i) {
+            page.sample("novacrypt_subscriber_events_total",
+                        {{"pipeline", subscriber.shard->pipeline}, {"shard", &subscriber.shard->shard},
+                         {"subscriber", &subscriber.name}, {"outcome", &kOutcomes[i]}},
+                        static_cast<double>(values[i]));
+        }
+    }
+
+    page.family("novacrypt_source_data_points_total", "counter", "Data points received per source by result.");
+    for (const auto& source : sources) {
+        static const std::string kResults[] = {"valid", "rejected", "coalesced", "dropped"};
+        const size_t values[] = {source.metrics.validDataPoints, source.metrics.rejectedDataPoints,
+                                 source.metrics.coalescedDataPoints, source.metrics.droppedDataPoints};
+        for (size_t i = 0; i < 4; ++i) {
+            page.sample("novacrypt_source_data_points_total",
+                        {{"source", &source.name}, {"result", &kResults[i]}}, static_cast<double>(values[i]));
+        }
+    }
+    page.family("novacrypt_source_accuracy_ratio", "gauge", "Share of processed points passing accuracy checks.");
+    for (const auto& source : sources) {
+        static const std::string kKinds[] = {"price", "volume", "order_book"};
+        const double values[] = {source.metrics.priceAccuracy, source.metrics.volumeAccuracy,
+                                 source.metrics.orderBookAccuracy};
+        for (size_t i = 0; i < 3; ++i) {
+            page.sample("novacrypt_source_accuracy_ratio", {{"source", &source.name}, {"kind", &kKinds[i]}},
+                        values[i] / 100.0);
+        }
+    }
+    page.family("novacrypt_source_completeness_ratio", "gauge", "Share of received points that were valid.");
+    for (const auto& source : sources) {
+        page.sample("novacrypt_source_completeness_ratio", {{"source", &source.name}},
+                    source.metrics.dataCompleteness / 100.0);
+    }
+    page.family("novacrypt_source_reliability", "gauge", "Combined source reliability score, 0 to 1.");
+    for (const auto& source : sources) {
+        page.sample("novacrypt_source_reliability", {{"source", &source.name}}, source.metrics.sourceReliability);
+    }
+
+    page.family("novacrypt_feed_latency_microseconds", "histogram", "Feed latency per source.");
+    for (const auto& source : sources) {
+        // Each recorded bucket counts towards the first bound covering its
+        // highest value, so no sample is reported below its true latency
+        uint64_t counts[kLatencyBoundCount] = {};
+        const auto& latency = source.latency;
+        for (size_t i = 0; i < latency.buckets.size(); ++i) {
+            if (latency.buckets[i] == 0) continue;
+            uint64_t highest = LatencyHistogram::bucketHighest(i);
+            size_t bound = static_cast<size_t>(
+                std::lower_bound(kLatencyBounds, kLatencyBounds + kLatencyBoundCount, highest) - kLatencyBounds);
+            if (bound < kLatencyBoundCount) {
+                counts[bound] += latency.buckets[i];
+            }
+        }
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < kLatencyBoundCount; ++i) {
+            cumulative += counts[i];
+            std::string le = std::to_string(kLatencyBounds[i]);
+            page.sample("novacrypt_feed_latency_microseconds", {{"source", &source.name}, {"le", &le}},
+                        static_cast<double>(cumulative), "_bucket");
+        }
+        static const std::string kInf = "+Inf";
+        page.sample("novacrypt_feed_latency_microseconds", {{"source", &source.name}, {"le", &kInf}},
+                    static_cast<double>(latency.count), "_bucket");
+        page.sample("novacrypt_feed_latency_microseconds", {{"source", &source.name}},
+                    static_cast<double>(latency.sum), "_sum");
+        page.sample("novacrypt_feed_latency_microseconds", {{"source", &source.name}},
+                    static_cast<double>(latency.count), "_count");
+    }
+
+    if (hasPerformance_.load(std::memory_order_acquire)) {
+        PerformanceMetrics performance = performance_.load();
+        page.family("novacrypt_performance_total_pnl_percent", "gauge", "Strategy total P&L.");
+        page.sample("novacrypt_performance_total_pnl_percent", {}, performance.totalPnL);
+        page.family("novacrypt_performance_win_rate_percent", "gauge", "Share of winning trades.");
+        page.sample("novacrypt_performance_win_rate_percent", {}, performance.winRate);
+        page.family("novacrypt_performance_average_trade_percent", "gauge", "Average trade return.");
+        page.sample("novacrypt_performance_average_trade_percent", {}, performance.averageTrade);
+        page.family("novacrypt_performance_max_drawdown_percent", "gauge", "Maximum drawdown.");
+        page.sample("novacrypt_performance_max_drawdown_percent", {}, performance.maxDrawdown);
+        page.family("novacrypt_performance_trades", "gauge", "Trades executed by the strategy.");
+        page.sample("novacrypt_performance_trades", {}, static_cast<double>(performance.totalTrades));
+    }
+
+    page.family("novacrypt_exporter_scrapes_total", "counter", "Pages served by the metrics exporter.");
+    page.sample("novacrypt_exporter_scrapes_total", {}, static_cast<double>(scrapes_.load(std::memory_order_relaxed)));
+    page.family("novacrypt_exporter_errors_total", "counter", "Failed textfile writes and client sends.");
+    page.sample("novacrypt_exporter_errors_total", {},
+                static_cast<double>(exportErrors_.load(std::memory_order_relaxed)));
+    page.family("novacrypt_exporter_render_seconds", "gauge", "Time the previous page took to build.");
+    page.sample("novacrypt_exporter_render_seconds", {},
+                static_cast<double>(lastRenderNs_.load(std::memory_order_relaxed)) / 1e9);
+    return out;
+}
+
+void MetricsExporter::collectLoop() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (running_) {
+        lock.unlock();
+        int64_t started = steadyNowNs();
+        std::string page = render();
+        lastRenderNs_.store(steadyNowNs() - started, std::memory_order_relaxed);
+        if (!options_.textfilePath.empty()) {
+            writeTextfile(page);
+        }
+        publish(std::move(page));
+        lock.lock();
+        wake_.wait_for(lock, options_.interval, [this] { return !running_; });
+    }
+}
+
+void MetricsExporter::publish(std::string page) {
+    auto published = std::make_shared<const std::string>(std::move(page));
+    std::lock_guard<std::mutex> lock(pageMutex_);
+    page_ = std::move(published);
+}
+
+void MetricsExporter::writeTextfile(const std::string& page) {
+    std::string temporary = options_.textfilePath + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(page.data(), static_cast<std::streamsize>(page.size()));
+        if (!file) {
+            exportErrors_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    if (std::rename(temporary.c_str(), options_.textfilePath.c_str()) != 0) {
+        exportErrors_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void MetricsExporter::serveLoop() {
+    while (running_) {
+        pollfd listener{listenSocket_, POLLIN, 0};
+        if (::poll(&listener, 1, kPollTimeoutMs) <= 0) {
+            continue;
+        }
+        int client = ::accept(listenSocket_, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+        serveClient(client);
+        ::close(client);
+    }
+}
+
+void MetricsExporter::serveClient(int client) {
+    // A stalled client may hold the server for at most this long
+    timeval timeout{1, 0};
+    ::setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    std::string request;
+    char buffer[1024];
+    while (request.size() < kMaxRequestBytes && request.find("\r\n\r\n") == std::string::npos) {
+        ssize_t received = ::recv(client, buffer, sizeof(buffer), 0);
+        if (received <= 0) break;
+        request.append(buffer, static_cast<size_t>(received));
+    }
+
+    size_t lineEnd = request.find("\r\n");
+    std::string line = request.substr(0, lineEnd);
+    bool head = line.compare(0, 5, "HEAD ") == 0;
+    bool get = line.compare(0, 4, "GET ") == 0;
+    std::string path;
+    if (get || head) {
+        size_t start = line.find(' ') + 1;
+        path = line.substr(start, line.find(' ', start) - start);
+    }
+
+    std::shared_ptr<const std::string> page;
+    const char* status = "200 OK";
+    if (!get && !head) {
+        status = "405 Method Not Allowed";
+    } else if (path == "/metrics" || path == "/") {
+        page = latest();
+    } else {
+        status = "404 Not Found";
+    }
+
+    size_t length = page ? page->size() : 0;
+    std::string header = std::string("HTTP/1.1 ") + status +
+                         "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: " +
+                         std::to_string(length) + "\r\nConnection: close\r\n\r\n";
+    bool sent = sendAll(client, header.data(), header.size());
+    if (sent && page && !head) {
+        sent = sendAll(client, page->data(), page->size());
+    }
+    if (!sent) {
+        exportErrors_.fetch_add(1, std::memory_order_relaxed);
+    } else if (page) {
+        scrapes_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace novacrypt
@@ -0,0 +1,116 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DataQualityMetrics.h"
+#include "Seqlock.h"
+#include "../ui/DashboardFeed.h"
+
+namespace novacrypt {
+
+class MarketDataPipeline;
+class ShardedMarketDataPipeline;
+
+struct MetricsExporterOptions {
+    // How often the exposition page is rebuilt
+    std::chrono::milliseconds interval{1000};
+    // TCP port serving the page over HTTP; 0 picks a free port, negative
+    // disables the socket
+    int port{9464};
+    std::string bindAddress{"127.0.0.1"};
+    // Also written here every interval (write to a temp file, then rename),
+    // e.g. for node_exporter's textfile collector; empty disables
+    std::string textfilePath;
+};
+
+// Headless stats export in the Prometheus text format, for servers that do
+// not run the Dashboard. A background thread periodically gathers pipeline
+// queue depths, subscriber lag, per-source data quality counters and feed
+// latency histograms, and the latest PerformanceMetrics, and formats them
+// into an immutable page. A second thread serves that page to scrapers and
+// never formats anything itself.
+//
+// Gathering reads queue depths and counters from atomics, PerformanceMetrics
+// through a seqlock and histograms through lock-free snapshots, and nothing
+// is formatted on the ingest or processing threads. Two locks are shared
+// with them, each held only to copy a little state:
+//  - each source's windowMutex, while the recent latency window is diffed
+//    against its start. The processing thread takes it in snapshotIfDue to
+//    swap the window when it rotates, once per latency window.
+//  - each FanOut's subscribersMutex_, shared, while copying subscriber
+//    counters. publish() takes it shared as well, so a scrape only delays
+//    a publish queued behind a subscribe or unsubscribe, and then for one
+//    copy of the counters.
+class MetricsExporter {
+public:
+    explicit MetricsExporter(MetricsExporterOptions options = {});
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Register before start(). Pipelines are referenced, not owned, and must
+    // outlive the exporter; name becomes the "pipeline" label.
+    void addPipeline(const std::string& name, const MarketDataPipeline& pipeline);
+    void addPipeline(const std::string& name, const ShardedMarketDataPipeline& pipeline);
+    void addQualityTracker(std::shared_ptr<const DataQualityTracker> tracker);
+
+    // Any thread; picked up by the next rebuild
+    void publishPerformance(const PerformanceMetrics& metrics);
+
+    // Throws std::runtime_error if the socket cannot be bound
+    void start();
+    void stop();
+    bool isRunning() const;
+    // Port being served, or -1 without a socket
+    int boundPort() const;
+
+    // Builds the page now, on the calling thread
+    std::string render() const;
+    // Page last built by the background thread; empty before start()
+    std::shared_ptr<const std::string> latest() const;
+
+private:
+    struct PipelineEntry {
+        std::string name;
+        const MarketDataPipeline* pipeline;
+        const ShardedMarketDataPipeline* sharded;
+    };
+
+    void collectLoop();
+    void serveLoop();
+    void serveClient(int client);
+    void publish(std::string page);
+    void writeTextfile(const std::string& page);
+
+    MetricsExporterOptions options_;
+    std::vector<PipelineEntry> pipelines_;
+    std::vector<std::shared_ptr<const DataQualityTracker>> trackers_;
+
+    std::mutex performanceWriteMutex_;  // Seqlock allows one writer at a time
+    Seqlock<PerformanceMetrics> performance_;
+    std::atomic<bool> hasPerformance_;
+
+    mutable std::mutex pageMutex_;  // guards the pointer swap only
+    std::shared_ptr<const std::string> page_;
+
+    std::atomic<bool> running_;
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    std::thread collectThread_;
+    std::thread serveThread_;
+    int listenSocket_;
+    int boundPort_;
+
+    std::atomic<uint64_t> scrapes_;
+    std::atomic<uint64_t> exportErrors_;
+    std::atomic<int64_t> lastRenderNs_;
+};
+
+} // namespace novacrypt
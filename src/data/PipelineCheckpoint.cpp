@@ -0,0 +1,285 @@
+#include "PipelineCheckpoint.h"
+#include "MarketDataPipeline.h"
+#include "ShardedMarketDataPipeline.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace novacrypt {
+
+namespace {
+
+constexpr char kCheckpointMagic[8] = {'N', 'C', 'C', 'K', 'P', 'O', 'I', 'N'};
+constexpr uint32_t kCheckpointVersion = 5;
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Writes size bytes to a new file at path and fsyncs it before closing
+bool writeSynced(const std::string& path, const char* data, size_t size) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    while (size > 0) {
+        ssize_t written = ::write(fd, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ::close(fd);
+            return false;
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+    bool synced = ::fsync(fd) == 0;
+    return ::close(fd) == 0 && synced;
+}
+
+// Makes a rename within the directory holding path durable
+bool syncParentDirectory(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    return ::close(fd) == 0 && synced;
+}
+
+} // namespace
+
+PipelineCheckpointer::PipelineCheckpointer(CheckpointOptions options,
+                                           std::shared_ptr<DataQualityTracker> tracker)
+    : options_(std::move(options)),
+      pipeline_(nullptr),
+      sharded_(nullptr),
+      tracker_(std::move(tracker)),
+      running_(false),
+      written_(0),
+      errors_(0),
+      lastBytes_(0),
+      lastDurationNs_(0)
+{
+    if (options_.path.empty()) {
+        throw std::invalid_argument("Checkpoint path must not be empty");
+    }
+    if (options_.interval.count() <= 0) {
+        throw std::invalid_argument("Checkpoint interval must be positive");
+    }
+}
+
+PipelineCheckpointer::PipelineCheckpointer(MarketDataPipeline& pipeline, CheckpointOptions options)
+    : PipelineCheckpointer(std::move(options), pipeline.getQualityTracker())
+{
+    pipeline_ = &pipeline;
+}
+
+PipelineCheckpointer::PipelineCheckpointer(ShardedMarketDataPipeline& pipeline, CheckpointOptions options)
+    : PipelineCheckpointer(std::move(options), pipeline.getQualityTracker())
+{
+    sharded_ = &pipeline;
+}
+
+PipelineCheckpointer::~PipelineCheckpointer() {
+    try {
+        stop();
+    } catch (...) {
+        // A failed final checkpoint is already counted in checkpointErrors()
+    }
+}
+
+void PipelineCheckpointer::addSection(const std::string& name, SaveSection save, LoadSection load) {
+    if (running_) {
+        throw std::runtime_error("Cannot add checkpoint sections while running");
+    }
+    if (name == "quality" || name == "sentiment" || name == "symbols") {
+        throw std::invalid_argument("Checkpoint section name is reserved: " + name);
+    }
+    sections_.push_back(Section{name, std::move(save), std::move(load)});
+}
+
+bool PipelineCheckpointer::restore() {
+    std::ifstream file(options_.path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    std::vector<char> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (file.bad()) {
+        throw std::runtime_error("Failed to read checkpoint: " + options_.path);
+    }
+
+    CheckpointFileHeader header{};
+    if (contents.size() < sizeof(header)) {
+        throw std::runtime_error("Not a checkpoint file: " + options_.path);
+    }
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (std::memcmp(header.magic, kCheckpointMagic, sizeof(kCheckpointMagic)) != 0) {
+        throw std::runtime_error("Not a checkpoint file: " + options_.path);
+    }
+    if (header.version != kCheckpointVersion || header.headerSize != sizeof(CheckpointFileHeader)) {
+        throw std::runtime_error("Unsupported checkpoint version: " + options_.path);
+    }
+
+    StateReader in(contents.data() + sizeof(header), contents.size() - sizeof(header));
+    while (!in.atEnd()) {
+        std::string name = in.getString();
+        StateReader payload = in.block();
+        if (name == "quality") {
+            tracker_->loadState(payload);
+        } else if (name == "sentiment") {
+            if (pipeline_) {
+                pipeline_->loadSentimentState(payload);
+            }
+        } else if (name == "symbols") {
+            if (pipeline_) {
+                pipeline_->loadSymbolState(payload);
+            } else {
+                sharded_->loadSymbolState(payload);
+            }
+        } else {
+            for (const auto& section : sections_) {
+                if (section.name == name) {
+                    section.load(payload);
+                    break;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+void PipelineCheckpointer::start() {
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    if (running_) return;
+    running_ = true;
+    thread_ = std::thread(&PipelineCheckpointer::checkpointLoop, this);
+}
+
+void PipelineCheckpointer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (options_.checkpointOnStop) {
+        checkpointNow();
+    }
+}
+
+bool PipelineCheckpointer::isRunning() const {
+    return running_;
+}
+
+void PipelineCheckpointer::checkpointNow() {
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    int64_t started = steadyNowNs();
+    buffer_.clear();
+    build(buffer_);
+
+    // The data must be on disk before the rename can expose it, and the
+    // directory entry after it, or a crash could leave an empty checkpoint
+    std::string temporary = options_.path + ".tmp";
+    if (!writeSynced(temporary, buffer_.data(), buffer_.size())) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        ::unlink(temporary.c_str());
+        throw std::runtime_error("Failed to write checkpoint: " + temporary);
+    }
+    if (std::rename(temporary.c_str(), options_.path.c_str()) != 0) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        ::unlink(temporary.c_str());
+        throw std::runtime_error("Failed to replace checkpoint: " + options_.path);
+    }
+    if (!syncParentDirectory(options_.path)) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+        throw std::runtime_error("Failed to sync checkpoint directory: " + options_.path);
+    }
+    written_.fetch_add(1, std::memory_order_relaxed);
+    lastBytes_.store(buffer_.size(), std::memory_order_relaxed);
+    lastDurationNs_.store(steadyNowNs() - started, std::memory_order_relaxed);
+}
+
+uint64_t PipelineCheckpointer::checkpointsWritten() const {
+    return written_.load(std::memory_order_relaxed);
+}
+
+uint64_t PipelineCheckpointer::checkpointErrors() const {
+    return errors_.load(std::memory_order_relaxed);
+}
+
+size_t PipelineCheckpointer::lastCheckpointBytes() const {
+    return lastBytes_.load(std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds PipelineCheckpointer::lastCheckpointDuration() const {
+    return std::chrono::nanoseconds(lastDurationNs_.load(std::memory_order_relaxed));
+}
+
+void PipelineCheckpointer::checkpointLoop() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (running_) {
+        if (wake_.wait_for(lock, options_.interval, [this] { return !running_; })) {
+            break;
+        }
+        lock.unlock();
+        try {
+            checkpointNow();
+        } catch (const std::exception&) {
+            // Counted; the next interval tries again
+        }
+        lock.lock();
+    }
+}
+
+void PipelineCheckpointer::build(StateWriter& out) {
+    CheckpointFileHeader header{};
+    std::memcpy(header.magic, kCheckpointMagic, sizeof(kCheckpointMagic));
+    header.version = kCheckpointVersion;
+    header.headerSize = sizeof(CheckpointFileHeader);
+    header.createdNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    out.put(header);
+
+    out.putString("quality");
+    size_t block = out.beginBlock();
+    tracker_->saveState(out);
+    out.endBlock(block);
+
+    if (pipeline_) {
+        out.putString("sentiment");
+        block = out.beginBlock();
+        pipeline_->saveSentimentState(out);
+        out.endBlock(block);
+    }
+
+    out.putString("symbols");
+    block = out.beginBlock();
+    if (pipeline_) {
+        pipeline_->saveSymbolState(out, options_.symbolsPerSlice);
+    } else {
+        sharded_->saveSymbolState(out, options_.symbolsPerSlice);
+    }
+    out.endBlock(block);
+
+    for (const auto& section : sections_) {
+        out.putString(section.name);
+        block = out.beginBlock();
+        section.save(out);
+        out.endBlock(block);
+    }
+}
+
+} // namespace novacrypt
@@ -0,0 +1,130 @@
+#pragma once
+#include "../common/StateStream.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace novacrypt {
+
+class DataQualityTracker;
+class MarketDataPipeline;
+class ShardedMarketDataPipeline;
+
+struct CheckpointOptions {
+    // Written as path + ".tmp", fsynced and renamed over path, then the
+    // directory is fsynced, so a crash leaves the previous checkpoint or
+    // the complete new one
+    std::string path;
+    std::chrono::milliseconds interval{std::chrono::seconds(30)};
+    // Symbols the processing thread serializes per batch while running
+    size_t symbolsPerSlice{16};
+    // stop() writes one last checkpoint
+    bool checkpointOnStop{true};
+};
+
+// File layout (native byte order):
+//
+//   [CheckpointFileHeader][section]...
+//
+// Each section is a length-prefixed name followed by a length-prefixed
+// payload. Restores skip sections they do not know and leave state for
+// missing ones untouched.
+struct CheckpointFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    int64_t createdNs;
+};
+
+// Periodic binary checkpoints of a pipeline's in-memory state, so restarts
+// load it back in milliseconds instead of re-ingesting history. Covered:
+// every symbol's latest tick, candle builder, timeframe indicator windows
+// and closed bars; per-source quality counters and latency histograms; the
+// latest sentiment per source and the sentiment analyzer's aggregates and
+// rings (single pipelines only; sharded ones take no sentiment). Other
+// components join through addSection, e.g. the AI engine's trade cooldown:
+//
+//   checkpointer.addSection("ai",
+//       [&](StateWriter& out) { engine.saveState(out); },
+//       [&](StateReader& in) { engine.loadState(in); });
+//
+// A background thread builds each checkpoint into a reused buffer. Symbol
+// state belongs to the processing thread, which serializes it a slice of
+// symbols at a time between batches, so ingest is never paused for the
+// whole snapshot; everything else is read through its own thread-safe
+// accessors. Each symbol is consistent on its own, but symbols may be
+// captured a few batches apart.
+class PipelineCheckpointer {
+public:
+    using SaveSection = std::function<void(StateWriter&)>;
+    using LoadSection = std::function<void(StateReader&)>;
+
+    // The pipeline is referenced, not owned, and must outlive the checkpointer
+    PipelineCheckpointer(MarketDataPipeline& pipeline, CheckpointOptions options);
+    PipelineCheckpointer(ShardedMarketDataPipeline& pipeline, CheckpointOptions options);
+    ~PipelineCheckpointer();
+
+    PipelineCheckpointer(const PipelineCheckpointer&) = delete;
+    PipelineCheckpointer& operator=(const PipelineCheckpointer&) = delete;
+
+    // Register before restore() and start(). Saves run on the checkpoint
+    // thread, so they must be safe against the component's own threads.
+    void addSection(const std::string& name, SaveSection save, LoadSection load);
+
+    // Loads the checkpoint at options.path into the pipeline, which must not
+    // be running yet. Returns false if there is no checkpoint file; throws
+    // std::runtime_error if it cannot be read or is corrupt.
+    bool restore();
+
+    void start();
+    void stop();
+    bool isRunning() const;
+
+    // Writes a checkpoint on the calling thread; throws std::runtime_error
+    // if the file cannot be written
+    void checkpointNow();
+
+    uint64_t checkpointsWritten() const;
+    uint64_t checkpointErrors() const;
+    size_t lastCheckpointBytes() const;
+    std::chrono::nanoseconds lastCheckpointDuration() const;
+
+private:
+    struct Section {
+        std::string name;
+        SaveSection save;
+        LoadSection load;
+    };
+
+    PipelineCheckpointer(CheckpointOptions options, std::shared_ptr<DataQualityTracker> tracker);
+    void checkpointLoop();
+    void build(StateWriter& out);
+
+    CheckpointOptions options_;
+    MarketDataPipeline* pipeline_;
+    ShardedMarketDataPipeline* sharded_;
+    std::shared_ptr<DataQualityTracker> tracker_;
+    std::vector<Section> sections_;
+
+    std::mutex writeMutex_;  // one checkpoint at a time; guards buffer_
+    StateWriter buffer_;     // reused so steady-state checkpoints do not allocate
+
+    std::atomic<bool> running_;
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;
+    std::thread thread_;
+
+    std::atomic<uint64_t> written_;
+    std::atomic<uint64_t> errors_;
+    std::atomic<size_t> lastBytes_;
+    std::atomic<int64_t> lastDurationNs_;
+};
+
+} // namespace novacrypt
@@ -0,0 +1,136 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace novacrypt {
+
+// How many threads push into a ring buffer
+enum class ProducerMode {
+    Single,  // one feed thread per queue
+    Multi    // several exchange threads share the queue
+};
+
+// Fixed-capacity lock-free ring buffer built on per-slot sequence numbers.
+// Producers move updates into pre-allocated slots and the consumer moves them
+// out again, so nothing is copied and slot storage is reused. A full ring evicts
+// its oldest element on push, keeping the drop-oldest behaviour of the original
+// std::queue. Eviction makes a producer act as a second consumer, which is why
+// the dequeue side always claims slots with a CAS.
+template<typename T>
+class RingBuffer {
+public:
+    RingBuffer(size_t capacity, ProducerMode mode = ProducerMode::Multi)
+        : capacity_(capacity),
+          mode_(mode),
+          slots_(new Slot[capacity]),
+          enqueuePos_(0),
+          dequeuePos_(0)
+    {
+        if (capacity_ == 0) {
+            throw std::invalid_argument("RingBuffer capacity must be positive");
+        }
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+
+    // Push an element, evicting the oldest when full. Returns how many
+    // elements were evicted to make room. Under multi-producer contention
+    // that can be more than one, since another producer may claim the freed
+    // slot first.
+    size_t push(T&& value) {
+        return push(std::move(value), [](T&) {});
+    }
+
+    // The same, passing each evicted element to onEvict(T&) first, e.g. to
+    // account for it against its source
+    template<typename OnEvict>
+    size_t push(T&& value, OnEvict&& onEvict) {
+        size_t evicted = 0;
+        size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos % capacity_];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (mode_ == ProducerMode::Single) {
+                    enqueuePos_.store(pos + 1, std::memory_order_relaxed);
+                    break;
+                }
+                if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Full: drop the oldest element and retry
+                T dropped;
+                if (pop(dropped)) {
+                    ++evicted;
+                    onEvict(dropped);
+                }
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            } else {
+                pos = enqueuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        slot->value = std::move(value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return evicted;
+    }
+
+    // Move the oldest element into value. Returns false if the ring is empty.
+    bool pop(T& value) {
+        size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+        Slot* slot;
+        for (;;) {
+            slot = &slots_[pos % capacity_];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos_.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(slot->value);
+        slot->sequence.store(pos + capacity_, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate number of queued elements; exact when producers are idle
+    size_t size() const {
+        size_t tail = enqueuePos_.load(std::memory_order_acquire);
+        size_t head = dequeuePos_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+    ProducerMode producerMode() const { return mode_; }
+
+private:
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity_;
+    const ProducerMode mode_;
+    std::unique_ptr<Slot[]> slots_;
+
+    // Producer and consumer cursors live on separate cache lines
+    alignas(64) std::atomic<size_t> enqueuePos_;
+    alignas(64) std::atomic<size_t> dequeuePos_;
+};
+
+} // namespace novacrypt
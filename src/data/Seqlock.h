@@ -0,0 +1,115 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace novacrypt {
+
+// Single-writer sequence lock for small trivially copyable values. The writer
+// never blocks; readers retry while a write is in flight. The payload is held
+// in relaxed atomic words, so concurrent reads are well defined rather than
+// relying on a racy memcpy.
+template<typename T>
+class Seqlock {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "Seqlock values must be trivially copyable");
+
+public:
+    Seqlock() : sequence_(0) {
+        store(T{});
+    }
+
+    explicit Seqlock(const T& value) : sequence_(0) {
+        store(value);
+    }
+
+    Seqlock(const Seqlock&) = delete;
+    Seqlock& operator=(const Seqlock&) = delete;
+
+    // Only one thread may store at a time
+    void store(const T& value) {
+        uint64_t words[kWords] = {};
+        std::memcpy(words, &value, sizeof(T));
+        uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < kWords; ++i) {
+            words_[i].store(words[i], std::memory_order_relaxed);
+        }
+        sequence_.store(sequence + 2, std::memory_order_release);
+    }
+
+    T load() const {
+        T value;
+        while (!tryLoad(value)) {
+        }
+        return value;
+    }
+
+    // One read attempt; false if it overlapped a write
+    bool tryLoad(T& value) const {
+        uint64_t words[kWords];
+        uint64_t before = sequence_.load(std::memory_order_acquire);
+        if (before & 1) {
+            return false;
+        }
+        for (size_t i = 0; i < kWords; ++i) {
+            words[i] = words_[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence_.load(std::memory_order_relaxed) != before) {
+            return false;
+        }
+        std::memcpy(&value, words, sizeof(T));
+        return true;
+    }
+
+    // Number of completed stores
+    uint64_t version() const {
+        return sequence_.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(64) std::atomic<uint64_t> sequence_;
+    std::atomic<uint64_t> words_[kWords];
+};
+
+// Two seqlocked buffers with a published index. The writer always fills the
+// buffer readers are not pointed at and then flips the index, so a reader
+// only retries if the writer laps it twice mid-read. Suited to larger values
+// such as book snapshots that readers copy slowly.
+template<typename T>
+class DoubleBuffer {
+public:
+    DoubleBuffer() : current_(0) {}
+
+    DoubleBuffer(const DoubleBuffer&) = delete;
+    DoubleBuffer& operator=(const DoubleBuffer&) = delete;
+
+    // Only one thread may store at a time
+    void store(const T& value) {
+        unsigned next = current_.load(std::memory_order_relaxed) ^ 1u;
+        buffers_[next].store(value);
+        current_.store(next, std::memory_order_release);
+    }
+
+    T load() const {
+        T value;
+        for (;;) {
+            unsigned index = current_.load(std::memory_order_acquire);
+            if (buffers_[index].tryLoad(value)) {
+                return value;
+            }
+        }
+    }
+
+private:
+    Seqlock<T> buffers_[2];
+    std::atomic<unsigned> current_;
+};
+
+} // namespace novacrypt
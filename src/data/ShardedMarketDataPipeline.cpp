@@ -0,0 +1,245 @@
+#include "ShardedMarketDataPipeline.h"
+#include "ThreadAffinity.h"
+#include "WarmupLoader.h"
+#include <stdexcept>
+
+namespace novacrypt {
+
+namespace {
+
+PoolPlacement defaultPlacement(bool pinToCores, std::vector<int> cores) {
+    PoolPlacement placement;
+    if (pinToCores) {
+        placement.cores = cores.empty() ? coresByNumaNode() : std::move(cores);
+    }
+    return placement;
+}
+
+} // namespace
+
+ShardedMarketDataPipeline::ShardedMarketDataPipeline(size_t shardCount, bool pinToCores,
+                                                     std::vector<int> cores)
+    : ShardedMarketDataPipeline(shardCount, defaultPlacement(pinToCores, std::move(cores))) {}
+
+ShardedMarketDataPipeline::ShardedMarketDataPipeline(size_t shardCount, const PoolPlacement& placement)
+    : symbolRegistry_(std::make_shared<SourceRegistry>(MarketDataPipeline::kMaxSymbols)),
+      qualityTracker_(std::make_shared<DataQualityTracker>())
+{
+    if (shardCount == 0) {
+        shardCount = static_cast<size_t>(availableCores());
+    }
+    for (size_t i = 0; i < shardCount; ++i) {
+        auto shard = std::make_unique<MarketDataPipeline>(qualityTracker_);
+        shard->setThreadPlacement(placement.forWorker(i));
+        shards_.push_back(std::move(shard));
+    }
+}
+
+ShardedMarketDataPipeline::~ShardedMarketDataPipeline() {
+    stop();
+}
+
+void ShardedMarketDataPipeline::start() {
+    for (auto& shard : shards_) {
+        shard->start();
+    }
+}
+
+void ShardedMarketDataPipeline::stop() {
+    for (auto& shard : shards_) {
+        shard->stop();
+    }
+}
+
+SymbolId ShardedMarketDataPipeline::registerSymbol(const std::string& symbol) {
+    return symbolRegistry_->registerSource(symbol);
+}
+
+SourceId ShardedMarketDataPipeline::registerSource(const std::string& source) {
+    return qualityTracker_->registerSource(source);
+}
+
+std::shared_ptr<SourceRegistry> ShardedMarketDataPipeline::getSymbolRegistry() const {
+    return symbolRegistry_;
+}
+
+std::shared_ptr<SourceRegistry> ShardedMarketDataPipeline::getSourceRegistry() const {
+    return qualityTracker_->getSourceRegistry();
+}
+
+void ShardedMarketDataPipeline::pushMarketData(const MarketDataUpdate& data) {
+    route(data.symbol).pushMarketData(data);
+}
+
+void ShardedMarketDataPipeline::pushMarketData(MarketDataUpdate&& data) {
+    route(data.symbol).pushMarketData(std::move(data));
+}
+
+void ShardedMarketDataPipeline::pushOrderBook(const OrderBookUpdate& data) {
+    route(data.symbol).pushOrderBook(data);
+}
+
+void ShardedMarketDataPipeline::pushOrderBook(OrderBookUpdate&& data) {
+    route(data.symbol).pushOrderBook(std::move(data));
+}
+
+MarketDataUpdate ShardedMarketDataPipeline::getLatestMarketData(SymbolId symbol) {
+    return route(symbol).getLatestMarketData(symbol);
+}
+
+OrderBookUpdate ShardedMarketDataPipeline::getLatestOrderBook(SymbolId symbol) {
+    return route(symbol).getLatestOrderBook(symbol);
+}
+
+OrderBookMetrics ShardedMarketDataPipeline::getOrderBookMetrics(SymbolId symbol) {
+    return route(symbol).getOrderBookMetrics(symbol);
+}
+
+OHLCV ShardedMarketDataPipeline::getOpenBar(SymbolId symbol, Timeframe timeframe) {
+    return route(symbol).getOpenBar(symbol, timeframe);
+}
+
+OHLCV ShardedMarketDataPipeline::getLastClosedBar(SymbolId symbol, Timeframe timeframe) {
+    return route(symbol).getLastClosedBar(symbol, timeframe);
+}
+
+void ShardedMarketDataPipeline::setUpdateInterval(std::chrono::milliseconds interval) {
+    for (auto& shard : shards_) {
+        shard->setUpdateInterval(interval);
+    }
+}
+
+void ShardedMarketDataPipeline::setMaxQueueSize(size_t size) {
+    for (auto& shard : shards_) {
+        shard->setMaxQueueSize(size);
+    }
+}
+
+void ShardedMarketDataPipeline::setProducerMode(ProducerMode mode) {
+    for (auto& shard : shards_) {
+        shard->setProducerMode(mode);
+    }
+}
+
+void ShardedMarketDataPipeline::setProcessingMode(MarketDataPipeline::ProcessingMode mode) {
+    for (auto& shard : shards_) {
+        shard->setProcessingMode(mode);
+    }
+}
+
+void ShardedMarketDataPipeline::setCaptureWriter(std::shared_ptr<CaptureWriter> writer) {
+    for (auto& shard : shards_) {
+        shard->setCaptureWriter(writer);
+    }
+}
+
+void ShardedMarketDataPipeline::applyWarmup(WarmupResult&& warmup) {
+    std::vector<WarmupResult> perShard(shards_.size());
+    for (auto& warmed : warmup.symbols) {
+        if (warmed) {
+            perShard[shardFor(warmed->symbol)].symbols.push_back(std::move(warmed));
+        }
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        shards_[i]->applyWarmup(std::move(perShard[i]));
+    }
+}
+
+void ShardedMarketDataPipeline::saveSymbolState(StateWriter& out, size_t symbolsPerSlice) {
+    for (auto& shard : shards_) {
+        shard->saveSymbolState(out, symbolsPerSlice);
+    }
+}
+
+void ShardedMarketDataPipeline::loadSymbolState(StateReader& in) {
+    while (!in.atEnd()) {
+        auto symbol = in.get<SymbolId>();
+        StateReader payload = in.block();
+        shards_[shardFor(symbol)]->loadSymbol(symbol, payload);
+    }
+}
+
+void ShardedMarketDataPipeline::setClock(std::shared_ptr<const Clock> clock) {
+    for (auto& shard : shards_) {
+        shard->setClock(clock);
+    }
+}
+
+void ShardedMarketDataPipeline::setMarketDataCallback(MarketDataPipeline::MarketDataCallback callback) {
+    for (auto& shard : shards_) {
+        shard->setMarketDataCallback(callback);
+    }
+}
+
+void ShardedMarketDataPipeline::setOrderBookCallback(MarketDataPipeline::OrderBookCallback callback) {
+    for (auto& shard : shards_) {
+        shard->setOrderBookCallback(callback);
+    }
+}
+
+void ShardedMarketDataPipeline::setBarCallback(MarketDataPipeline::BarCallback callback) {
+    for (auto& shard : shards_) {
+        shard->setBarCallback(callback);
+    }
+}
+
+size_t ShardedMarketDataPipeline::shardCount() const {
+    return shards_.size();
+}
+
+size_t ShardedMarketDataPipeline::shardFor(SymbolId symbol) const {
+    return symbol % shards_.size();
+}
+
+MarketDataPipeline& ShardedMarketDataPipeline::shard(size_t index) {
+    return *shards_.at(index);
+}
+
+const MarketDataPipeline& ShardedMarketDataPipeline::shard(size_t index) const {
+    return *shards_.at(index);
+}
+
+size_t ShardedMarketDataPipeline::getMarketDataQueueSize() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->getMarketDataQueueSize();
+    }
+    return total;
+}
+
+size_t ShardedMarketDataPipeline::getOrderBookQueueSize() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard->getOrderBookQueueSize();
+    }
+    return total;
+}
+
+DataQualityMetrics ShardedMarketDataPipeline::getDataQualityMetrics(const std::string& source) const {
+    return qualityTracker_->getLatestMetrics(source);
+}
+
+DataQualityMetrics ShardedMarketDataPipeline::getAggregateDataQualityMetrics() const {
+    return qualityTracker_->getAggregateMetrics();
+}
+
+std::string ShardedMarketDataPipeline::generateDataQualityReport(const std::string& source) const {
+    return qualityTracker_->generateQualityReport(source);
+}
+
+std::string ShardedMarketDataPipeline::generateDataQualitySummary() const {
+    return qualityTracker_->generateSummaryReport();
+}
+
+std::shared_ptr<DataQualityTracker> ShardedMarketDataPipeline::getQualityTracker() const {
+    return qualityTracker_;
+}
+
+MarketDataPipeline& ShardedMarketDataPipeline::route(SymbolId symbol) {
+    if (symbol >= MarketDataPipeline::kMaxSymbols) {
+        throw std::runtime_error("Symbol id out of range");
+    }
+    return *shards_[shardFor(symbol)];
+}
+
+} // namespace novacrypt
@@ -0,0 +1,96 @@
+#pragma once
+#include "MarketDataPipeline.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace novacrypt {
+
+// Routes many symbols over a fixed set of MarketDataPipeline shards. Each
+// shard has its own queues, worker thread, order books and indicator state,
+// and symbols are assigned to shards by SymbolId, so throughput scales with
+// the shard count rather than needing one pipeline per symbol. All shards
+// share one DataQualityTracker, which makes quality reports span every shard.
+class ShardedMarketDataPipeline {
+public:
+    // shardCount == 0 uses one shard per available core. When pinned, shard i
+    // runs on cores[i % cores.size()], or if cores is empty on the i-th core
+    // counting node by node, so neighbouring shards share a NUMA node.
+    explicit ShardedMarketDataPipeline(size_t shardCount = 0, bool pinToCores = true,
+                                       std::vector<int> cores = {});
+    // Shard i takes placement.forWorker(i), including its wait policy
+    ShardedMarketDataPipeline(size_t shardCount, const PoolPlacement& placement);
+    ~ShardedMarketDataPipeline();
+    
+    ShardedMarketDataPipeline(const ShardedMarketDataPipeline&) = delete;
+    ShardedMarketDataPipeline& operator=(const ShardedMarketDataPipeline&) = delete;
+    
+    void start();
+    void stop();
+    
+    // Registration is shared by all shards
+    SymbolId registerSymbol(const std::string& symbol);
+    SourceId registerSource(const std::string& source);
+    std::shared_ptr<SourceRegistry> getSymbolRegistry() const;
+    std::shared_ptr<SourceRegistry> getSourceRegistry() const;
+    
+    // Data input, routed by update.symbol
+    void pushMarketData(const MarketDataUpdate& data);
+    void pushMarketData(MarketDataUpdate&& data);
+    void pushOrderBook(const OrderBookUpdate& data);
+    void pushOrderBook(OrderBookUpdate&& data);
+    
+    MarketDataUpdate getLatestMarketData(SymbolId symbol);
+    OrderBookUpdate getLatestOrderBook(SymbolId symbol);
+    OrderBookMetrics getOrderBookMetrics(SymbolId symbol);
+    OHLCV getOpenBar(SymbolId symbol, Timeframe timeframe);
+    OHLCV getLastClosedBar(SymbolId symbol, Timeframe timeframe);
+    
+    // Configuration applied to every shard; the queue settings only while stopped
+    void setUpdateInterval(std::chrono::milliseconds interval);
+    void setMaxQueueSize(size_t size);
+    void setProducerMode(ProducerMode mode);
+    void setProcessingMode(MarketDataPipeline::ProcessingMode mode);
+    // Every shard records into the same capture / reads the same clock; the
+    // clock only while stopped
+    void setCaptureWriter(std::shared_ptr<CaptureWriter> writer);
+    void setClock(std::shared_ptr<const Clock> clock);
+    // Hands each warmed symbol to its shard; shards take no sentiment, so
+    // the sentiment state is dropped. Throws while running.
+    void applyWarmup(WarmupResult&& warmup);
+    // Every shard's symbols in one stream; loading routes each entry to the
+    // shard owning it, so the shard count may differ from the saved one
+    void saveSymbolState(StateWriter& out, size_t symbolsPerSlice = 16);
+    void loadSymbolState(StateReader& in);
+    
+    // Callbacks run on the owning shard's thread, so they may be invoked
+    // concurrently for symbols on different shards
+    void setMarketDataCallback(MarketDataPipeline::MarketDataCallback callback);
+    void setOrderBookCallback(MarketDataPipeline::OrderBookCallback callback);
+    void setBarCallback(MarketDataPipeline::BarCallback callback);
+    
+    size_t shardCount() const;
+    size_t shardFor(SymbolId symbol) const;
+    MarketDataPipeline& shard(size_t index);
+    const MarketDataPipeline& shard(size_t index) const;
+    
+    // Totals across shards
+    size_t getMarketDataQueueSize() const;
+    size_t getOrderBookQueueSize() const;
+    
+    // Quality across all shards
+    DataQualityMetrics getDataQualityMetrics(const std::string& source) const;
+    DataQualityMetrics getAggregateDataQualityMetrics() const;
+    std::string generateDataQualityReport(const std::string& source) const;
+    std::string generateDataQualitySummary() const;
+    std::shared_ptr<DataQualityTracker> getQualityTracker() const;
+
+private:
+    MarketDataPipeline& route(SymbolId symbol);
+    
+    std::shared_ptr<SourceRegistry> symbolRegistry_;
+    std::shared_ptr<DataQualityTracker> qualityTracker_;
+    std::vector<std::unique_ptr<MarketDataPipeline>> shards_;
+};
+
+} // namespace novacrypt
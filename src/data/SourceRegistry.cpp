@@ -0,0 +1,67 @@
+#include "SourceRegistry.h"
+#include <mutex>
+#include <stdexcept>
+
+namespace novacrypt {
+
+SourceRegistry::SourceRegistry(size_t maxSources)
+    : maxSources_(maxSources)
+{
+    if (maxSources_ == 0 || maxSources_ > kInvalidSourceId) {
+        throw std::invalid_argument("SourceRegistry capacity must be in [1, 65535]");
+    }
+}
+
+SourceId SourceRegistry::registerSource(const std::string& name) {
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = ids_.find(name);
+        if (it != ids_.end()) {
+            return it->second;
+        }
+    }
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it != ids_.end()) {
+        return it->second;
+    }
+    if (names_.size() >= maxSources_) {
+        throw std::runtime_error("Too many data sources registered: " + name);
+    }
+    SourceId id = static_cast<SourceId>(names_.size());
+    names_.push_back(name);
+    ids_.emplace(name, id);
+    count_.store(names_.size(), std::memory_order_release);
+    return id;
+}
+
+std::optional<SourceId> SourceRegistry::find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = ids_.find(name);
+    if (it == ids_.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const std::string& SourceRegistry::name(SourceId id) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    if (id >= names_.size()) {
+        throw std::out_of_range("Unknown source id");
+    }
+    return names_[id];
+}
+
+bool SourceRegistry::contains(SourceId id) const {
+    return id < count_.load(std::memory_order_acquire);
+}
+
+size_t SourceRegistry::size() const {
+    return count_.load(std::memory_order_acquire);
+}
+
+size_t SourceRegistry::capacity() const {
+    return maxSources_;
+}
+
+} // namespace novacrypt
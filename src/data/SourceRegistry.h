@@ -0,0 +1,51 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace novacrypt {
+
+using SourceId = uint16_t;
+// Instruments are interned the same way, in their own registry
+using SymbolId = uint16_t;
+
+// Handle carried by messages whose source was never set
+constexpr SourceId kInvalidSourceId = std::numeric_limits<SourceId>::max();
+
+// Maps data source names to small dense integer handles. Sources are
+// registered once (typically at feed startup); hot paths then carry the
+// handle instead of hashing the name on every event. Handles are never
+// reused, so they can index fixed per-source tables directly.
+class SourceRegistry {
+public:
+    // At most 65535 sources; kInvalidSourceId is never issued
+    explicit SourceRegistry(size_t maxSources = 1024);
+    
+    // Returns the existing handle if the name is already registered.
+    // Throws std::runtime_error once maxSources names are registered.
+    SourceId registerSource(const std::string& name);
+    std::optional<SourceId> find(const std::string& name) const;
+    
+    // Throws std::out_of_range for handles that were never issued
+    const std::string& name(SourceId id) const;
+    
+    // Lock-free; safe to call on hot paths
+    bool contains(SourceId id) const;
+    size_t size() const;
+    size_t capacity() const;
+
+private:
+    size_t maxSources_;
+    std::deque<std::string> names_;  // deque keeps references stable on growth
+    std::unordered_map<std::string, SourceId> ids_;
+    std::atomic<size_t> count_{0};
+    mutable std::shared_mutex mutex_;
+};
+
+} // namespace novacrypt
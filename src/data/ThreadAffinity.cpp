@@ -0,0 +1,185 @@
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace novacrypt {
+
+namespace {
+
+#if defined(__linux__)
+bool pinHandle(pthread_t handle, int core) {
+    if (core < 0 || core >= CPU_SETSIZE) {
+        return false;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core, &cpus);
+    return pthread_setaffinity_np(handle, sizeof(cpus), &cpus) == 0;
+}
+#endif
+
+// Parses a kernel CPU list such as "0-3,8-11"
+std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cores;
+    std::stringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty()) continue;
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int core = first; core <= last; ++core) {
+                cores.push_back(core);
+            }
+        } catch (const std::exception&) {
+            // Malformed entries are skipped
+        }
+    }
+    return cores;
+}
+
+struct Topology {
+    std::vector<std::vector<int>> nodes;  // cores of each node
+    std::vector<int> nodeOfCore;          // -1 for cores not listed
+};
+
+Topology readTopology() {
+    Topology topology;
+#if defined(__linux__)
+    // Node ids can be sparse; stop after a run of missing ones
+    for (int node = 0, missing = 0; missing < 8; ++node) {
+        std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string list;
+        if (!file || !std::getline(file, list)) {
+            ++missing;
+            continue;
+        }
+        missing = 0;
+        topology.nodes.resize(node + 1);
+        topology.nodes[node] = parseCpuList(list);
+    }
+#endif
+    if (topology.nodes.empty()) {
+        std::vector<int> all;
+        for (int core = 0; core < availableCores(); ++core) {
+            all.push_back(core);
+        }
+        topology.nodes.push_back(std::move(all));
+    }
+    for (size_t node = 0; node < topology.nodes.size(); ++node) {
+        for (int core : topology.nodes[node]) {
+            if (core >= static_cast<int>(topology.nodeOfCore.size())) {
+                topology.nodeOfCore.resize(core + 1, -1);
+            }
+            topology.nodeOfCore[core] = static_cast<int>(node);
+        }
+    }
+    return topology;
+}
+
+const Topology& topology() {
+    static const Topology instance = readTopology();
+    return instance;
+}
+
+} // namespace
+
+bool pinThreadToCore(std::thread& thread, int core) {
+#if defined(__linux__)
+    return thread.joinable() && pinHandle(thread.native_handle(), core);
+#else
+    (void)thread;
+    (void)core;
+    return false;
+#endif
+}
+
+bool pinCurrentThreadToCore(int core) {
+#if defined(__linux__)
+    return pinHandle(pthread_self(), core);
+#else
+    (void)core;
+    return false;
+#endif
+}
+
+bool pinCurrentThreadToNode(int node) {
+#if defined(__linux__)
+    std::vector<int> cores = coresOfNumaNode(node);
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    for (int core : cores) {
+        if (core < CPU_SETSIZE) {
+            CPU_SET(core, &cpus);
+        }
+    }
+    return CPU_COUNT(&cpus) > 0 &&
+           pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+int availableCores() {
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+int numaNodeCount() {
+    return static_cast<int>(topology().nodes.size());
+}
+
+int numaNodeOfCore(int core) {
+    const auto& nodeOfCore = topology().nodeOfCore;
+    return core >= 0 && core < static_cast<int>(nodeOfCore.size()) ? nodeOfCore[core] : -1;
+}
+
+std::vector<int> coresOfNumaNode(int node) {
+    const auto& nodes = topology().nodes;
+    return node >= 0 && node < static_cast<int>(nodes.size()) ? nodes[node] : std::vector<int>{};
+}
+
+std::vector<int> coresByNumaNode() {
+    std::vector<int> cores;
+    for (const auto& node : topology().nodes) {
+        cores.insert(cores.end(), node.begin(), node.end());
+    }
+    return cores;
+}
+
+ThreadPlacement PoolPlacement::forWorker(size_t index) const {
+    ThreadPlacement placement;
+    placement.wait = wait;
+    placement.spinTime = spinTime;
+    if (!cores.empty()) {
+        placement.core = cores[index % cores.size()];
+    } else if (numaNode >= 0) {
+        std::vector<int> nodeCores = coresOfNumaNode(numaNode);
+        if (nodeCores.empty()) {
+            placement.numaNode = numaNode;
+        } else {
+            placement.core = nodeCores[index % nodeCores.size()];
+        }
+    }
+    return placement;
+}
+
+bool applyPlacement(const ThreadPlacement& placement) {
+    if (placement.core >= 0) {
+        return pinCurrentThreadToCore(placement.core);
+    }
+    if (placement.numaNode >= 0) {
+        return pinCurrentThreadToNode(placement.numaNode);
+    }
+    return true;
+}
+
+} // namespace novacrypt
@@ -0,0 +1,100 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace novacrypt {
+
+// Pin a thread to one CPU core. Returns false if the platform does not
+// support pinning or the core does not exist; the thread keeps running
+// unpinned in that case.
+bool pinThreadToCore(std::thread& thread, int core);
+bool pinCurrentThreadToCore(int core);
+// Let the calling thread run on any core of a NUMA node
+bool pinCurrentThreadToNode(int node);
+
+// Number of cores available for pinning (at least 1)
+int availableCores();
+
+// NUMA topology as reported by /sys/devices/system/node. Machines without
+// it (or non-Linux platforms) report a single node holding every core.
+int numaNodeCount();
+// Node owning a core, or -1 for an unknown core
+int numaNodeOfCore(int core);
+// Cores of a node in ascending order; empty for an unknown node
+std::vector<int> coresOfNumaNode(int node);
+
+// How a worker thread waits when it runs out of work
+enum class WaitPolicy {
+    Block,          // sleep on a condition variable; no CPU while idle
+    Spin,           // busy-poll; lowest wake-up latency, keeps its core at 100%
+    SpinThenBlock   // busy-poll for spinTime, then block
+};
+
+// Where a worker thread runs and how it idles. With a core the thread is
+// pinned to it; otherwise with a NUMA node it may run on any of that node's
+// cores. Placement is applied by the thread itself before it allocates its
+// working state, so under Linux's default first-touch policy that memory is
+// local to the node it runs on.
+struct ThreadPlacement {
+    int core{-1};
+    int numaNode{-1};
+    WaitPolicy wait{WaitPolicy::Block};
+    std::chrono::microseconds spinTime{50};
+
+    bool pinned() const { return core >= 0 || numaNode >= 0; }
+};
+
+// Placement for a group of workers (pipeline shards, backtest pools)
+struct PoolPlacement {
+    // Worker i runs on cores[i % cores.size()]
+    std::vector<int> cores;
+    // Used when cores is empty: workers take the node's cores in turn
+    int numaNode{-1};
+    WaitPolicy wait{WaitPolicy::Block};
+    std::chrono::microseconds spinTime{50};
+
+    ThreadPlacement forWorker(size_t index) const;
+};
+
+// Every core, ordered node by node, so consecutive workers share a node
+std::vector<int> coresByNumaNode();
+
+// Pins the calling thread as placement asks. Returns false if pinning was
+// requested and failed; the thread keeps running unpinned.
+bool applyPlacement(const ThreadPlacement& placement);
+
+// Busy-wait hint for the core (PAUSE on x86, YIELD on ARM)
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+// Spins on ready() as the wait policy allows. Returns true once ready()
+// holds, or false when the caller should block instead: immediately for
+// Block, after spinTime for SpinThenBlock. Spin only returns through
+// ready(), so it must also report shutdown.
+template<typename Ready>
+bool spinUntil(WaitPolicy wait, std::chrono::microseconds spinTime, Ready&& ready) {
+    if (wait == WaitPolicy::Block) {
+        return false;
+    }
+    auto deadline = std::chrono::steady_clock::now() + spinTime;
+    for (unsigned spins = 0;; ++spins) {
+        if (ready()) {
+            return true;
+        }
+        cpuRelax();
+        // Check the clock only every so often; it costs more than a pause
+        if (wait == WaitPolicy::SpinThenBlock && (spins & 63) == 63 &&
+            std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+    }
+}
+
+} // namespace novacrypt
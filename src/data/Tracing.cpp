@@ -0,0 +1,231 @@
+#include "Tracing.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace novacrypt {
+
+namespace {
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    escaped.reserve(text.size());
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            escaped += ' ';
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+} // namespace
+
+Tracer& Tracer::instance() {
+    static Tracer tracer;
+    return tracer;
+}
+
+Tracer::Tracer()
+    : enabled_(false),
+      eventsPerThread_(1 << 14),
+      startNs_(nowNs()),
+      dumpStopping_(false)
+{
+}
+
+Tracer::~Tracer() {
+    stopPeriodicDump();
+}
+
+void Tracer::setEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+void Tracer::setEventsPerThread(size_t events) {
+    eventsPerThread_.store(std::max<size_t>(events, 1), std::memory_order_relaxed);
+}
+
+Tracer::ThreadBuffer::ThreadBuffer(uint32_t threadId, size_t capacity)
+    : id(threadId),
+      events(capacity)
+{
+}
+
+void Tracer::ThreadBuffer::record(const Event& event) {
+    std::lock_guard<std::mutex> lock(mutex);
+    events[next] = event;
+    if (++next == events.size()) {
+        next = 0;
+        wrapped = true;
+    }
+    // Few distinct probes per thread, so a linear scan beats hashing
+    auto it = std::find_if(aggregates.begin(), aggregates.end(),
+                           [&](const Aggregate& aggregate) { return aggregate.name == event.name; });
+    if (it == aggregates.end()) {
+        aggregates.push_back(Aggregate{event.name, event.counter, 0, 0.0, event.value, 0.0});
+        it = aggregates.end() - 1;
+    }
+    ++it->count;
+    it->total += event.value;
+    it->max = std::max(it->max, event.value);
+    it->last = event.value;
+}
+
+Tracer::ThreadBuffer& Tracer::threadBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(buffersMutex_);
+        buffer = std::make_shared<ThreadBuffer>(static_cast<uint32_t>(buffers_.size() + 1),
+                                                eventsPerThread_.load(std::memory_order_relaxed));
+        // Kept after the thread exits so its events can still be exported
+        buffers_.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Tracer::recordScope(const char* name, uint64_t startNs, uint64_t durationNs) {
+    threadBuffer().record(Event{name, startNs, static_cast<double>(durationNs), false});
+}
+
+void Tracer::recordCounter(const char* name, double value) {
+    threadBuffer().record(Event{name, nowNs(), value, true});
+}
+
+void Tracer::setThreadName(const char* name) {
+    auto& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.name = name;
+}
+
+void Tracer::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Failed to open trace file: " + path);
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() -> std::ostream& {
+        if (!first) {
+            out << ",\n";
+        }
+        first = false;
+        return out;
+    };
+
+    std::lock_guard<std::mutex> registryLock(buffersMutex_);
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        if (!buffer->name.empty()) {
+            separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id
+                        << ",\"args\":{\"name\":\"" << jsonEscape(buffer->name) << "\"}}";
+        }
+        size_t count = buffer->wrapped ? buffer->events.size() : buffer->next;
+        size_t begin = buffer->wrapped ? buffer->next : 0;
+        for (size_t i = 0; i < count; ++i) {
+            const Event& event = buffer->events[(begin + i) % buffer->events.size()];
+            // Chrome trace timestamps are microseconds
+            double ts = static_cast<double>(event.timestampNs - std::min(event.timestampNs, startNs_)) / 1000.0;
+            if (event.counter) {
+                separator() << "{\"name\":\"" << jsonEscape(event.name) << "\",\"ph\":\"C\",\"pid\":1,\"tid\":"
+                            << buffer->id << ",\"ts\":" << ts << ",\"args\":{\"value\":" << event.value << "}}";
+            } else {
+                separator() << "{\"name\":\"" << jsonEscape(event.name) << "\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+                            << buffer->id << ",\"ts\":" << ts << ",\"dur\":" << event.value / 1000.0 << "}";
+            }
+        }
+    }
+    out << "\n]}\n";
+    if (!out) {
+        throw std::runtime_error("Failed to write trace file: " + path);
+    }
+}
+
+std::vector<TraceStageStats> Tracer::stageStats() const {
+    std::map<std::string, TraceStageStats> merged;
+    std::lock_guard<std::mutex> registryLock(buffersMutex_);
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        for (const auto& aggregate : buffer->aggregates) {
+            auto& stats = merged[aggregate.name];
+            if (stats.count == 0) {
+                stats.name = aggregate.name;
+                stats.counter = aggregate.counter;
+                stats.max = aggregate.max;
+            }
+            stats.count += aggregate.count;
+            stats.total += aggregate.total;
+            stats.max = std::max(stats.max, aggregate.max);
+            stats.last = aggregate.last;
+        }
+    }
+    std::vector<TraceStageStats> result;
+    result.reserve(merged.size());
+    for (auto& entry : merged) {
+        result.push_back(std::move(entry.second));
+    }
+    return result;
+}
+
+std::string Tracer::statsReport() const {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(2);
+    ss << "Trace Stage Statistics\n";
+    ss << "======================\n";
+    for (const auto& stats : stageStats()) {
+        ss << "  " << stats.name << ": count " << stats.count;
+        if (stats.counter) {
+            ss << ", mean " << stats.mean() << ", max " << stats.max << ", last " << stats.last << "\n";
+        } else {
+            ss << ", mean " << stats.mean() / 1000.0 << " us, max " << stats.max / 1000.0
+               << " us, total " << stats.total / 1e6 << " ms\n";
+        }
+    }
+    return ss.str();
+}
+
+void Tracer::reset() {
+    std::lock_guard<std::mutex> registryLock(buffersMutex_);
+    for (const auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->next = 0;
+        buffer->wrapped = false;
+        buffer->aggregates.clear();
+    }
+}
+
+void Tracer::startPeriodicDump(std::chrono::milliseconds interval,
+                               std::function<void(const std::string&)> sink) {
+    stopPeriodicDump();
+    std::lock_guard<std::mutex> lock(dumpMutex_);
+    dumpStopping_ = false;
+    dumpThread_ = std::thread([this, interval, sink = std::move(sink)] {
+        std::unique_lock<std::mutex> lock(dumpMutex_);
+        while (!dumpCondition_.wait_for(lock, interval, [this] { return dumpStopping_; })) {
+            lock.unlock();
+            sink(statsReport());
+            lock.lock();
+        }
+    });
+}
+
+void Tracer::stopPeriodicDump() {
+    {
+        std::lock_guard<std::mutex> lock(dumpMutex_);
+        dumpStopping_ = true;
+    }
+    dumpCondition_.notify_all();
+    if (dumpThread_.joinable()) {
+        dumpThread_.join();
+    }
+}
+
+} // namespace novacrypt
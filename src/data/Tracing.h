@@ -0,0 +1,161 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Hot-path instrumentation. Build with -DNOVACRYPT_TRACING=1 to compile the
+// NOVACRYPT_TRACE_* macros in; otherwise they expand to nothing and cost
+// nothing. In a tracing build, Tracer::setEnabled() switches recording on
+// and off at run time for the price of one relaxed load per probe.
+//
+//   NOVACRYPT_TRACE_SCOPE("pipeline.drain");            // timed until scope exit
+//   NOVACRYPT_TRACE_COUNTER("pipeline.queue_depth", n); // sampled value
+//   NOVACRYPT_TRACE_THREAD_NAME("pipeline");            // label in the trace
+//
+// Names must be string literals (or otherwise outlive the tracer).
+
+namespace novacrypt {
+
+// Aggregate for one probe name across all threads
+struct TraceStageStats {
+    std::string name;
+    bool counter{false};
+    uint64_t count{0};
+    // Scopes: durations in ns. Counters: sampled values.
+    double total{0.0};
+    double max{0.0};
+    double last{0.0};
+
+    double mean() const { return count > 0 ? total / static_cast<double>(count) : 0.0; }
+};
+
+// Every thread that records gets its own event ring and per-name aggregates,
+// created on its first event; only the exporters ever touch another thread's
+// buffer. Rings keep the newest eventsPerThread events, while aggregates
+// count everything since the last reset().
+class Tracer {
+public:
+    static Tracer& instance();
+
+    void setEnabled(bool enabled);
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+    // Ring size for threads that start recording afterwards
+    void setEventsPerThread(size_t events);
+
+    void recordScope(const char* name, uint64_t startNs, uint64_t durationNs);
+    void recordCounter(const char* name, double value);
+    void setThreadName(const char* name);
+
+    // Chrome trace event format; open in chrome://tracing or ui.perfetto.dev.
+    // Throws std::runtime_error if the file cannot be written.
+    void writeChromeTrace(const std::string& path) const;
+    std::vector<TraceStageStats> stageStats() const;
+    std::string statsReport() const;
+    void reset();
+
+    // Hands statsReport() to sink every interval from a background thread
+    void startPeriodicDump(std::chrono::milliseconds interval,
+                           std::function<void(const std::string&)> sink);
+    void stopPeriodicDump();
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    struct Event {
+        const char* name;
+        uint64_t timestampNs;
+        double value;  // duration in ns for scopes
+        bool counter;
+    };
+
+    struct Aggregate {
+        const char* name;
+        bool counter;
+        uint64_t count;
+        double total;
+        double max;
+        double last;
+    };
+
+    struct ThreadBuffer {
+        explicit ThreadBuffer(uint32_t threadId, size_t capacity);
+
+        void record(const Event& event);
+
+        const uint32_t id;
+        mutable std::mutex mutex;  // uncontended except while exporting
+        std::string name;
+        std::vector<Event> events;
+        size_t next{0};
+        bool wrapped{false};
+        std::vector<Aggregate> aggregates;
+    };
+
+    Tracer();
+    ~Tracer();
+
+    ThreadBuffer& threadBuffer();
+
+    std::atomic<bool> enabled_;
+    std::atomic<size_t> eventsPerThread_;
+    const uint64_t startNs_;
+
+    mutable std::mutex buffersMutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+    std::mutex dumpMutex_;
+    std::condition_variable dumpCondition_;
+    bool dumpStopping_;
+    std::thread dumpThread_;
+};
+
+// Times its enclosing scope
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : name_(Tracer::instance().enabled() ? name : nullptr),
+          startNs_(name_ ? Tracer::nowNs() : 0) {}
+
+    ~TraceScope() {
+        if (name_) {
+            Tracer::instance().recordScope(name_, startNs_, Tracer::nowNs() - startNs_);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t startNs_;
+};
+
+} // namespace novacrypt
+
+#if defined(NOVACRYPT_TRACING) && NOVACRYPT_TRACING
+#define NOVACRYPT_TRACE_CONCAT_INNER(a, b) a##b
+#define NOVACRYPT_TRACE_CONCAT(a, b) NOVACRYPT_TRACE_CONCAT_INNER(a, b)
+#define NOVACRYPT_TRACE_SCOPE(name) \
+    ::novacrypt::TraceScope NOVACRYPT_TRACE_CONCAT(novacryptTraceScope, __LINE__)(name)
+#define NOVACRYPT_TRACE_COUNTER(name, value)                                          \
+    do {                                                                              \
+        if (::novacrypt::Tracer::instance().enabled()) {                              \
+            ::novacrypt::Tracer::instance().recordCounter(name, static_cast<double>(value)); \
+        }                                                                             \
+    } while (0)
+#define NOVACRYPT_TRACE_THREAD_NAME(name) ::novacrypt::Tracer::instance().setThreadName(name)
+#else
+#define NOVACRYPT_TRACE_SCOPE(name) ((void)0)
+#define NOVACRYPT_TRACE_COUNTER(name, value) ((void)0)
+#define NOVACRYPT_TRACE_THREAD_NAME(name) ((void)0)
+#endif
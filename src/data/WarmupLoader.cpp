@@ -0,0 +1,255 @@
+#include "WarmupLoader.h"
+#include "CandleStore.h"
+#include "MarketDataCapture.h"
+#include "ThreadAffinity.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace novacrypt {
+
+namespace {
+
+// Runs body(i) for i in [0, count) on up to `threads` threads, the caller
+// included, and rethrows the first exception once all of them finish
+template<typename Body>
+void parallelFor(size_t count, size_t threads, const Body& body) {
+    std::atomic<size_t> next{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+    auto work = [&] {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            try {
+                body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < std::min(threads, count); ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+int64_t toNanoseconds(std::chrono::system_clock::time_point timestamp) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+struct Tick {
+    double price;
+    double volume;
+    std::chrono::system_clock::time_point timestamp;
+};
+
+// One capture file, split by symbol
+struct DecodedCapture {
+    std::unordered_map<SymbolId, std::vector<Tick>> ticks;
+    std::unordered_map<SymbolId, std::pair<MarketDataUpdate, std::string>> lastTick;
+    std::vector<std::pair<std::string, double>> sentiment;  // newest per source, first-seen order
+};
+
+// The pipeline's validateMarketData() without the freshness check, which
+// history fails by definition; the source must be named, since the
+// pipeline resolves it by name
+bool isValidTick(const MarketDataUpdate& tick, const std::string& source) {
+    if (source.empty() || tick.symbol >= MarketDataPipeline::kMaxSymbols) {
+        return false;
+    }
+    if (tick.price <= 0.0 || tick.volume < 0.0) {
+        return false;
+    }
+    return tick.confidence >= 0.0 && tick.confidence <= 1.0;
+}
+
+DecodedCapture decodeCapture(const std::string& path) {
+    CaptureReader reader(path);
+    DecodedCapture decoded;
+    std::unordered_map<SourceId, size_t> sentimentSlot;
+    CaptureRecord record;
+    while (reader.next(record)) {
+        if (record.type == CaptureRecordType::MarketData) {
+            const auto& tick = record.marketData;
+            const std::string& source = reader.sourceName(tick.source);
+            if (!isValidTick(tick, source)) {
+                continue;
+            }
+            decoded.ticks[tick.symbol].push_back(Tick{tick.price, tick.volume, tick.timestamp});
+            decoded.lastTick[tick.symbol] = {tick, source};
+        } else if (record.type == CaptureRecordType::Sentiment) {
+            auto slot = sentimentSlot.emplace(record.source, decoded.sentiment.size());
+            if (slot.second) {
+                decoded.sentiment.emplace_back(reader.sourceName(record.source), record.sentiment);
+            } else {
+                decoded.sentiment[slot.first->second].second = record.sentiment;
+            }
+        }
+    }
+    return decoded;
+}
+
+} // namespace
+
+WarmupLoader::WarmupLoader(WarmupOptions options)
+    : options_(std::move(options)) {}
+
+void WarmupLoader::addCandleFile(SymbolId symbol, Timeframe timeframe, std::string path) {
+    if (symbol >= MarketDataPipeline::kMaxSymbols) {
+        throw std::invalid_argument("Symbol handle out of range");
+    }
+    candleFiles_.push_back(CandleFileJob{symbol, timeframe, std::move(path)});
+}
+
+void WarmupLoader::addCapture(std::string path) {
+    captures_.push_back(std::move(path));
+}
+
+void WarmupLoader::addSentimentHistory(SentimentSource source, std::vector<ScoredSentiment> items) {
+    sentimentHistory_.emplace_back(source, std::move(items));
+}
+
+const WarmupOptions& WarmupLoader::getOptions() const {
+    return options_;
+}
+
+WarmupResult WarmupLoader::load() const {
+    auto started = std::chrono::steady_clock::now();
+    size_t threads = options_.threads ? options_.threads : static_cast<size_t>(availableCores());
+    WarmupResult result;
+
+    std::vector<DecodedCapture> captures(captures_.size());
+    parallelFor(captures_.size(), threads, [&](size_t i) {
+        captures[i] = decodeCapture(captures_[i]);
+    });
+
+    // Candle files grouped by symbol, so each symbol is warmed by one thread
+    std::map<SymbolId, std::vector<const CandleFileJob*>> jobs;
+    for (const auto& job : candleFiles_) {
+        jobs[job.symbol].push_back(&job);
+    }
+    for (const auto& capture : captures) {
+        for (const auto& entry : capture.ticks) {
+            jobs[entry.first];
+        }
+    }
+    std::vector<SymbolId> symbols;
+    for (const auto& entry : jobs) {
+        symbols.push_back(entry.first);
+    }
+    result.symbols.resize(symbols.size());
+
+    std::atomic<uint64_t> bars{0};
+    std::atomic<uint64_t> ticks{0};
+    // The last index builds the sentiment analyzer alongside the symbols
+    parallelFor(symbols.size() + 1, threads, [&](size_t index) {
+        if (index == symbols.size()) {
+            if (!sentimentHistory_.empty()) {
+                auto analyzer = std::make_unique<SentimentAnalyzer>(options_.sentiment);
+                for (const auto& history : sentimentHistory_) {
+                    analyzer->ingest(history.first, history.second);
+                }
+                analyzer->flush();
+                result.sentiment = std::move(analyzer);
+            }
+            return;
+        }
+
+        auto warmed = std::make_unique<WarmedSymbol>();
+        warmed->symbol = symbols[index];
+        std::array<bool, kTimeframeCount> fromFile{};
+        std::array<int64_t, kTimeframeCount> lastFileBarNs{};
+        uint64_t symbolBars = 0;
+        for (const CandleFileJob* job : jobs.at(warmed->symbol)) {
+            MappedCandleFile file(job->path);
+            CandleColumns columns = file.columns();
+            size_t first = options_.maxBars && columns.size > options_.maxBars
+                               ? columns.size - options_.maxBars : 0;
+            size_t tf = static_cast<size_t>(job->timeframe);
+            auto& indicators = warmed->timeframeIndicators[tf];
+            // Bar by bar rather than through IndicatorBatch: the pipeline
+            // needs the streaming state (window contents, running moments
+            // and their resync phase, smoothed averages), which the batch
+            // kernels keep local, not the output columns they return
+            for (size_t row = first; row < columns.size; ++row) {
+                indicators.update(columns.at(row));
+            }
+            if (columns.size > first) {
+                warmed->closedBars[tf] = columns.at(columns.size - 1);
+                warmed->bars[tf] += columns.size - first;
+                int64_t lastNs = columns.timestamp[columns.size - 1];
+                lastFileBarNs[tf] = fromFile[tf] ? std::max(lastFileBarNs[tf], lastNs) : lastNs;
+                fromFile[tf] = true;
+                symbolBars += columns.size - first;
+            }
+        }
+
+        uint64_t symbolTicks = 0;
+        for (const auto& capture : captures) {
+            auto found = capture.ticks.find(warmed->symbol);
+            if (found == capture.ticks.end()) {
+                continue;
+            }
+            for (const auto& tick : found->second) {
+                uint8_t closed = warmed->candles.addTick(tick.price, tick.volume, tick.timestamp);
+                for (size_t tf = 0; closed && tf < kTimeframeCount; ++tf) {
+                    if (!(closed & (1u << tf))) {
+                        continue;
+                    }
+                    const OHLCV& bar = warmed->candles.closedBar(static_cast<Timeframe>(tf));
+                    int64_t barNs = toNanoseconds(bar.timestamp);
+                    if (fromFile[tf] && barNs <= lastFileBarNs[tf]) {
+                        continue;
+                    }
+                    warmed->timeframeIndicators[tf].update(bar);
+                    warmed->closedBars[tf] = bar;
+                    ++warmed->bars[tf];
+                }
+            }
+            symbolTicks += found->second.size();
+            const auto& last = capture.lastTick.at(warmed->symbol);
+            warmed->hasTick = true;
+            warmed->lastTick = last.first;
+            warmed->lastTickSource = last.second;
+        }
+
+        bars.fetch_add(symbolBars, std::memory_order_relaxed);
+        ticks.fetch_add(symbolTicks, std::memory_order_relaxed);
+        result.symbols[index] = std::move(warmed);
+    });
+
+    // Later captures overwrite earlier values for the same source
+    for (const auto& capture : captures) {
+        for (const auto& entry : capture.sentiment) {
+            auto existing = std::find_if(result.latestSentiment.begin(), result.latestSentiment.end(),
+                                         [&](const auto& item) { return item.first == entry.first; });
+            if (existing == result.latestSentiment.end()) {
+                result.latestSentiment.push_back(entry);
+            } else {
+                existing->second = entry.second;
+            }
+        }
+    }
+
+    result.bars = bars.load();
+    result.ticks = ticks.load();
+    result.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - started);
+    return result;
+}
+
+} // namespace novacrypt
@@ -0,0 +1,89 @@
+#pragma once
+#include "CandleAggregator.h"
+#include "MarketDataPipeline.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace novacrypt {
+
+struct WarmupOptions {
+    // Loader threads; 0 uses every available core
+    size_t threads{0};
+    // Newest bars fed from each candle file; 0 feeds the whole file
+    size_t maxBars{1000};
+    // Options of the sentiment analyzer built from sentiment history
+    SentimentOptions sentiment{};
+};
+
+// One symbol's processing state, primed off the processing thread
+struct WarmedSymbol {
+    SymbolId symbol{0};
+    CandleAggregator candles;  // open bars as of the last tick loaded
+    std::array<IndicatorManager, kTimeframeCount> timeframeIndicators;
+    std::array<OHLCV, kTimeframeCount> closedBars{};
+    std::array<uint64_t, kTimeframeCount> bars{};  // closed bars folded in
+    // Newest tick from a capture, if any; its source is named rather than
+    // a handle, since handles differ between the capture and the pipeline
+    bool hasTick{false};
+    MarketDataUpdate lastTick{};
+    std::string lastTickSource;
+};
+
+struct WarmupResult {
+    std::vector<std::unique_ptr<WarmedSymbol>> symbols;  // ascending SymbolId
+    std::unique_ptr<SentimentAnalyzer> sentiment;        // null without sentiment history
+    // Newest captured sentiment value per source name
+    std::vector<std::pair<std::string, double>> latestSentiment;
+    uint64_t bars{0};   // from candle files
+    uint64_t ticks{0};  // from captures
+    std::chrono::nanoseconds elapsed{0};
+};
+
+// Cold-start loader: builds primed indicator and sentiment state for many
+// symbols in parallel, to be installed with MarketDataPipeline::applyWarmup
+// before start(). Nothing goes through the pipeline's queues or callbacks,
+// so warming is a tight update loop per symbol instead of a replay on the
+// processing thread. Captured ticks are validated as the pipeline validates
+// market data, minus the freshness check; rejected ticks are skipped.
+//
+// Candle files (see CandleFileWriter) are memory mapped and their closed
+// bars fed straight into the timeframe's indicators. Capture ticks are rolled
+// into bars by a CandleAggregator exactly as the pipeline does live, so they
+// also leave the open bars in place. Captures are decoded in parallel, one
+// file per thread, then every symbol is warmed on its own thread.
+class WarmupLoader {
+public:
+    explicit WarmupLoader(WarmupOptions options = {});
+
+    // Closed bars for one symbol and timeframe, oldest first
+    void addCandleFile(SymbolId symbol, Timeframe timeframe, std::string path);
+    // Ticks for any symbols. Add captures oldest first; bars a capture closes
+    // at or before a candle file's last bar are not fed twice.
+    void addCapture(std::string path);
+    // Scored items for the sentiment analyzer handed to the pipeline
+    void addSentimentHistory(SentimentSource source, std::vector<ScoredSentiment> items);
+
+    // Throws std::runtime_error if a file cannot be opened or read
+    WarmupResult load() const;
+
+    const WarmupOptions& getOptions() const;
+
+private:
+    struct CandleFileJob {
+        SymbolId symbol;
+        Timeframe timeframe;
+        std::string path;
+    };
+
+    WarmupOptions options_;
+    std::vector<CandleFileJob> candleFiles_;
+    std::vector<std::string> captures_;
+    std::vector<std::pair<SentimentSource, std::vector<ScoredSentiment>>> sentimentHistory_;
+};
+
+} // namespace novacrypt
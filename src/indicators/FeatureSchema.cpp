@@ -0,0 +1,184 @@
+#include "FeatureSchema.h"
+#include "IndicatorManager.h"
+#include "../sentiment/SentimentAnalyzer.h"
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace novacrypt {
+
+namespace {
+
+constexpr size_t kDoublesPerAlignment = FeatureSchema::kAlignment / sizeof(double);
+
+bool isSentiment(FeatureKind kind) {
+    return kind >= FeatureKind::TwitterSentiment;
+}
+
+} // namespace
+
+FeatureSchema::FeatureSchema(std::vector<FeatureColumn> columns)
+    : columns_(std::move(columns)),
+      stride_(0),
+      usesSentiment_(false)
+{
+    if (columns_.empty()) {
+        throw std::invalid_argument("Feature schema needs at least one column");
+    }
+    for (const auto& column : columns_) {
+        if ((column.kind == FeatureKind::SMA || column.kind == FeatureKind::EMA) && column.period <= 0) {
+            throw std::invalid_argument("Moving average features need a positive period");
+        }
+        usesSentiment_ = usesSentiment_ || isSentiment(column.kind);
+    }
+    stride_ = (columns_.size() + kDoublesPerAlignment - 1) / kDoublesPerAlignment * kDoublesPerAlignment;
+}
+
+FeatureSchema FeatureSchema::standard(bool includeSentiment) {
+    std::vector<FeatureColumn> columns = {
+        {FeatureKind::RSI},
+        {FeatureKind::MACD},
+        {FeatureKind::MACDSignal},
+        {FeatureKind::MACDHistogram},
+        {FeatureKind::BBUpper},
+        {FeatureKind::BBMiddle},
+        {FeatureKind::BBLower},
+        {FeatureKind::ATR},
+        {FeatureKind::SMA, 20},
+        {FeatureKind::SMA, 50},
+        {FeatureKind::SMA, 200},
+        {FeatureKind::EMA, 12},
+        {FeatureKind::EMA, 26},
+        {FeatureKind::BidAskSpread},
+        {FeatureKind::OrderImbalance},
+        {FeatureKind::SlippageEstimate}
+    };
+    if (includeSentiment) {
+        columns.push_back({FeatureKind::TwitterSentiment});
+        columns.push_back({FeatureKind::RedditSentiment});
+        columns.push_back({FeatureKind::NewsSentiment});
+        columns.push_back({FeatureKind::AggregateSentiment});
+        columns.push_back({FeatureKind::SentimentMomentum});
+    }
+    return FeatureSchema(std::move(columns));
+}
+
+size_t FeatureSchema::size() const {
+    return columns_.size();
+}
+
+size_t FeatureSchema::stride() const {
+    return stride_;
+}
+
+const FeatureColumn& FeatureSchema::column(size_t index) const {
+    return columns_.at(index);
+}
+
+std::string FeatureSchema::name(size_t index) const {
+    const auto& column = columns_.at(index);
+    switch (column.kind) {
+        case FeatureKind::RSI: return "RSI";
+        case FeatureKind::MACD: return "MACD";
+        case FeatureKind::MACDSignal: return "MACD_SIGNAL";
+        case FeatureKind::MACDHistogram: return "MACD_HIST";
+        case FeatureKind::BBUpper: return "BB_UPPER";
+        case FeatureKind::BBMiddle: return "BB_MIDDLE";
+        case FeatureKind::BBLower: return "BB_LOWER";
+        case FeatureKind::ATR: return "ATR";
+        case FeatureKind::SMA: return "SMA_" + std::to_string(column.period);
+        case FeatureKind::EMA: return "EMA_" + std::to_string(column.period);
+        case FeatureKind::BidAskSpread: return "BID_ASK_SPREAD";
+        case FeatureKind::OrderImbalance: return "ORDER_IMBALANCE";
+        case FeatureKind::SlippageEstimate: return "SLIPPAGE_ESTIMATE";
+        case FeatureKind::TwitterSentiment: return "SENTIMENT_TWITTER";
+        case FeatureKind::RedditSentiment: return "SENTIMENT_REDDIT";
+        case FeatureKind::NewsSentiment: return "SENTIMENT_NEWS";
+        case FeatureKind::AggregateSentiment: return "SENTIMENT_AGGREGATE";
+        case FeatureKind::SentimentMomentum: return "SENTIMENT_MOMENTUM";
+    }
+    return "UNKNOWN";
+}
+
+bool FeatureSchema::usesSentiment() const {
+    return usesSentiment_;
+}
+
+void FeatureSchema::fill(const IndicatorManager& indicators, const SentimentAnalyzer* sentiment,
+                         double* out) const {
+    // Sentiment is read once per row, under a single analyzer lock
+    SentimentSnapshot snapshot;
+    if (usesSentiment_ && sentiment) {
+        snapshot = sentiment->getSnapshot();
+    }
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        const auto& column = columns_[i];
+        double value = 0.0;
+        switch (column.kind) {
+            case FeatureKind::RSI: value = indicators.getRSI(); break;
+            case FeatureKind::MACD: value = indicators.getMACD(); break;
+            case FeatureKind::MACDSignal: value = indicators.getMACDSignal(); break;
+            case FeatureKind::MACDHistogram: value = indicators.getMACDHistogram(); break;
+            case FeatureKind::BBUpper: value = indicators.getBBUpper(); break;
+            case FeatureKind::BBMiddle: value = indicators.getBBMiddle(); break;
+            case FeatureKind::BBLower: value = indicators.getBBLower(); break;
+            case FeatureKind::ATR: value = indicators.getATR(); break;
+            case FeatureKind::SMA: value = indicators.getSMA(column.period); break;
+            case FeatureKind::EMA: value = indicators.getEMA(column.period); break;
+            case FeatureKind::BidAskSpread: value = indicators.getBidAskSpread(); break;
+            case FeatureKind::OrderImbalance: value = indicators.getOrderImbalance(); break;
+            case FeatureKind::SlippageEstimate: value = indicators.getSlippageEstimate(); break;
+            case FeatureKind::TwitterSentiment: value = snapshot.twitter; break;
+            case FeatureKind::RedditSentiment: value = snapshot.reddit; break;
+            case FeatureKind::NewsSentiment: value = snapshot.news; break;
+            case FeatureKind::AggregateSentiment: value = snapshot.aggregate; break;
+            case FeatureKind::SentimentMomentum: value = snapshot.momentum; break;
+        }
+        out[i] = value;
+    }
+}
+
+FeatureBuffer::FeatureBuffer(const FeatureSchema& schema, size_t rows)
+    : data_(nullptr),
+      rows_(rows),
+      columns_(schema.size()),
+      stride_(schema.stride())
+{
+    if (rows_ == 0) {
+        throw std::invalid_argument("Feature buffer needs at least one row");
+    }
+    size_t bytes = rows_ * stride_ * sizeof(double);
+    void* block = std::aligned_alloc(FeatureSchema::kAlignment, bytes);
+    if (!block) {
+        throw std::bad_alloc();
+    }
+    std::memset(block, 0, bytes);
+    storage_.reset(block);
+    data_ = static_cast<double*>(block);
+}
+
+double* FeatureBuffer::row(size_t index) {
+    return data_ + index * stride_;
+}
+
+const double* FeatureBuffer::row(size_t index) const {
+    return data_ + index * stride_;
+}
+
+const double* FeatureBuffer::data() const {
+    return data_;
+}
+
+size_t FeatureBuffer::rows() const {
+    return rows_;
+}
+
+size_t FeatureBuffer::columns() const {
+    return columns_;
+}
+
+size_t FeatureBuffer::stride() const {
+    return stride_;
+}
+
+} // namespace novacrypt
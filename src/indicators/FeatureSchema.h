@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace novacrypt {
+
+class IndicatorManager;
+class SentimentAnalyzer;
+
+enum class FeatureKind : uint8_t {
+    RSI,
+    MACD,
+    MACDSignal,
+    MACDHistogram,
+    BBUpper,
+    BBMiddle,
+    BBLower,
+    ATR,
+    SMA,  // period required
+    EMA,  // period required
+    BidAskSpread,
+    OrderImbalance,
+    SlippageEstimate,
+    TwitterSentiment,
+    RedditSentiment,
+    NewsSentiment,
+    AggregateSentiment,
+    SentimentMomentum
+};
+
+struct FeatureColumn {
+    FeatureKind kind;
+    int period{0};  // SMA and EMA only
+};
+
+// Column layout for model input, fixed at construction. fill() writes one
+// row from the indicators, order book metrics and sentiment in a single pass
+// without allocating, so the same column always lands at the same offset.
+class FeatureSchema {
+public:
+    static constexpr size_t kAlignment = 64;  // bytes; FeatureBuffer rows start here
+
+    explicit FeatureSchema(std::vector<FeatureColumn> columns);
+
+    // The previous getFeatureVector() layout: RSI, MACD (value, signal,
+    // histogram), Bollinger bands, ATR, SMA 20/50/200, EMA 12/26, spread,
+    // imbalance and slippage, then optionally the five sentiment features.
+    static FeatureSchema standard(bool includeSentiment = true);
+
+    size_t size() const;
+    // Doubles per FeatureBuffer row: size() padded to a whole kAlignment
+    size_t stride() const;
+    const FeatureColumn& column(size_t index) const;
+    std::string name(size_t index) const;
+    bool usesSentiment() const;
+
+    // Writes size() values to out. Sentiment columns are 0 without an
+    // analyzer; a moving average the manager does not track is 0 too.
+    void fill(const IndicatorManager& indicators, const SentimentAnalyzer* sentiment, double* out) const;
+
+private:
+    std::vector<FeatureColumn> columns_;
+    size_t stride_;
+    bool usesSentiment_;
+};
+
+// Zeroed, row-major feature storage for a schema: each row starts on a
+// FeatureSchema::kAlignment boundary and the padding after size() columns
+// stays 0. Pass data(), rows(), columns() and stride() to EnsembleModel's
+// FeatureMatrix to predict straight from it.
+class FeatureBuffer {
+public:
+    explicit FeatureBuffer(const FeatureSchema& schema, size_t rows = 1);
+
+    double* row(size_t index);
+    const double* row(size_t index) const;
+    const double* data() const;
+
+    size_t rows() const;
+    size_t columns() const;
+    size_t stride() const;
+
+private:
+    struct AlignedFree {
+        void operator()(void* ptr) const { std::free(ptr); }
+    };
+
+    std::unique_ptr<void, AlignedFree> storage_;
+    double* data_;
+    size_t rows_;
+    size_t columns_;
+    size_t stride_;
+};
+
+} // namespace novacrypt
@@ -0,0 +1,292 @@
+#include "IndicatorBatch.h"
+#include "IndicatorKernels.h"
+#include "RollingWindow.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace novacrypt {
+
+namespace {
+
+std::vector<double> exponentialAverages(const double* values, size_t count, int period) {
+    std::vector<double> out(count);
+    ExponentialAverage average(period);
+    for (size_t i = 0; i < count; ++i) {
+        average.push(values[i]);
+        out[i] = average.value;
+    }
+    return out;
+}
+
+size_t toWindow(int period) {
+    if (period <= 0) {
+        throw std::invalid_argument("Indicator period must be positive");
+    }
+    return static_cast<size_t>(period);
+}
+
+// Index of the first push after which RollingWindow(period) recomputes its
+// sum; later ones follow every resyncStride(period) pushes
+size_t firstResync(size_t period) {
+    return period * (kWindowResyncWraps + 1) - 1;
+}
+
+size_t resyncStride(size_t period) {
+    return period * kWindowResyncWraps;
+}
+
+// The window sum as RollingWindow recomputes it after pushing values[last]
+double resyncedSum(const double* values, size_t last, size_t period) {
+    WindowMoments moments;
+    moments.recompute(values + last + 1 - period, period);
+    return moments.sum;
+}
+
+} // namespace
+
+void slidingMeans(const double* values, size_t count,
+                  const int* periods, size_t lanes, double* const* outputs) {
+    size_t lane = 0;
+
+#if defined(__AVX2__)
+    // Four periods per register; each lane performs exactly the scalar
+    // sequence sum += value - evicted, resynced at the same pushes, so the
+    // results match lane by lane
+    for (; lane + 4 <= lanes; lane += 4) {
+        const size_t p0 = toWindow(periods[lane]);
+        const size_t p1 = toWindow(periods[lane + 1]);
+        const size_t p2 = toWindow(periods[lane + 2]);
+        const size_t p3 = toWindow(periods[lane + 3]);
+        double* out0 = outputs[lane];
+        double* out1 = outputs[lane + 1];
+        double* out2 = outputs[lane + 2];
+        double* out3 = outputs[lane + 3];
+        const size_t warmup = std::min(count, std::max({p0, p1, p2, p3}));
+
+        const size_t period[4] = {p0, p1, p2, p3};
+        size_t resync[4] = {firstResync(p0), firstResync(p1), firstResync(p2), firstResync(p3)};
+        size_t nextResync = std::min({resync[0], resync[1], resync[2], resync[3]});
+        auto resyncLanes = [&](__m256d sum, size_t i) {
+            alignas(32) double sums[4];
+            _mm256_store_pd(sums, sum);
+            for (size_t k = 0; k < 4; ++k) {
+                if (resync[k] == i) {
+                    sums[k] = resyncedSum(values, i, period[k]);
+                    resync[k] += resyncStride(period[k]);
+                }
+            }
+            nextResync = std::min({resync[0], resync[1], resync[2], resync[3]});
+            return _mm256_load_pd(sums);
+        };
+
+        __m256d sum = _mm256_setzero_pd();
+        alignas(32) double mean[4];
+        size_t i = 0;
+        for (; i < warmup; ++i) {
+            __m256d x = _mm256_set1_pd(values[i]);
+            __m256d evicted = _mm256_setr_pd(i >= p0 ? values[i - p0] : 0.0,
+                                             i >= p1 ? values[i - p1] : 0.0,
+                                             i >= p2 ? values[i - p2] : 0.0,
+                                             i >= p3 ? values[i - p3] : 0.0);
+            __m256d n = _mm256_setr_pd(static_cast<double>(std::min(i + 1, p0)),
+                                       static_cast<double>(std::min(i + 1, p1)),
+                                       static_cast<double>(std::min(i + 1, p2)),
+                                       static_cast<double>(std::min(i + 1, p3)));
+            sum = _mm256_add_pd(sum, _mm256_sub_pd(x, evicted));
+            if (i == nextResync) {
+                sum = resyncLanes(sum, i);
+            }
+            _mm256_store_pd(mean, _mm256_div_pd(sum, n));
+            out0[i] = mean[0];
+            out1[i] = mean[1];
+            out2[i] = mean[2];
+            out3[i] = mean[3];
+        }
+
+        const __m256d n = _mm256_setr_pd(static_cast<double>(p0), static_cast<double>(p1),
+                                         static_cast<double>(p2), static_cast<double>(p3));
+        for (; i < count; ++i) {
+            __m256d x = _mm256_set1_pd(values[i]);
+            __m256d evicted = _mm256_setr_pd(values[i - p0], values[i - p1],
+                                             values[i - p2], values[i - p3]);
+            sum = _mm256_add_pd(sum, _mm256_sub_pd(x, evicted));
+            if (i == nextResync) {
+                sum = resyncLanes(sum, i);
+            }
+            _mm256_store_pd(mean, _mm256_div_pd(sum, n));
+            out0[i] = mean[0];
+            out1[i] = mean[1];
+            out2[i] = mean[2];
+            out3[i] = mean[3];
+        }
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    // Two periods per register, same per-lane operation order as AVX2
+    for (; lane + 2 <= lanes; lane += 2) {
+        const size_t p0 = toWindow(periods[lane]);
+        const size_t p1 = toWindow(periods[lane + 1]);
+        double* out0 = outputs[lane];
+        double* out1 = outputs[lane + 1];
+
+        size_t resync0 = firstResync(p0);
+        size_t resync1 = firstResync(p1);
+
+        float64x2_t sum = vdupq_n_f64(0.0);
+        double lanesIn[2];
+        double lanesN[2];
+        for (size_t i = 0; i < count; ++i) {
+            float64x2_t x = vdupq_n_f64(values[i]);
+            lanesIn[0] = i >= p0 ? values[i - p0] : 0.0;
+            lanesIn[1] = i >= p1 ? values[i - p1] : 0.0;
+            lanesN[0] = static_cast<double>(std::min(i + 1, p0));
+            lanesN[1] = static_cast<double>(std::min(i + 1, p1));
+            sum = vaddq_f64(sum, vsubq_f64(x, vld1q_f64(lanesIn)));
+            if (i == resync0 || i == resync1) {
+                double sums[2] = {vgetq_lane_f64(sum, 0), vgetq_lane_f64(sum, 1)};
+                if (i == resync0) {
+                    sums[0] = resyncedSum(values, i, p0);
+                    resync0 += resyncStride(p0);
+                }
+                if (i == resync1) {
+                    sums[1] = resyncedSum(values, i, p1);
+                    resync1 += resyncStride(p1);
+                }
+                sum = vld1q_f64(sums);
+            }
+            float64x2_t mean = vdivq_f64(sum, vld1q_f64(lanesN));
+            out0[i] = vgetq_lane_f64(mean, 0);
+            out1[i] = vgetq_lane_f64(mean, 1);
+        }
+    }
+#endif
+
+    // Scalar fallback and leftover lanes
+    for (; lane < lanes; ++lane) {
+        const size_t period = toWindow(periods[lane]);
+        double* out = outputs[lane];
+        double sum = 0.0;
+        size_t resync = firstResync(period);
+        for (size_t i = 0; i < count; ++i) {
+            sum += i >= period ? values[i] - values[i - period] : values[i];
+            if (i == resync) {
+                sum = resyncedSum(values, i, period);
+                resync += resyncStride(period);
+            }
+            out[i] = sum / static_cast<double>(std::min(i + 1, period));
+        }
+    }
+}
+
+IndicatorBatch::IndicatorBatch(IndicatorBatchConfig config) : config_(std::move(config)) {}
+
+const IndicatorBatchConfig& IndicatorBatch::getConfig() const {
+    return config_;
+}
+
+IndicatorSeries IndicatorBatch::computeSeries(const std::vector<OHLCV>& data) const {
+    return computeSeries(data.data(), data.size());
+}
+
+IndicatorSeries IndicatorBatch::computeSeries(const CandleColumns& candles) const {
+    return computeSeries(candles.high, candles.low, candles.close, candles.size);
+}
+
+IndicatorSeries IndicatorBatch::computeSeries(const OHLCV* data, size_t count) const {
+    // Transpose once so every kernel streams through contiguous columns
+    std::vector<double> high(count);
+    std::vector<double> low(count);
+    std::vector<double> close(count);
+    for (size_t i = 0; i < count; ++i) {
+        high[i] = data[i].high;
+        low[i] = data[i].low;
+        close[i] = data[i].close;
+    }
+    return computeSeries(high.data(), low.data(), close.data(), count);
+}
+
+IndicatorSeries IndicatorBatch::computeSeries(const double* high, const double* low,
+                                              const double* close, size_t count) const {
+    IndicatorSeries series;
+
+    // Simple moving averages, all periods in one pass
+    std::vector<double*> smaOutputs;
+    smaOutputs.reserve(config_.smaPeriods.size());
+    for (int period : config_.smaPeriods) {
+        auto& column = series.sma[period];
+        column.resize(count);
+        smaOutputs.push_back(column.data());
+    }
+    slidingMeans(close, count, config_.smaPeriods.data(), config_.smaPeriods.size(),
+                 smaOutputs.data());
+
+    // Exponential moving averages
+    for (int period : config_.emaPeriods) {
+        series.ema[period] = exponentialAverages(close, count, period);
+    }
+
+    // MACD reuses the EMA columns when the periods coincide
+    auto emaColumn = [&](int period) {
+        auto it = series.ema.find(period);
+        return it != series.ema.end() ? it->second : exponentialAverages(close, count, period);
+    };
+    const std::vector<double> fast = emaColumn(config_.macdFastPeriod);
+    const std::vector<double> slow = emaColumn(config_.macdSlowPeriod);
+    series.macd.resize(count);
+    series.macdSignal.resize(count);
+    series.macdHistogram.resize(count);
+    ExponentialAverage signal(config_.macdSignalPeriod);
+    for (size_t i = 0; i < count; ++i) {
+        double macdLine = fast[i] - slow[i];
+        signal.push(macdLine);
+        series.macd[i] = macdLine;
+        series.macdSignal[i] = signal.value;
+        series.macdHistogram[i] = macdLine - signal.value;
+    }
+
+    // Bollinger Bands
+    series.bbUpper.resize(count);
+    series.bbMiddle.resize(count);
+    series.bbLower.resize(count);
+    RollingWindow window(toWindow(config_.bbPeriod));
+    for (size_t i = 0; i < count; ++i) {
+        window.push(close[i]);
+        double middle = window.mean();
+        double std = std::sqrt(window.variance());
+        series.bbMiddle[i] = middle;
+        series.bbUpper[i] = middle + (config_.bbStdDev * std);
+        series.bbLower[i] = middle - (config_.bbStdDev * std);
+    }
+
+    // RSI and ATR share the previous-close recurrence
+    series.rsi.resize(count);
+    series.atr.resize(count);
+    WilderAverage avgGain(config_.rsiPeriod);
+    WilderAverage avgLoss(config_.rsiPeriod);
+    WilderAverage atr(config_.atrPeriod);
+    for (size_t i = 0; i < count; ++i) {
+        if (i > 0) {
+            double change = close[i] - close[i - 1];
+            avgGain.push(change >= 0 ? change : 0.0);
+            avgLoss.push(change >= 0 ? 0.0 : -change);
+            atr.push(trueRange(high[i], low[i], close[i - 1]));
+        }
+        if (avgLoss.value == 0.0) {
+            series.rsi[i] = 100.0;
+        } else {
+            double rs = avgGain.value / avgLoss.value;
+            series.rsi[i] = 100.0 - (100.0 / (1.0 + rs));
+        }
+        series.atr[i] = atr.value;
+    }
+
+    return series;
+}
+
+} // namespace novacrypt
@@ -0,0 +1,72 @@
+#pragma once
+#include "MarketData.h"
+#include <map>
+#include <vector>
+
+namespace novacrypt {
+
+// Indicator parameters for batch computation; the defaults match the set
+// IndicatorManager builds in initializeIndicators()
+struct IndicatorBatchConfig {
+    int rsiPeriod{14};
+    int macdFastPeriod{12};
+    int macdSlowPeriod{26};
+    int macdSignalPeriod{9};
+    int bbPeriod{20};
+    double bbStdDev{2.0};
+    int atrPeriod{14};
+    std::vector<int> smaPeriods{20, 50, 200};
+    std::vector<int> emaPeriods{12, 26};
+};
+
+// Columnar indicator output, one value per input candle. Entry i equals what
+// the streaming indicator would return after its update() with candle i.
+struct IndicatorSeries {
+    std::vector<double> rsi;
+    std::vector<double> macd;
+    std::vector<double> macdSignal;
+    std::vector<double> macdHistogram;
+    std::vector<double> bbUpper;
+    std::vector<double> bbMiddle;
+    std::vector<double> bbLower;
+    std::vector<double> atr;
+    std::map<int, std::vector<double>> sma;  // keyed by period
+    std::map<int, std::vector<double>> ema;  // keyed by period
+
+    size_t size() const { return rsi.size(); }
+};
+
+// Computes the full indicator feature set over a historical series in one
+// pass per kernel, without virtual dispatch. Window sums for all SMA periods
+// run side by side in AVX2 or NEON lanes when the build targets those ISAs,
+// with a scalar fallback otherwise. The Bollinger Bands, EMA, MACD, RSI and
+// ATR kernels are scalar loops over the streaming classes' state. Results are
+// bit-identical to feeding the candles one at a time through the streaming
+// classes in MarketData.h, provided the build does not contract floating-point
+// operations into FMAs (-ffp-contract=off).
+class IndicatorBatch {
+public:
+    explicit IndicatorBatch(IndicatorBatchConfig config = IndicatorBatchConfig{});
+
+    IndicatorSeries computeSeries(const OHLCV* data, size_t count) const;
+    IndicatorSeries computeSeries(const std::vector<OHLCV>& data) const;
+    
+    // Zero-copy over columnar storage such as CandleStore or MappedCandleFile
+    IndicatorSeries computeSeries(const CandleColumns& candles) const;
+
+    // Column-oriented entry point used by the AoS overloads after transposing
+    IndicatorSeries computeSeries(const double* high, const double* low,
+                                  const double* close, size_t count) const;
+
+    const IndicatorBatchConfig& getConfig() const;
+
+private:
+    IndicatorBatchConfig config_;
+};
+
+// Sliding-window means over values for several periods at once, written to
+// outputs[lane][i]. Matches RollingWindow::mean() after each push.
+void slidingMeans(const double* values, size_t count,
+                  const int* periods, size_t lanes, double* const* outputs);
+
+} // namespace novacrypt
@@ -0,0 +1,58 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+namespace novacrypt {
+
+// Recurrence kernels shared by the streaming indicators and the batch engine.
+// Both paths step through these same inline functions, which is what keeps
+// their outputs bit-identical.
+
+// Exponential moving average seeded with the first value
+struct ExponentialAverage {
+    explicit ExponentialAverage(int period)
+        : alpha(2.0 / (period + 1)), value(0.0), initialized(false) {}
+
+    void push(double x) {
+        if (!initialized) {
+            value = x;
+            initialized = true;
+        } else {
+            value = alpha * x + (1 - alpha) * value;
+        }
+    }
+
+    double alpha;  // Smoothing factor
+    double value;
+    bool initialized;
+};
+
+// Wilder's smoothed average, seeded with the simple average of the first
+// period samples
+struct WilderAverage {
+    explicit WilderAverage(int period)
+        : period(period), samples(0), value(0.0) {}
+
+    void push(double x) {
+        if (samples < period) {
+            ++samples;
+            value += (x - value) / samples;
+        } else {
+            value = (value * (period - 1) + x) / period;
+        }
+    }
+
+    int period;
+    int samples;  // capped at period
+    double value;
+};
+
+// Wilder's true range against the previous close
+inline double trueRange(double high, double low, double previousClose) {
+    double high_low = high - low;
+    double high_close = std::abs(high - previousClose);
+    double low_close = std::abs(low - previousClose);
+    return std::max({high_low, high_close, low_close});
+}
+
+} // namespace novacrypt
@@ -1,6 +1,9 @@
 #include "IndicatorManager.h"
+#include "FeatureSchema.h"
+#include "../data/Tracing.h"
 #include <algorithm>
-#include <numeric>
+#include <stdexcept>
+#include <vector>
 
 namespace novacrypt {
 
@@ -25,6 +28,7 @@ void IndicatorManager::initializeIndicators() {
 }
 
 void IndicatorManager::update(const OHLCV& data) {
+    NOVACRYPT_TRACE_SCOPE("indicators.update");
     rsi_->update(data);
     macd_->update(data);
     bb_->update(data);
@@ -39,6 +43,65 @@ void IndicatorManager::update(const OHLCV& data) {
     }
 }
 
+namespace {
+
+// Periods in ascending order, so the encoding does not depend on hash order
+template<typename Map>
+std::vector<int> sortedPeriods(const Map& indicators) {
+    std::vector<int> periods;
+    for (const auto& entry : indicators) {
+        periods.push_back(entry.first);
+    }
+    std::sort(periods.begin(), periods.end());
+    return periods;
+}
+
+template<typename Map>
+void saveAverages(StateWriter& out, const Map& indicators) {
+    auto periods = sortedPeriods(indicators);
+    out.put<uint32_t>(static_cast<uint32_t>(periods.size()));
+    for (int period : periods) {
+        out.put<int32_t>(period);
+        indicators.at(period)->saveState(out);
+    }
+}
+
+template<typename Indicator, typename Map>
+void loadAverages(StateReader& in, Map& indicators) {
+    uint32_t count = in.get<uint32_t>();
+    for (uint32_t i = 0; i < count; ++i) {
+        int period = in.get<int32_t>();
+        if (period <= 0) {
+            throw std::runtime_error("Corrupt checkpointed moving average");
+        }
+        auto& indicator = indicators[period];
+        if (!indicator) {
+            indicator = std::make_unique<Indicator>(period);
+        }
+        indicator->loadState(in);
+    }
+}
+
+} // namespace
+
+void IndicatorManager::saveState(StateWriter& out) const {
+    rsi_->saveState(out);
+    macd_->saveState(out);
+    bb_->saveState(out);
+    atr_->saveState(out);
+    saveAverages(out, smas_);
+    saveAverages(out, emas_);
+}
+
+void IndicatorManager::loadState(StateReader& in) {
+    rsi_->loadState(in);
+    macd_->loadState(in);
+    bb_->loadState(in);
+    atr_->loadState(in);
+    loadAverages<SMA>(in, smas_);
+    loadAverages<EMA>(in, emas_);
+}
+
 double IndicatorManager::getIndicatorValue(const std::string& name) const {
     if (name == "RSI") return getRSI();
     if (name == "MACD") return getMACD();
@@ -52,32 +115,9 @@ double IndicatorManager::getIndicatorValue(const std::string& name) const {
 }
 
 std::vector<double> IndicatorManager::getFeatureVector() const {
-    std::vector<double> features;
-    
-    // Add all indicator values
-    features.push_back(getRSI());
-    features.push_back(getMACD());
-    features.push_back(getMACDSignal());
-    features.push_back(getMACDHistogram());
-    features.push_back(getBBUpper());
-    features.push_back(getBBMiddle());
-    features.push_back(getBBLower());
-    features.push_back(getATR());
-    
-    // Add moving averages
-    for (const auto& sma : smas_) {
-        features.push_back(sma.second->getValue());
-    }
-    
-    for (const auto& ema : emas_) {
-        features.push_back(ema.second->getValue());
-    }
-    
-    // Add order book metrics
-    features.push_back(getBidAskSpread());
-    features.push_back(getOrderImbalance());
-    features.push_back(getSlippageEstimate());
-    
+    static const FeatureSchema schema = FeatureSchema::standard(false);
+    std::vector<double> features(schema.size());
+    schema.fill(*this, nullptr, features.data());
     return features;
 }
 
@@ -130,48 +170,31 @@ double IndicatorManager::getEMA(int period) const {
 }
 
 void IndicatorManager::updateOrderBook(const OrderBook& orderBook) {
-    currentOrderBook_ = orderBook;
+    orderBook_.applySnapshot(orderBook);
+}
+
+bool IndicatorManager::applyOrderBookDelta(BookSide side, double price, double quantity) {
+    return orderBook_.applyDelta(side, price, quantity);
+}
+
+OrderBookEngine& IndicatorManager::getOrderBook() {
+    return orderBook_;
+}
+
+const OrderBookEngine& IndicatorManager::getOrderBook() const {
+    return orderBook_;
 }
 
 double IndicatorManager::getBidAskSpread() const {
-    if (currentOrderBook_.bids.empty() || currentOrderBook_.asks.empty()) {
-        return 0.0;
-    }
-    
-    double bestBid = currentOrderBook_.bids.front().price;
-    double bestAsk = currentOrderBook_.asks.front().price;
-    
-    return bestAsk - bestBid;
+    return orderBook_.spread();
 }
 
 double IndicatorManager::getOrderImbalance() const {
-    if (currentOrderBook_.bids.empty() || currentOrderBook_.asks.empty()) {
-        return 0.0;
-    }
-    
-    double bidVolume = std::accumulate(currentOrderBook_.bids.begin(), currentOrderBook_.bids.end(),
-                                     0.0, [](double sum, const OrderBookLevel& level) {
-                                         return sum + level.quantity;
-                                     });
-    
-    double askVolume = std::accumulate(currentOrderBook_.asks.begin(), currentOrderBook_.asks.end(),
-                                     0.0, [](double sum, const OrderBookLevel& level) {
-                                         return sum + level.quantity;
-                                     });
-    
-    return (bidVolume - askVolume) / (bidVolume + askVolume);
+    return orderBook_.imbalance();
 }
 
 double IndicatorManager::getSlippageEstimate() const {
-    if (currentOrderBook_.bids.empty() || currentOrderBook_.asks.empty()) {
-        return 0.0;
-    }
-    
-    double midPrice = (currentOrderBook_.bids.front().price + currentOrderBook_.asks.front().price) / 2.0;
-    double spread = getBidAskSpread();
-    
-    // Estimate slippage based on order book depth and spread
-    return spread * (1.0 + std::abs(getOrderImbalance()));
+    return orderBook_.slippageEstimate();
 }
 
 } // namespace novacrypt 
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "MarketData.h"
+#include "OrderBookEngine.h"
 #include <memory>
 #include <unordered_map>
 #include <string>
@@ -16,7 +17,9 @@ public:
     // Get indicator values
     double getIndicatorValue(const std::string& name) const;
     
-    // Get all current indicator values as a feature vector
+    // Get all current indicator values as a feature vector, in
+    // FeatureSchema::standard(false) order; FeatureSchema::fill is the
+    // allocation-free form
     std::vector<double> getFeatureVector() const;
     
     // Get specific indicator values
@@ -36,8 +39,16 @@ public:
     double getOrderImbalance() const;
     double getSlippageEstimate() const;
     
-    // Update order book data
+    // Update order book data: full snapshot or a single level diff
     void updateOrderBook(const OrderBook& orderBook);
+    bool applyOrderBookDelta(BookSide side, double price, double quantity);
+    OrderBookEngine& getOrderBook();
+    const OrderBookEngine& getOrderBook() const;
+    
+    // Checkpoint every indicator's internal state. The order book is not
+    // included; it is rebuilt from the next exchange snapshot.
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
 
 private:
     // Technical indicators
@@ -49,7 +60,7 @@ private:
     std::unordered_map<int, std::unique_ptr<EMA>> emas_;
     
     // Order book data
-    OrderBook currentOrderBook_;
+    OrderBookEngine orderBook_;
     
     // Initialize indicators with default parameters
     void initializeIndicators();
@@ -0,0 +1,289 @@
+#pragma once
+#include "MarketData.h"
+#include "RollingWindow.h"
+#include "IndicatorKernels.h"
+#include <cmath>
+#include <cstddef>
+#include <ratio>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace novacrypt {
+
+// Indicators with compile-time parameters for IndicatorSet. Each one steps
+// through the same kernels as its runtime counterpart in MarketData.h, so
+// the values match exactly. Every type exposes update(), value(), and
+// kOutputs values written by write(); the outputs are the feature columns
+// FeatureSchema uses for the same indicator.
+namespace fixed {
+
+template <int Period>
+class SMA {
+    static_assert(Period > 0, "SMA period must be positive");
+
+public:
+    static constexpr size_t kOutputs = 1;
+
+    void update(const OHLCV& data) { window_.push(data.close); }
+    double value() const { return window_.mean(); }
+    void write(double* out) const { out[0] = value(); }
+
+private:
+    FixedRollingWindow<static_cast<size_t>(Period)> window_;
+};
+
+template <int Period>
+class EMA {
+    static_assert(Period > 0, "EMA period must be positive");
+
+public:
+    static constexpr size_t kOutputs = 1;
+
+    void update(const OHLCV& data) { average_.push(data.close); }
+    double value() const { return average_.value; }
+    void write(double* out) const { out[0] = value(); }
+
+private:
+    ExponentialAverage average_{Period};
+};
+
+template <int Period>
+class RSI {
+    static_assert(Period > 0, "RSI period must be positive");
+
+public:
+    static constexpr size_t kOutputs = 1;
+
+    void update(const OHLCV& data) {
+        if (!hasPrevious_) {
+            previousClose_ = data.close;
+            hasPrevious_ = true;
+            return;
+        }
+        double change = data.close - previousClose_;
+        previousClose_ = data.close;
+        avgGain_.push(change >= 0 ? change : 0.0);
+        avgLoss_.push(change >= 0 ? 0.0 : -change);
+    }
+
+    double value() const {
+        if (avgLoss_.value == 0.0) return 100.0;
+        double rs = avgGain_.value / avgLoss_.value;
+        return 100.0 - (100.0 / (1.0 + rs));
+    }
+
+    void write(double* out) const { out[0] = value(); }
+
+private:
+    double previousClose_{0.0};
+    bool hasPrevious_{false};
+    WilderAverage avgGain_{Period};
+    WilderAverage avgLoss_{Period};
+};
+
+// Outputs: MACD line, signal line, histogram
+template <int FastPeriod, int SlowPeriod, int SignalPeriod>
+class MACD {
+    static_assert(FastPeriod > 0 && SlowPeriod > 0 && SignalPeriod > 0, "MACD periods must be positive");
+
+public:
+    static constexpr size_t kOutputs = 3;
+
+    void update(const OHLCV& data) {
+        fast_.push(data.close);
+        slow_.push(data.close);
+        macdLine_ = fast_.value - slow_.value;
+        signal_.push(macdLine_);
+    }
+
+    double value() const { return macdLine_; }
+    double signal() const { return signal_.value; }
+    double histogram() const { return macdLine_ - signal_.value; }
+
+    void write(double* out) const {
+        out[0] = value();
+        out[1] = signal();
+        out[2] = histogram();
+    }
+
+private:
+    ExponentialAverage fast_{FastPeriod};
+    ExponentialAverage slow_{SlowPeriod};
+    ExponentialAverage signal_{SignalPeriod};
+    double macdLine_{0.0};
+};
+
+// Width in standard deviations as a std::ratio, e.g. std::ratio<5, 2> for 2.5.
+// Outputs: upper, middle, lower band.
+template <int Period, typename StdDev = std::ratio<2>>
+class BollingerBands {
+    static_assert(Period > 0, "Bollinger period must be positive");
+
+public:
+    static constexpr size_t kOutputs = 3;
+    static constexpr double kStdDev = static_cast<double>(StdDev::num) / StdDev::den;
+
+    void update(const OHLCV& data) { window_.push(data.close); }
+
+    double value() const { return middleBand(); }
+    double middleBand() const { return window_.mean(); }
+    double upperBand() const { return middleBand() + (kStdDev * std::sqrt(window_.variance())); }
+    double lowerBand() const { return middleBand() - (kStdDev * std::sqrt(window_.variance())); }
+
+    void write(double* out) const {
+        double middle = middleBand();
+        double width = kStdDev * std::sqrt(window_.variance());
+        out[0] = middle + width;
+        out[1] = middle;
+        out[2] = middle - width;
+    }
+
+private:
+    FixedRollingWindow<static_cast<size_t>(Period)> window_;
+};
+
+template <int Period>
+class ATR {
+    static_assert(Period > 0, "ATR period must be positive");
+
+public:
+    static constexpr size_t kOutputs = 1;
+
+    void update(const OHLCV& data) {
+        if (!hasPrevious_) {
+            previousClose_ = data.close;
+            hasPrevious_ = true;
+            return;
+        }
+        average_.push(trueRange(data.high, data.low, previousClose_));
+        previousClose_ = data.close;
+    }
+
+    double value() const { return average_.value; }
+    void write(double* out) const { out[0] = value(); }
+
+private:
+    double previousClose_{0.0};
+    bool hasPrevious_{false};
+    WilderAverage average_{Period};
+};
+
+} // namespace fixed
+
+namespace detail {
+
+template <typename T, typename... Ts>
+struct IndexOf;
+
+template <typename T, typename... Rest>
+struct IndexOf<T, T, Rest...> : std::integral_constant<size_t, 0> {};
+
+template <typename T, typename First, typename... Rest>
+struct IndexOf<T, First, Rest...> : std::integral_constant<size_t, 1 + IndexOf<T, Rest...>::value> {};
+
+template <typename T>
+struct IndexOf<T> {
+    static_assert(sizeof(T) == 0, "Indicator is not part of this IndicatorSet");
+};
+
+template <typename T, typename... Ts>
+constexpr size_t countOf() {
+    return (size_t{0} + ... + (std::is_same<T, Ts>::value ? 1 : 0));
+}
+
+} // namespace detail
+
+// A bundle of indicators whose parameters are compile-time constants, e.g.
+//
+//   IndicatorSet<fixed::SMA<20>, fixed::EMA<12>, fixed::RSI<14>> set;
+//   set.update(candle);
+//   double rsi = set.get<fixed::RSI<14>>().value();
+//
+// All state lives inline in one object, update() is a fold over the members
+// the compiler can inline and unroll, and get<>() / featureOffset<>() resolve
+// to indices at compile time. Use IndicatorManager when the indicator list is
+// only known at runtime.
+template <typename... Indicators>
+class IndicatorSet {
+    static_assert(sizeof...(Indicators) > 0, "IndicatorSet needs at least one indicator");
+    static_assert(((detail::countOf<Indicators, Indicators...>() == 1) && ...),
+                  "IndicatorSet lists an indicator more than once");
+
+public:
+    static constexpr size_t kIndicators = sizeof...(Indicators);
+    // Width of a fill() row: every indicator's outputs, in declaration order
+    static constexpr size_t kFeatures = (size_t{0} + ... + Indicators::kOutputs);
+
+    void update(const OHLCV& data) {
+        std::apply([&](auto&... indicator) { (indicator.update(data), ...); }, indicators_);
+    }
+
+    void update(const OHLCV* data, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            update(data[i]);
+        }
+    }
+
+    template <typename Indicator>
+    static constexpr size_t indexOf() {
+        return detail::IndexOf<Indicator, Indicators...>::value;
+    }
+
+    // Column of the indicator's first output within a fill() row
+    template <typename Indicator>
+    static constexpr size_t featureOffset() {
+        constexpr size_t index = indexOf<Indicator>();
+        constexpr size_t outputs[] = {Indicators::kOutputs...};
+        size_t offset = 0;
+        for (size_t i = 0; i < index; ++i) {
+            offset += outputs[i];
+        }
+        return offset;
+    }
+
+    template <typename Indicator>
+    Indicator& get() { return std::get<indexOf<Indicator>()>(indicators_); }
+
+    template <typename Indicator>
+    const Indicator& get() const { return std::get<indexOf<Indicator>()>(indicators_); }
+
+    template <size_t Index>
+    auto& get() { return std::get<Index>(indicators_); }
+
+    template <size_t Index>
+    const auto& get() const { return std::get<Index>(indicators_); }
+
+    template <typename Indicator>
+    double value() const { return get<Indicator>().value(); }
+
+    // Writes kFeatures values to out
+    void fill(double* out) const {
+        fillFrom(out, std::index_sequence_for<Indicators...>{});
+    }
+
+private:
+    using Storage = std::tuple<Indicators...>;
+
+    template <size_t... Index>
+    void fillFrom(double* out, std::index_sequence<Index...>) const {
+        (std::get<Index>(indicators_).write(out + featureOffset<std::tuple_element_t<Index, Storage>>()), ...);
+    }
+
+    Storage indicators_;
+};
+
+// The set IndicatorManager builds in initializeIndicators(). fill() yields
+// the indicator columns of FeatureSchema::standard() in the same order.
+using DefaultIndicatorSet = IndicatorSet<
+    fixed::RSI<14>,
+    fixed::MACD<12, 26, 9>,
+    fixed::BollingerBands<20>,
+    fixed::ATR<14>,
+    fixed::SMA<20>,
+    fixed::SMA<50>,
+    fixed::SMA<200>,
+    fixed::EMA<12>,
+    fixed::EMA<26>>;
+
+} // namespace novacrypt
@@ -5,88 +5,108 @@
 
 namespace novacrypt {
 
-// MovingAverage implementation
-MovingAverage::MovingAverage(int period) : period_(period) {}
+namespace {
 
-void MovingAverage::update(const OHLCV& data) {
-    values_.push_back(data.close);
-    if (values_.size() > period_) {
-        values_.erase(values_.begin());
-    }
+void saveAverage(StateWriter& out, const ExponentialAverage& average) {
+    out.put(average.value);
+    out.put(average.initialized);
 }
 
-double MovingAverage::getValue() const {
-    if (values_.empty()) return 0.0;
-    return std::accumulate(values_.begin(), values_.end(), 0.0) / values_.size();
+void loadAverage(StateReader& in, ExponentialAverage& average) {
+    average.value = in.get<double>();
+    average.initialized = in.get<bool>();
 }
 
+void saveAverage(StateWriter& out, const WilderAverage& average) {
+    out.put<int32_t>(average.period);
+    out.put<int32_t>(average.samples);
+    out.put(average.value);
+}
+
+void loadAverage(StateReader& in, WilderAverage& average) {
+    if (in.get<int32_t>() != average.period) {
+        throw std::runtime_error("Checkpointed average does not match the indicator period");
+    }
+    average.samples = in.get<int32_t>();
+    average.value = in.get<double>();
+}
+
+} // namespace
+
+// MovingAverage implementation
+MovingAverage::MovingAverage(int period) : period_(period) {}
+
 std::string MovingAverage::getName() const {
     return "MA";
 }
 
 // SMA implementation
-SMA::SMA(int period) : MovingAverage(period) {}
+SMA::SMA(int period) : MovingAverage(period), window_(period) {}
 
 void SMA::update(const OHLCV& data) {
-    MovingAverage::update(data);
+    window_.push(data.close);
+}
+
+double SMA::getValue() const {
+    return window_.mean();
 }
 
 std::string SMA::getName() const {
     return "SMA";
 }
 
+void SMA::saveState(StateWriter& out) const {
+    window_.saveState(out);
+}
+
+void SMA::loadState(StateReader& in) {
+    window_.loadState(in);
+}
+
 // EMA implementation
-EMA::EMA(int period) : MovingAverage(period), alpha_(2.0 / (period + 1)) {}
+EMA::EMA(int period) : MovingAverage(period), average_(period) {}
 
 void EMA::update(const OHLCV& data) {
-    if (values_.empty()) {
-        values_.push_back(data.close);
-    } else {
-        double ema = alpha_ * data.close + (1 - alpha_) * values_.back();
-        values_.push_back(ema);
-        if (values_.size() > period_) {
-            values_.erase(values_.begin());
-        }
-    }
+    average_.push(data.close);
+}
+
+double EMA::getValue() const {
+    return average_.value;
 }
 
 std::string EMA::getName() const {
     return "EMA";
 }
 
+void EMA::saveState(StateWriter& out) const {
+    saveAverage(out, average_);
+}
+
+void EMA::loadState(StateReader& in) {
+    loadAverage(in, average_);
+}
+
 // RSI implementation
-RSI::RSI(int period) : period_(period), avgGain_(0.0), avgLoss_(0.0) {}
+RSI::RSI(int period)
+    : period_(period), previousClose_(0.0), hasPrevious_(false),
+      avgGain_(period), avgLoss_(period) {}
 
 void RSI::update(const OHLCV& data) {
-    if (values_.empty()) {
-        values_.push_back(data.close);
+    if (!hasPrevious_) {
+        previousClose_ = data.close;
+        hasPrevious_ = true;
         return;
     }
 
-    double change = data.close - values_.back();
-    values_.push_back(data.close);
-
-    if (change >= 0) {
-        gains_.push_back(change);
-        losses_.push_back(0.0);
-    } else {
-        gains_.push_back(0.0);
-        losses_.push_back(-change);
-    }
-
-    if (gains_.size() > period_) {
-        gains_.erase(gains_.begin());
-        losses_.erase(losses_.begin());
-    }
-
-    // Calculate average gain and loss
-    avgGain_ = std::accumulate(gains_.begin(), gains_.end(), 0.0) / gains_.size();
-    avgLoss_ = std::accumulate(losses_.begin(), losses_.end(), 0.0) / losses_.size();
+    double change = data.close - previousClose_;
+    previousClose_ = data.close;
+    avgGain_.push(change >= 0 ? change : 0.0);
+    avgLoss_.push(change >= 0 ? 0.0 : -change);
 }
 
 double RSI::getValue() const {
-    if (avgLoss_ == 0.0) return 100.0;
-    double rs = avgGain_ / avgLoss_;
+    if (avgLoss_.value == 0.0) return 100.0;
+    double rs = avgGain_.value / avgLoss_.value;
     return 100.0 - (100.0 / (1.0 + rs));
 }
 
@@ -94,6 +114,20 @@ std::string RSI::getName() const {
     return "RSI";
 }
 
+void RSI::saveState(StateWriter& out) const {
+    out.put(previousClose_);
+    out.put(hasPrevious_);
+    saveAverage(out, avgGain_);
+    saveAverage(out, avgLoss_);
+}
+
+void RSI::loadState(StateReader& in) {
+    previousClose_ = in.get<double>();
+    hasPrevious_ = in.get<bool>();
+    loadAverage(in, avgGain_);
+    loadAverage(in, avgLoss_);
+}
+
 // MACD implementation
 MACD::MACD(int fastPeriod, int slowPeriod, int signalPeriod)
     : fastEMA_(fastPeriod), slowEMA_(slowPeriod), signalEMA_(signalPeriod),
@@ -102,14 +136,14 @@ MACD::MACD(int fastPeriod, int slowPeriod, int signalPeriod)
 void MACD::update(const OHLCV& data) {
     fastEMA_.update(data);
     slowEMA_.update(data);
-    
+
     macdLine_ = fastEMA_.getValue() - slowEMA_.getValue();
-    
+
     // Create a dummy OHLCV for signal line calculation
     OHLCV signalData = data;
     signalData.close = macdLine_;
     signalEMA_.update(signalData);
-    
+
     signalLine_ = signalEMA_.getValue();
 }
 
@@ -129,16 +163,28 @@ std::string MACD::getName() const {
     return "MACD";
 }
 
+void MACD::saveState(StateWriter& out) const {
+    fastEMA_.saveState(out);
+    slowEMA_.saveState(out);
+    signalEMA_.saveState(out);
+    out.put(macdLine_);
+    out.put(signalLine_);
+}
+
+void MACD::loadState(StateReader& in) {
+    fastEMA_.loadState(in);
+    slowEMA_.loadState(in);
+    signalEMA_.loadState(in);
+    macdLine_ = in.get<double>();
+    signalLine_ = in.get<double>();
+}
+
 // Bollinger Bands implementation
 BollingerBands::BollingerBands(int period, double stdDev)
-    : period_(period), stdDev_(stdDev), sma_(period) {}
+    : period_(period), stdDev_(stdDev), window_(period) {}
 
 void BollingerBands::update(const OHLCV& data) {
-    values_.push_back(data.close);
-    if (values_.size() > period_) {
-        values_.erase(values_.begin());
-    }
-    sma_.update(data);
+    window_.push(data.close);
 }
 
 double BollingerBands::getValue() const {
@@ -158,57 +204,58 @@ double BollingerBands::getLowerBand() const {
 }
 
 double BollingerBands::getMiddleBand() const {
-    return sma_.getValue();
+    return window_.mean();
 }
 
 double BollingerBands::calculateStandardDeviation() const {
-    if (values_.empty()) return 0.0;
-    
-    double mean = std::accumulate(values_.begin(), values_.end(), 0.0) / values_.size();
-    double variance = 0.0;
-    
-    for (double value : values_) {
-        variance += std::pow(value - mean, 2);
-    }
-    variance /= values_.size();
-    
-    return std::sqrt(variance);
+    return std::sqrt(window_.variance());
 }
 
 std::string BollingerBands::getName() const {
     return "BollingerBands";
 }
 
+void BollingerBands::saveState(StateWriter& out) const {
+    window_.saveState(out);
+}
+
+void BollingerBands::loadState(StateReader& in) {
+    window_.loadState(in);
+}
+
 // ATR implementation
-ATR::ATR(int period) : period_(period), currentATR_(0.0) {}
+ATR::ATR(int period)
+    : period_(period), previousClose_(0.0), hasPrevious_(false), currentATR_(period) {}
 
 void ATR::update(const OHLCV& data) {
-    if (values_.empty()) {
-        values_.push_back(data.close);
+    if (!hasPrevious_) {
+        previousClose_ = data.close;
+        hasPrevious_ = true;
         return;
     }
 
-    double high_low = data.high - data.low;
-    double high_close = std::abs(data.high - values_.back());
-    double low_close = std::abs(data.low - values_.back());
-    
-    double trueRange = std::max({high_low, high_close, low_close});
-    trueRanges_.push_back(trueRange);
-    
-    if (trueRanges_.size() > period_) {
-        trueRanges_.erase(trueRanges_.begin());
-    }
-    
-    currentATR_ = std::accumulate(trueRanges_.begin(), trueRanges_.end(), 0.0) / trueRanges_.size();
-    values_.push_back(data.close);
+    currentATR_.push(trueRange(data.high, data.low, previousClose_));
+    previousClose_ = data.close;
 }
 
 double ATR::getValue() const {
-    return currentATR_;
+    return currentATR_.value;
 }
 
 std::string ATR::getName() const {
     return "ATR";
 }
 
-} // namespace novacrypt 
\ No newline at end of file
+void ATR::saveState(StateWriter& out) const {
+    out.put(previousClose_);
+    out.put(hasPrevious_);
+    saveAverage(out, currentATR_);
+}
+
+void ATR::loadState(StateReader& in) {
+    previousClose_ = in.get<double>();
+    hasPrevious_ = in.get<bool>();
+    loadAverage(in, currentATR_);
+}
+
+} // namespace novacrypt
@@ -2,6 +2,9 @@
 #include <vector>
 #include <string>
 #include <chrono>
+#include <cstdint>
+#include "RollingWindow.h"
+#include "IndicatorKernels.h"
 
 namespace novacrypt {
 
@@ -14,6 +17,25 @@ struct OHLCV {
     std::chrono::system_clock::time_point timestamp;
 };
 
+// Read-only columnar (SoA) view over a candle series. The columns are owned
+// elsewhere, e.g. by a CandleStore or a memory-mapped candle file.
+struct CandleColumns {
+    const int64_t* timestamp{nullptr};  // nanoseconds since the Unix epoch
+    const double* open{nullptr};
+    const double* high{nullptr};
+    const double* low{nullptr};
+    const double* close{nullptr};
+    const double* volume{nullptr};
+    size_t size{0};
+    
+    OHLCV at(size_t index) const {
+        return OHLCV{open[index], high[index], low[index], close[index], volume[index],
+                     std::chrono::system_clock::time_point(
+                         std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                             std::chrono::nanoseconds(timestamp[index])))};
+    }
+};
+
 struct OrderBookLevel {
     double price;
     double quantity;
@@ -31,52 +53,64 @@ public:
     virtual void update(const OHLCV& data) = 0;
     virtual double getValue() const = 0;
     virtual std::string getName() const = 0;
+    // Checkpoint support: the full internal state, restored into an
+    // indicator constructed with the same parameters
+    virtual void saveState(StateWriter& out) const = 0;
+    virtual void loadState(StateReader& in) = 0;
 };
 
 // Moving Averages
 class MovingAverage : public Indicator {
 public:
     MovingAverage(int period);
-    void update(const OHLCV& data) override;
-    double getValue() const override;
     std::string getName() const override;
 
 protected:
     int period_;
-    std::vector<double> values_;
 };
 
 class SMA : public MovingAverage {
 public:
     SMA(int period);
     void update(const OHLCV& data) override;
+    double getValue() const override;
     std::string getName() const override;
+    void saveState(StateWriter& out) const override;
+    void loadState(StateReader& in) override;
+
+private:
+    RollingWindow window_;
 };
 
 class EMA : public MovingAverage {
 public:
     EMA(int period);
     void update(const OHLCV& data) override;
+    double getValue() const override;
     std::string getName() const override;
+    void saveState(StateWriter& out) const override;
+    void loadState(StateReader& in) override;
 
 private:
-    double alpha_;  // Smoothing factor
+    ExponentialAverage average_;
 };
 
-// RSI
+// RSI with Wilder smoothing of average gain and loss
 class RSI : public Indicator {
 public:
     RSI(int period);
     void update(const OHLCV& data) override;
     double getValue() const override;
     std::string getName() const override;
+    void saveState(StateWriter& out) const override;
+    void loadState(StateReader& in) override;
 
 private:
     int period_;
-    std::vector<double> gains_;
-    std::vector<double> losses_;
-    double avgGain_;
-    double avgLoss_;
+    double previousClose_;
+    bool hasPrevious_;
+    WilderAverage avgGain_;
+    WilderAverage avgLoss_;
 };
 
 // MACD
@@ -86,6 +120,8 @@ public:
     void update(const OHLCV& data) override;
     double getValue() const override;
     std::string getName() const override;
+    void saveState(StateWriter& out) const override;
+    void loadState(StateReader& in) override;
     double getSignal() const;
     double getHistogram() const;
 
@@ -104,6 +140,8 @@ public:
     void update(const OHLCV& data) override;
     double getValue() const override;
     std::string getName() const override;
+    void saveState(StateWriter& out) const override;
+    void loadState(StateReader& in) override;
     double getUpperBand() const;
     double getLowerBand() const;
     double getMiddleBand() const;
@@ -111,22 +149,26 @@ public:
 private:
     int period_;
     double stdDev_;
-    SMA sma_;
-    std::vector<double> values_;
+    RollingWindow window_;
+    
+    double calculateStandardDeviation() const;
 };
 
-// ATR
+// ATR with Wilder smoothing of the true range
 class ATR : public Indicator {
 public:
     ATR(int period);
     void update(const OHLCV& data) override;
     double getValue() const override;
     std::string getName() const override;
+    void saveState(StateWriter& out) const override;
+    void loadState(StateReader& in) override;
 
 private:
     int period_;
-    std::vector<double> trueRanges_;
-    double currentATR_;
+    double previousClose_;
+    bool hasPrevious_;
+    WilderAverage currentATR_;
 };
 
 } // namespace novacrypt 
\ No newline at end of file
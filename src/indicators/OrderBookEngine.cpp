@@ -0,0 +1,204 @@
+#include "OrderBookEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace novacrypt {
+
+void OrderBookEngine::clear() {
+    bids_ = Side{};
+    asks_ = Side{};
+}
+
+bool OrderBookEngine::applySnapshot(const OrderBook& book) {
+    return applySnapshot(book.bids, book.asks);
+}
+
+bool OrderBookEngine::applyDelta(BookSide bookSide, double price, double quantity) {
+    if (!(price > 0.0) || !(quantity >= 0.0) || !std::isfinite(price) || !std::isfinite(quantity)) {
+        return false;
+    }
+    
+    Side& target = side(bookSide);
+    auto& levels = target.levels;
+    
+    // levels run worst to best, so "better" is the sort order
+    auto it = std::lower_bound(levels.begin(), levels.end(), price,
+        [bookSide](const OrderBookLevel& level, double value) {
+            return isBetter(bookSide, value, level.price);
+        });
+    bool exists = it != levels.end() && it->price == price;
+    
+    if (quantity == 0.0) {
+        if (exists) {
+            target.depth -= it->quantity;
+            target.notional -= it->quantity * it->price;
+            levels.erase(it);
+            if (levels.empty()) {
+                target.depth = 0.0;
+                target.notional = 0.0;
+            }
+        }
+        return true;
+    }
+    
+    // A resting level must not cross the other side's best price
+    const Side& opposite = side(bookSide == BookSide::Bid ? BookSide::Ask : BookSide::Bid);
+    if (!opposite.levels.empty()) {
+        double oppositeBest = opposite.levels.back().price;
+        if (bookSide == BookSide::Bid ? price >= oppositeBest : price <= oppositeBest) {
+            return false;
+        }
+    }
+    
+    if (exists) {
+        target.depth += quantity - it->quantity;
+        target.notional += (quantity - it->quantity) * price;
+        it->quantity = quantity;
+    } else {
+        levels.insert(it, OrderBookLevel{price, quantity});
+        target.depth += quantity;
+        target.notional += quantity * price;
+    }
+    return true;
+}
+
+bool OrderBookEngine::empty() const {
+    return bids_.levels.empty() && asks_.levels.empty();
+}
+
+bool OrderBookEngine::hasBothSides() const {
+    return !bids_.levels.empty() && !asks_.levels.empty();
+}
+
+size_t OrderBookEngine::levelCount(BookSide bookSide) const {
+    return side(bookSide).levels.size();
+}
+
+const OrderBookLevel& OrderBookEngine::level(BookSide bookSide, size_t depth) const {
+    const auto& levels = side(bookSide).levels;
+    return levels[levels.size() - 1 - depth];
+}
+
+double OrderBookEngine::bestBid() const {
+    return bids_.levels.empty() ? 0.0 : bids_.levels.back().price;
+}
+
+double OrderBookEngine::bestAsk() const {
+    return asks_.levels.empty() ? 0.0 : asks_.levels.back().price;
+}
+
+double OrderBookEngine::spread() const {
+    if (!hasBothSides()) return 0.0;
+    return bestAsk() - bestBid();
+}
+
+double OrderBookEngine::midPrice() const {
+    if (!hasBothSides()) return 0.0;
+    return (bestBid() + bestAsk()) / 2.0;
+}
+
+double OrderBookEngine::depth(BookSide bookSide) const {
+    return side(bookSide).depth;
+}
+
+double OrderBookEngine::depthWeightedPrice(BookSide bookSide) const {
+    const Side& target = side(bookSide);
+    if (target.depth <= 0.0) return 0.0;
+    return target.notional / target.depth;
+}
+
+double OrderBookEngine::imbalance() const {
+    if (!hasBothSides()) return 0.0;
+    double total = bids_.depth + asks_.depth;
+    if (total <= 0.0) return 0.0;
+    return (bids_.depth - asks_.depth) / total;
+}
+
+double OrderBookEngine::slippageEstimate(double quantity) const {
+    if (!hasBothSides() || !(quantity > 0.0)) return 0.0;
+    // (buy - mid) and (mid - sell) averaged; the mid cancels out
+    return (averageFillPrice(BookSide::Ask, quantity) - averageFillPrice(BookSide::Bid, quantity)) / 2.0;
+}
+
+double OrderBookEngine::slippageEstimate() const {
+    return slippageEstimate(slippageReferenceSize_);
+}
+
+void OrderBookEngine::setSlippageReferenceSize(double quantity) {
+    if (!(quantity > 0.0) || !std::isfinite(quantity)) {
+        throw std::invalid_argument("Slippage reference size must be positive");
+    }
+    slippageReferenceSize_ = quantity;
+}
+
+double OrderBookEngine::getSlippageReferenceSize() const {
+    return slippageReferenceSize_;
+}
+
+double OrderBookEngine::averageFillPrice(BookSide bookSide, double quantity) const {
+    const auto& levels = side(bookSide).levels;
+    double remaining = quantity;
+    double notional = 0.0;
+    for (auto it = levels.rbegin(); it != levels.rend() && remaining > 0.0; ++it) {
+        double filled = std::min(remaining, it->quantity);
+        notional += filled * it->price;
+        remaining -= filled;
+    }
+    if (remaining > 0.0) {
+        notional += remaining * levels.front().price;
+    }
+    return notional / quantity;
+}
+
+OrderBook OrderBookEngine::toOrderBook() const {
+    OrderBook book;
+    book.bids.assign(bids_.levels.rbegin(), bids_.levels.rend());
+    book.asks.assign(asks_.levels.rbegin(), asks_.levels.rend());
+    return book;
+}
+
+OrderBookEngine::Side& OrderBookEngine::side(BookSide bookSide) {
+    return bookSide == BookSide::Bid ? bids_ : asks_;
+}
+
+const OrderBookEngine::Side& OrderBookEngine::side(BookSide bookSide) const {
+    return bookSide == BookSide::Bid ? bids_ : asks_;
+}
+
+bool OrderBookEngine::isBetter(BookSide bookSide, double price, double than) {
+    return bookSide == BookSide::Bid ? price > than : price < than;
+}
+
+void OrderBookEngine::recomputeTotals(Side& target) {
+    target.depth = 0.0;
+    target.notional = 0.0;
+    for (const auto& level : target.levels) {
+        target.depth += level.quantity;
+        target.notional += level.quantity * level.price;
+    }
+}
+
+bool OrderBookEngine::finishSnapshot() {
+    auto valid = [](BookSide bookSide, const std::vector<OrderBookLevel>& levels) {
+        for (size_t i = 0; i < levels.size(); ++i) {
+            if (!(levels[i].price > 0.0) || !(levels[i].quantity > 0.0)) {
+                return false;
+            }
+            if (i > 0 && !isBetter(bookSide, levels[i].price, levels[i - 1].price)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    bool crossed = hasBothSides() && bestBid() >= bestAsk();
+    if (crossed || !valid(BookSide::Bid, bids_.levels) || !valid(BookSide::Ask, asks_.levels)) {
+        clear();
+        return false;
+    }
+    recomputeTotals(bids_);
+    recomputeTotals(asks_);
+    return true;
+}
+
+} // namespace novacrypt
@@ -0,0 +1,142 @@
+#pragma once
+#include "MarketData.h"
+#include <cstddef>
+#include <vector>
+
+namespace novacrypt {
+
+enum class BookSide {
+    Bid,
+    Ask
+};
+
+// Quantity accessor used by OrderBookEngine::applySnapshot; overload it for
+// other level types (found by argument-dependent lookup)
+inline double levelQuantity(const OrderBookLevel& level) {
+    return level.quantity;
+}
+
+// Incremental L2 book. Each side is a flat price-sorted array with the best
+// level at the back, so the frequent top-of-book changes shift almost
+// nothing. Running depth and notional totals make spread and imbalance O(1)
+// to read; the slippage estimate walks only the levels a reference-size
+// order would consume.
+class OrderBookEngine {
+public:
+    OrderBookEngine() = default;
+    
+    void clear();
+    
+    // Replace the whole book. Levels are given best first; returns false and
+    // leaves the book empty if either side is unsorted, has a non-positive
+    // price or quantity, or the result is crossed.
+    bool applySnapshot(const OrderBook& book);
+    template<typename Levels>
+    bool applySnapshot(const Levels& bids, const Levels& asks);
+    
+    // Insert, modify (quantity > 0) or delete (quantity == 0) one level.
+    // Only the changed level is validated: it must have a positive price,
+    // a non-negative quantity and must not cross the opposite best price.
+    bool applyDelta(BookSide side, double price, double quantity);
+    // Apply one delta message as a unit: every deletion on both sides
+    // first, then the inserts and modifications. A message that lifts the
+    // best ask and raises the bid into its old price is therefore checked
+    // against the book it leaves behind, not the one it replaces. Returns
+    // false if any level was rejected; the rest are still applied.
+    template<typename Levels>
+    bool applyDeltas(const Levels& bids, const Levels& asks);
+    
+    bool empty() const;
+    bool hasBothSides() const;
+    size_t levelCount(BookSide side) const;
+    // depth 0 is the best level
+    const OrderBookLevel& level(BookSide side, size_t depth) const;
+    
+    double bestBid() const;
+    double bestAsk() const;
+    double spread() const;
+    double midPrice() const;
+    double depth(BookSide side) const;
+    // Quantity-weighted average price of all resting levels on one side
+    double depthWeightedPrice(BookSide side) const;
+    // (bid depth - ask depth) / (bid depth + ask depth)
+    double imbalance() const;
+    // Expected cost per unit, relative to the mid price, of a market order
+    // of the given size, averaged over buying (walking the asks) and
+    // selling (walking the bids). Whatever a side is too thin to fill is
+    // priced at its worst level. 0 unless both sides are present.
+    double slippageEstimate(double quantity) const;
+    // The same for the reference size
+    double slippageEstimate() const;
+    // Order size slippageEstimate() is quoted for; defaults to one unit
+    void setSlippageReferenceSize(double quantity);
+    double getSlippageReferenceSize() const;
+    
+    // Copy out the book best first, e.g. for display
+    OrderBook toOrderBook() const;
+
+private:
+    struct Side {
+        std::vector<OrderBookLevel> levels;  // worst first, best at the back
+        double depth{0.0};
+        double notional{0.0};
+    };
+    
+    Side& side(BookSide side);
+    const Side& side(BookSide side) const;
+    // Bids improve upwards, asks downwards
+    static bool isBetter(BookSide side, double price, double than);
+    void recomputeTotals(Side& side);
+    bool finishSnapshot();
+    // Average fill price of a market order of quantity against one side
+    double averageFillPrice(BookSide side, double quantity) const;
+    
+    Side bids_;
+    Side asks_;
+    double slippageReferenceSize_{1.0};
+};
+
+template<typename Levels>
+bool OrderBookEngine::applySnapshot(const Levels& bids, const Levels& asks) {
+    bids_.levels.clear();
+    asks_.levels.clear();
+    for (auto it = bids.end(); it != bids.begin();) {
+        --it;
+        bids_.levels.push_back(OrderBookLevel{it->price, levelQuantity(*it)});
+    }
+    for (auto it = asks.end(); it != asks.begin();) {
+        --it;
+        asks_.levels.push_back(OrderBookLevel{it->price, levelQuantity(*it)});
+    }
+    return finishSnapshot();
+}
+
+template<typename Levels>
+bool OrderBookEngine::applyDeltas(const Levels& bids, const Levels& asks) {
+    bool applied = true;
+    // !(quantity > 0) also routes NaN and negative quantities to applyDelta,
+    // which rejects them
+    for (const auto& level : bids) {
+        if (!(levelQuantity(level) > 0.0)) {
+            applied &= applyDelta(BookSide::Bid, level.price, levelQuantity(level));
+        }
+    }
+    for (const auto& level : asks) {
+        if (!(levelQuantity(level) > 0.0)) {
+            applied &= applyDelta(BookSide::Ask, level.price, levelQuantity(level));
+        }
+    }
+    for (const auto& level : bids) {
+        if (levelQuantity(level) > 0.0) {
+            applied &= applyDelta(BookSide::Bid, level.price, levelQuantity(level));
+        }
+    }
+    for (const auto& level : asks) {
+        if (levelQuantity(level) > 0.0) {
+            applied &= applyDelta(BookSide::Ask, level.price, levelQuantity(level));
+        }
+    }
+    return applied;
+}
+
+} // namespace novacrypt
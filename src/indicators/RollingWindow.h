@@ -0,0 +1,203 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include "../common/StateStream.h"
+
+namespace novacrypt {
+
+// Full passes over a window between exact recomputations of its running
+// moments. Adding and subtracting on every push lets rounding error build
+// up over long streams; recomputing from the ring bounds it at O(p) extra
+// work per 64 * p pushes.
+constexpr size_t kWindowResyncWraps = 64;
+
+// Running sum plus Welford's mean/M2 pair for a window of values. The update
+// order here is the reference used by the batch kernels, which must
+// reproduce it bit for bit.
+struct WindowMoments {
+    double sum{0.0};
+    double mean{0.0};  // Welford mean, only used for the variance update
+    double m2{0.0};    // Welford sum of squared deviations
+
+    // count includes the new value
+    void add(double value, size_t count) {
+        sum += value;
+        double delta = value - mean;
+        mean += delta / count;
+        m2 += delta * (value - mean);
+        clamp();
+    }
+
+    void replace(double evicted, double value, size_t count) {
+        double change = value - evicted;
+        sum += change;
+        double oldMean = mean;
+        mean += change / count;
+        m2 += change * (value - mean + evicted - oldMean);
+        clamp();
+    }
+
+    // Rebuild from the window's values, oldest first
+    void recompute(const double* values, size_t count) {
+        *this = WindowMoments{};
+        for (size_t i = 0; i < count; ++i) {
+            add(values[i], i + 1);
+        }
+    }
+
+    // Guard against rounding pushing a constant window's M2 below zero
+    void clamp() {
+        if (m2 < 0.0) {
+            m2 = 0.0;
+        }
+    }
+};
+
+// Fixed-capacity ring buffer over the most recent values of a series.
+// Keeps WindowMoments for the window mean and variance, so push() and every
+// statistic are O(1) amortized and allocation-free once the window has been
+// constructed. Every kWindowResyncWraps passes the moments are recomputed
+// from the ring, so long streams do not drift.
+class RollingWindow {
+public:
+    explicit RollingWindow(size_t capacity)
+        : buffer_(capacity, 0.0), capacity_(capacity), head_(0), count_(0), wraps_(0)
+    {
+        if (capacity_ == 0) {
+            throw std::invalid_argument("RollingWindow capacity must be positive");
+        }
+    }
+
+    // Append a value, evicting the oldest one once the window is full
+    void push(double value) {
+        if (count_ < capacity_) {
+            buffer_[count_] = value;
+            ++count_;
+            moments_.add(value, count_);
+        } else {
+            double evicted = buffer_[head_];
+            buffer_[head_] = value;
+            moments_.replace(evicted, value, count_);
+            if (++head_ == capacity_) {
+                head_ = 0;
+                if (++wraps_ == kWindowResyncWraps) {
+                    // The ring is in oldest-first order right after a wrap
+                    wraps_ = 0;
+                    moments_.recompute(buffer_.data(), count_);
+                }
+            }
+        }
+    }
+
+    double mean() const { return count_ == 0 ? 0.0 : moments_.sum / count_; }
+    double variance() const { return count_ == 0 ? 0.0 : moments_.m2 / count_; }
+    double sum() const { return moments_.sum; }
+
+    // Most recently pushed value
+    double back() const {
+        if (count_ == 0) return 0.0;
+        size_t last = count_ < capacity_ ? count_ - 1 : (head_ + capacity_ - 1) % capacity_;
+        return buffer_[last];
+    }
+
+    size_t size() const { return count_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return count_ == 0; }
+    bool full() const { return count_ == capacity_; }
+
+    // Checkpoint the exact ring and moments, so a restored window continues
+    // bit for bit. Loading requires a window of the same capacity.
+    void saveState(StateWriter& out) const {
+        out.put<uint64_t>(capacity_);
+        out.put<uint64_t>(head_);
+        out.put<uint64_t>(count_);
+        out.put<uint64_t>(wraps_);
+        out.put(moments_);
+        for (size_t i = 0; i < count_; ++i) {
+            out.put(buffer_[i]);
+        }
+    }
+
+    void loadState(StateReader& in) {
+        if (in.get<uint64_t>() != capacity_) {
+            throw std::runtime_error("Checkpointed window does not match the indicator period");
+        }
+        size_t head = static_cast<size_t>(in.get<uint64_t>());
+        size_t count = static_cast<size_t>(in.get<uint64_t>());
+        size_t wraps = static_cast<size_t>(in.get<uint64_t>());
+        if (count > capacity_ || head >= capacity_ || wraps >= kWindowResyncWraps) {
+            throw std::runtime_error("Corrupt checkpointed window");
+        }
+        moments_ = in.get<WindowMoments>();
+        std::fill(buffer_.begin(), buffer_.end(), 0.0);
+        for (size_t i = 0; i < count; ++i) {
+            buffer_[i] = in.get<double>();
+        }
+        head_ = head;
+        count_ = count;
+        wraps_ = wraps;
+    }
+
+private:
+    std::vector<double> buffer_;
+    size_t capacity_;
+    size_t head_;    // oldest element once the window is full
+    size_t count_;
+    size_t wraps_;   // completed passes since the last recompute
+    WindowMoments moments_;
+};
+
+// RollingWindow with the capacity fixed at compile time and the values held
+// inline, so it can live inside a larger object without its own allocation.
+// Produces exactly the same statistics as RollingWindow(Capacity).
+template <size_t Capacity>
+class FixedRollingWindow {
+    static_assert(Capacity > 0, "FixedRollingWindow capacity must be positive");
+
+public:
+    void push(double value) {
+        if (count_ < Capacity) {
+            buffer_[count_] = value;
+            ++count_;
+            moments_.add(value, count_);
+        } else {
+            double evicted = buffer_[head_];
+            buffer_[head_] = value;
+            moments_.replace(evicted, value, count_);
+            if (++head_ == Capacity) {
+                head_ = 0;
+                if (++wraps_ == kWindowResyncWraps) {
+                    wraps_ = 0;
+                    moments_.recompute(buffer_.data(), count_);
+                }
+            }
+        }
+    }
+
+    double mean() const { return count_ == 0 ? 0.0 : moments_.sum / count_; }
+    double variance() const { return count_ == 0 ? 0.0 : moments_.m2 / count_; }
+    double sum() const { return moments_.sum; }
+
+    double back() const {
+        if (count_ == 0) return 0.0;
+        size_t last = count_ < Capacity ? count_ - 1 : (head_ + Capacity - 1) % Capacity;
+        return buffer_[last];
+    }
+
+    size_t size() const { return count_; }
+    static constexpr size_t capacity() { return Capacity; }
+    bool empty() const { return count_ == 0; }
+    bool full() const { return count_ == Capacity; }
+
+private:
+    std::array<double, Capacity> buffer_{};
+    size_t head_{0};
+    size_t count_{0};
+    size_t wraps_{0};
+    WindowMoments moments_;
+};
+
+} // namespace novacrypt
@@ -1,149 +1,349 @@
 #include "SentimentAnalyzer.h"
+#include "../data/Tracing.h"
 #include <algorithm>
+#include <atomic>
+#include <iterator>
 #include <numeric>
 #include <chrono>
+#include <cmath>
+#include <stdexcept>
 
 namespace novacrypt {
 
-SentimentAnalyzer::SentimentAnalyzer() {}
+const char* toString(SentimentSource source) {
+    switch (source) {
+        case SentimentSource::Twitter: return "Twitter";
+        case SentimentSource::Reddit: return "Reddit";
+        case SentimentSource::News: return "News";
+    }
+    return "Unknown";
+}
+
+SentimentAnalyzer::SentimentAnalyzer(SentimentOptions options) : options_(options) {
+    if (options_.historyCapacity == 0) {
+        throw std::invalid_argument("Sentiment history capacity must be positive");
+    }
+    if (options_.decayTime.count() <= 0) {
+        throw std::invalid_argument("Sentiment decay time must be positive");
+    }
+    for (auto& state : sources_) {
+        state.ring.resize(options_.historyCapacity);
+    }
+}
+
+size_t SentimentAnalyzer::ingest(SentimentSource source, SentimentSpan items) {
+    NOVACRYPT_TRACE_SCOPE("sentiment.ingest");
+    auto& buffer = producerBuffer();
+    size_t accepted = 0;
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        for (const auto& item : items) {
+            if (!isValid(item)) continue;
+            if (buffer.size == buffer.items.size()) {
+                buffer.items.emplace_back();
+            }
+            // Assign into a recycled entry so its string keeps its capacity
+            auto& pending = buffer.items[buffer.size++];
+            pending.source = source;
+            pending.item.score = item.score;
+            pending.item.confidence = item.confidence;
+            pending.item.timestamp = item.timestamp;
+            if (options_.keepText) {
+                pending.item.text.assign(item.text);
+            } else {
+                pending.item.text.clear();
+            }
+            ++accepted;
+        }
+        full = buffer.size >= kMergeThreshold;
+    }
+    if (full) {
+        flush();
+    }
+    return accepted;
+}
+
+void SentimentAnalyzer::flush() {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    mergeLocked();
+}
+
+bool SentimentAnalyzer::isValid(const ScoredSentiment& item) {
+    return std::isfinite(item.score) && std::isfinite(item.confidence) &&
+           item.score >= -1.0 && item.score <= 1.0 &&
+           item.confidence >= 0.0 && item.confidence <= 1.0;
+}
 
 void SentimentAnalyzer::updateTwitterSentiment(const std::string& text, double score, double confidence) {
-    SentimentData data{
-        score,
-        confidence,
-        "Twitter",
-        std::chrono::system_clock::now(),
-        text
-    };
-    twitterData_.push_back(data);
+    update(SentimentSource::Twitter, text, score, confidence);
 }
 
 void SentimentAnalyzer::updateRedditSentiment(const std::string& text, double score, double confidence) {
-    SentimentData data{
-        score,
-        confidence,
-        "Reddit",
-        std::chrono::system_clock::now(),
-        text
-    };
-    redditData_.push_back(data);
+    update(SentimentSource::Reddit, text, score, confidence);
 }
 
 void SentimentAnalyzer::updateNewsSentiment(const std::string& text, double score, double confidence) {
-    SentimentData data{
-        score,
-        confidence,
-        "News",
-        std::chrono::system_clock::now(),
-        text
-    };
-    newsData_.push_back(data);
+    update(SentimentSource::News, text, score, confidence);
 }
 
+template <typename Visitor>
+void SentimentAnalyzer::visitRecentLocked(size_t count, Visitor&& visit) const {
+    // Each ring is newest-first when read backwards, so merging their heads
+    // yields the overall newest items without touching the rest
+    std::array<size_t, kSourceCount> taken{};
+    for (size_t visited = 0; visited < count; ++visited) {
+        const SentimentData* newest = nullptr;
+        size_t newestSource = 0;
+        for (size_t s = 0; s < kSourceCount; ++s) {
+            const auto& state = sources_[s];
+            if (taken[s] == state.count) continue;
+            const auto& candidate = state.recent(taken[s]);
+            if (!newest || candidate.timestamp > newest->timestamp) {
+                newest = &candidate;
+                newestSource = s;
+            }
+        }
+        if (!newest) break;
+        visit(*newest);
+        ++taken[newestSource];
+    }
+}
+
+namespace {
+
+// Weight the different sources (can be adjusted based on reliability)
+constexpr double kTwitterWeight = 0.3;
+constexpr double kRedditWeight = 0.3;
+constexpr double kNewsWeight = 0.4;
+
+} // namespace
+
 double SentimentAnalyzer::getAggregateSentiment() const {
-    double twitterSentiment = getTwitterSentiment();
-    double redditSentiment = getRedditSentiment();
-    double newsSentiment = getNewsSentiment();
-    
-    // Weight the different sources (can be adjusted based on reliability)
-    const double twitterWeight = 0.3;
-    const double redditWeight = 0.3;
-    const double newsWeight = 0.4;
-    
-    return (twitterSentiment * twitterWeight +
-            redditSentiment * redditWeight +
-            newsSentiment * newsWeight);
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    mergeLocked();
+    return sentimentLocked(SentimentSource::Twitter) * kTwitterWeight +
+           sentimentLocked(SentimentSource::Reddit) * kRedditWeight +
+           sentimentLocked(SentimentSource::News) * kNewsWeight;
 }
 
 double SentimentAnalyzer::getTwitterSentiment() const {
-    return calculateWeightedSentiment(twitterData_);
+    return getSentiment(SentimentSource::Twitter);
 }
 
 double SentimentAnalyzer::getRedditSentiment() const {
-    return calculateWeightedSentiment(redditData_);
+    return getSentiment(SentimentSource::Reddit);
 }
 
 double SentimentAnalyzer::getNewsSentiment() const {
-    return calculateWeightedSentiment(newsData_);
+    return getSentiment(SentimentSource::News);
+}
+
+double SentimentAnalyzer::getSentiment(SentimentSource source) const {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    mergeLocked();
+    return sentimentLocked(source);
 }
 
 std::vector<double> SentimentAnalyzer::getSentimentFeatures() const {
-    std::vector<double> features;
-    
-    // Add individual source sentiments
-    features.push_back(getTwitterSentiment());
-    features.push_back(getRedditSentiment());
-    features.push_back(getNewsSentiment());
-    
-    // Add aggregate sentiment
-    features.push_back(getAggregateSentiment());
-    
-    // Add sentiment momentum (change over time)
-    auto recentSentiments = getRecentSentiments(20);
-    if (recentSentiments.size() >= 2) {
-        double momentum = recentSentiments.back().score - recentSentiments.front().score;
-        features.push_back(momentum);
-    } else {
-        features.push_back(0.0);
-    }
-    
-    return features;
+    auto snapshot = getSnapshot();
+    return {snapshot.twitter, snapshot.reddit, snapshot.news, snapshot.aggregate, snapshot.momentum};
+}
+
+SentimentSnapshot SentimentAnalyzer::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    mergeLocked();
+    SentimentSnapshot snapshot;
+    snapshot.twitter = sentimentLocked(SentimentSource::Twitter);
+    snapshot.reddit = sentimentLocked(SentimentSource::Reddit);
+    snapshot.news = sentimentLocked(SentimentSource::News);
+    snapshot.aggregate = snapshot.twitter * kTwitterWeight +
+                         snapshot.reddit * kRedditWeight +
+                         snapshot.news * kNewsWeight;
+
+    // Sentiment momentum (change over time)
+    size_t seen = 0;
+    double newest = 0.0;
+    double oldest = 0.0;
+    visitRecentLocked(kMomentumWindow, [&](const SentimentData& item) {
+        if (seen++ == 0) {
+            newest = item.score;
+        }
+        oldest = item.score;
+    });
+    snapshot.momentum = seen >= 2 ? oldest - newest : 0.0;
+    return snapshot;
 }
 
 std::vector<SentimentData> SentimentAnalyzer::getRecentSentiments(int count) const {
-    std::vector<SentimentData> allData;
-    allData.insert(allData.end(), twitterData_.begin(), twitterData_.end());
-    allData.insert(allData.end(), redditData_.begin(), redditData_.end());
-    allData.insert(allData.end(), newsData_.begin(), newsData_.end());
-    
-    // Sort by timestamp (newest first)
-    std::sort(allData.begin(), allData.end(),
-              [](const SentimentData& a, const SentimentData& b) {
-                  return a.timestamp > b.timestamp;
-              });
-    
-    // Return the most recent 'count' items
-    if (allData.size() > count) {
-        allData.resize(count);
-    }
-    
-    return allData;
+    std::vector<SentimentData> recent;
+    if (count <= 0) {
+        return recent;
+    }
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    mergeLocked();
+    size_t wanted = static_cast<size_t>(count);
+    recent.reserve(std::min(wanted, kSourceCount * options_.historyCapacity));
+    visitRecentLocked(wanted, [&](const SentimentData& item) { recent.push_back(item); });
+    return recent;
 }
 
 void SentimentAnalyzer::clearOldData(std::chrono::hours maxAge) {
-    removeOldData(twitterData_, maxAge);
-    removeOldData(redditData_, maxAge);
-    removeOldData(newsData_, maxAge);
-}
-
-double SentimentAnalyzer::calculateWeightedSentiment(const std::vector<SentimentData>& data) const {
-    if (data.empty()) return 0.0;
-    
-    double totalWeight = 0.0;
-    double weightedSum = 0.0;
-    
-    for (const auto& item : data) {
-        // Weight by confidence and recency
-        auto age = std::chrono::system_clock::now() - item.timestamp;
-        double timeWeight = std::exp(-std::chrono::duration<double>(age).count() / 3600.0); // 1-hour decay
-        double weight = item.confidence * timeWeight;
-        
-        weightedSum += item.score * weight;
-        totalWeight += weight;
-    }
-    
-    return totalWeight > 0.0 ? weightedSum / totalWeight : 0.0;
-}
-
-void SentimentAnalyzer::removeOldData(std::vector<SentimentData>& data, std::chrono::hours maxAge) {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    mergeLocked();
     auto now = std::chrono::system_clock::now();
-    data.erase(
-        std::remove_if(data.begin(), data.end(),
-                      [&](const SentimentData& item) {
-                          return (now - item.timestamp) > maxAge;
-                      }),
-        data.end()
-    );
+    for (auto& state : sources_) {
+        // Items are held oldest to newest, so trim from the oldest end
+        while (state.count > 0 && now - state.recent(state.count - 1).timestamp > maxAge) {
+            auto& oldest = state.ring[(state.next + state.ring.size() - state.count) % state.ring.size()];
+            oldest.text.clear();
+            --state.count;
+        }
+        if (state.count == 0 && now - state.reference > maxAge) {
+            state.weightedScore = 0.0;
+            state.totalWeight = 0.0;
+        }
+    }
+}
+
+const SentimentOptions& SentimentAnalyzer::getOptions() const {
+    return options_;
+}
+
+void SentimentAnalyzer::saveState(StateWriter& out) const {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    mergeLocked();
+    out.put<uint32_t>(static_cast<uint32_t>(kSourceCount));
+    for (const auto& state : sources_) {
+        out.put(state.weightedScore);
+        out.put(state.totalWeight);
+        out.putTime(state.reference);
+        out.put<uint64_t>(state.count);
+        for (size_t i = state.count; i-- > 0;) {
+            const auto& item = state.recent(i);
+            out.put(item.score);
+            out.put(item.confidence);
+            out.putTime(item.timestamp);
+            out.putString(item.text);
+        }
+    }
+}
+
+void SentimentAnalyzer::loadState(StateReader& in) {
+    std::lock_guard<std::mutex> lock(stateMutex_);
+    mergeLocked();
+    if (in.get<uint32_t>() != kSourceCount) {
+        throw std::runtime_error("Checkpointed sentiment has a different set of sources");
+    }
+    for (size_t source = 0; source < kSourceCount; ++source) {
+        auto& state = sources_[source];
+        state.weightedScore = in.get<double>();
+        state.totalWeight = in.get<double>();
+        state.reference = in.getTime();
+        uint64_t count = in.get<uint64_t>();
+        state.next = 0;
+        state.count = 0;
+        // Oldest first; once the ring is full the newest overwrite the oldest
+        for (uint64_t i = 0; i < count; ++i) {
+            auto& slot = state.ring[state.next];
+            slot.score = in.get<double>();
+            slot.confidence = in.get<double>();
+            slot.source = static_cast<SentimentSource>(source);
+            slot.timestamp = in.getTime();
+            slot.text = in.getString();
+            if (!options_.keepText) {
+                slot.text.clear();
+            }
+            state.next = (state.next + 1) % state.ring.size();
+            state.count = std::min(state.count + 1, state.ring.size());
+        }
+    }
+}
+
+void SentimentAnalyzer::update(SentimentSource source, const std::string& text, double score,
+                               double confidence) {
+    ScoredSentiment item{score, confidence, std::chrono::system_clock::now(), text};
+    ingest(source, SentimentSpan(&item, 1));
+}
+
+double SentimentAnalyzer::sentimentLocked(SentimentSource source) const {
+    const auto& state = sources_[static_cast<size_t>(source)];
+    return state.totalWeight > 0.0 ? state.weightedScore / state.totalWeight : 0.0;
+}
+
+SentimentAnalyzer::ProducerBuffer& SentimentAnalyzer::producerBuffer() {
+    // Threads are dealt buffers round-robin on first use, so a handful of
+    // scrapers each get their own lock
+    static std::atomic<size_t> nextProducer{0};
+    thread_local size_t index = nextProducer.fetch_add(1, std::memory_order_relaxed);
+    return buffers_[index % kProducerBuffers];
+}
+
+void SentimentAnalyzer::mergeLocked() const {
+    for (auto& buffer : buffers_) {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        // Swapping entries trades string buffers between the two pools
+        // instead of freeing them
+        for (size_t i = 0; i < buffer.size; ++i) {
+            if (mergingSize_ == merging_.size()) {
+                merging_.emplace_back();
+            }
+            std::swap(merging_[mergingSize_++], buffer.items[i]);
+        }
+        buffer.size = 0;
+    }
+    if (mergingSize_ == 0) {
+        return;
+    }
+    // Producers interleave, so restore time order before filling the rings.
+    // The index tie-break keeps this stable without stable_sort's buffer.
+    mergeOrder_.resize(mergingSize_);
+    std::iota(mergeOrder_.begin(), mergeOrder_.end(), 0u);
+    std::sort(mergeOrder_.begin(), mergeOrder_.end(), [this](uint32_t a, uint32_t b) {
+        const auto& left = merging_[a].item.timestamp;
+        const auto& right = merging_[b].item.timestamp;
+        return left < right || (left == right && a < b);
+    });
+    for (uint32_t index : mergeOrder_) {
+        const auto& pending = merging_[index];
+        record(sources_[static_cast<size_t>(pending.source)], pending.source, pending.item);
+    }
+    mergingSize_ = 0;
+}
+
+void SentimentAnalyzer::record(SourceState& state, SentimentSource source, const ScoredSentiment& item) const {
+    // Weight by confidence and recency: rebase the sums to the newer timestamp,
+    // or discount an out-of-order item to the current reference
+    double weight = item.confidence;
+    if (state.totalWeight == 0.0 || item.timestamp >= state.reference) {
+        double factor = state.totalWeight == 0.0 ? 0.0 : decay(item.timestamp - state.reference);
+        state.weightedScore *= factor;
+        state.totalWeight *= factor;
+        state.reference = item.timestamp;
+    } else {
+        weight *= decay(state.reference - item.timestamp);
+    }
+    state.weightedScore += item.score * weight;
+    state.totalWeight += weight;
+
+    // The ring stays newest-first for visitRecentLocked and clearOldData, so
+    // a late item only counts towards the aggregate
+    if (state.count > 0 && item.timestamp < state.recent(0).timestamp) {
+        return;
+    }
+    auto& slot = state.ring[state.next];
+    slot.score = item.score;
+    slot.confidence = item.confidence;
+    slot.source = source;
+    slot.timestamp = item.timestamp;
+    slot.text.assign(item.text);
+    state.next = (state.next + 1) % state.ring.size();
+    state.count = std::min(state.count + 1, state.ring.size());
+}
+
+double SentimentAnalyzer::decay(std::chrono::system_clock::duration elapsed) const {
+    return std::exp(-std::chrono::duration<double>(elapsed).count() /
+                    std::chrono::duration<double>(options_.decayTime).count());
 }
 
-} // namespace novacrypt 
\ No newline at end of file
+} // namespace novacrypt
@@ -1,55 +1,186 @@
 #pragma once
+#include <array>
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
 #include <chrono>
 #include <unordered_map>
+#include <cstdint>
+#include "../common/StateStream.h"
 
 namespace novacrypt {
 
+enum class SentimentSource : uint8_t {
+    Twitter,
+    Reddit,
+    News
+};
+
+const char* toString(SentimentSource source);
+
 struct SentimentData {
     double score;  // -1.0 to 1.0 (negative to positive)
     double confidence;
-    std::string source;
+    SentimentSource source;
+    std::chrono::system_clock::time_point timestamp;
+    std::string text;
+};
+
+// One scored item handed to batch ingestion
+struct ScoredSentiment {
+    double score{0.0};       // -1.0 to 1.0
+    double confidence{0.0};  // 0.0 to 1.0
     std::chrono::system_clock::time_point timestamp;
     std::string text;
 };
 
+// Non-owning view of a batch of scored items
+struct SentimentSpan {
+    const ScoredSentiment* data = nullptr;
+    size_t size = 0;
+
+    SentimentSpan() = default;
+    SentimentSpan(const ScoredSentiment* items, size_t count) : data(items), size(count) {}
+    SentimentSpan(const std::vector<ScoredSentiment>& items) : data(items.data()), size(items.size()) {}
+
+    const ScoredSentiment* begin() const { return data; }
+    const ScoredSentiment* end() const { return data + size; }
+};
+
+// Every sentiment feature, read under one lock
+struct SentimentSnapshot {
+    double twitter{0.0};
+    double reddit{0.0};
+    double news{0.0};
+    double aggregate{0.0};
+    double momentum{0.0};  // oldest minus newest score over the last 20 items
+};
+
+struct SentimentOptions {
+    size_t historyCapacity = 1024;        // recent items kept per source
+    bool keepText = true;                 // false drops raw text on ingest
+    std::chrono::seconds decayTime{3600}; // e-folding time of the recency weight
+};
+
+// Bounded-memory sentiment aggregation. Each source keeps its newest
+// historyCapacity items in a fixed ring and a running confidence-weighted,
+// exponentially time-decayed score sum, so aggregate queries are O(1) and
+// memory stays flat however much data arrives. The aggregate covers every
+// item ever seen, not just the ones still in the ring; old items simply
+// decay towards zero weight. An item older than its source's newest one
+// still counts towards the aggregate, discounted by its age, but stays out
+// of the ring, which is kept in time order.
+//
+// All methods are thread-safe. Producers append to one of a few
+// per-producer buffers, so concurrent scrapers rarely share a lock; the
+// buffers are folded into the per-source state by the next query, or by a
+// producer whose buffer has filled up. Buffer entries and ring slots are
+// reused and keep their string capacity, so steady-state ingest does not
+// allocate.
 class SentimentAnalyzer {
 public:
-    SentimentAnalyzer();
-    
-    // Update sentiment data from different sources
+    explicit SentimentAnalyzer(SentimentOptions options = {});
+
+    SentimentAnalyzer(const SentimentAnalyzer&) = delete;
+    SentimentAnalyzer& operator=(const SentimentAnalyzer&) = delete;
+
+    // Batch ingestion for one source. Items failing isValid() are skipped;
+    // returns the number accepted.
+    size_t ingest(SentimentSource source, SentimentSpan items);
+    // Fold every buffered item into the aggregates now
+    void flush();
+    // Finite score in [-1, 1] and confidence in [0, 1]
+    static bool isValid(const ScoredSentiment& item);
+
+    // Single items, timestamped now
     void updateTwitterSentiment(const std::string& text, double score, double confidence);
     void updateRedditSentiment(const std::string& text, double score, double confidence);
     void updateNewsSentiment(const std::string& text, double score, double confidence);
-    
+
     // Get aggregated sentiment metrics
     double getAggregateSentiment() const;
     double getTwitterSentiment() const;
     double getRedditSentiment() const;
     double getNewsSentiment() const;
-    
+    double getSentiment(SentimentSource source) const;
+
     // Get sentiment features for AI model
     std::vector<double> getSentimentFeatures() const;
-    
-    // Get recent sentiment data
+    // The same five features without allocating
+    SentimentSnapshot getSnapshot() const;
+
+    // Newest items across all sources, newest first; O(count)
     std::vector<SentimentData> getRecentSentiments(int count = 10) const;
-    
-    // Clear old sentiment data
+
+    // Drop items older than maxAge from the recent-item rings. A source with
+    // nothing newer than maxAge also has its aggregate reset.
     void clearOldData(std::chrono::hours maxAge);
 
+    const SentimentOptions& getOptions() const;
+
+    // Checkpoint the per-source aggregates and recent-item rings, buffered
+    // items included. Loading replaces the current state; a smaller history
+    // capacity keeps the newest items.
+    void saveState(StateWriter& out) const;
+    void loadState(StateReader& in);
+
 private:
-    // Store sentiment data from different sources
-    std::vector<SentimentData> twitterData_;
-    std::vector<SentimentData> redditData_;
-    std::vector<SentimentData> newsData_;
-    
-    // Calculate weighted average sentiment
-    double calculateWeightedSentiment(const std::vector<SentimentData>& data) const;
-    
-    // Remove old data
-    void removeOldData(std::vector<SentimentData>& data, std::chrono::hours maxAge);
+    static constexpr size_t kSourceCount = 3;
+    static constexpr size_t kMomentumWindow = 20;
+    static constexpr size_t kProducerBuffers = 8;
+    // A producer buffer this full is merged by the producer itself, which
+    // bounds memory when nobody is querying
+    static constexpr size_t kMergeThreshold = 4096;
+
+    struct SourceState {
+        std::vector<SentimentData> ring;
+        size_t next{0};   // slot the next item goes into
+        size_t count{0};
+        // Decayed sums, both expressed as of `reference`. Their ratio is the
+        // weighted mean, which is the same at any later time, so queries never
+        // need to decay them.
+        double weightedScore{0.0};
+        double totalWeight{0.0};
+        std::chrono::system_clock::time_point reference;
+
+        // i = 0 is the newest item
+        const SentimentData& recent(size_t i) const {
+            return ring[(next + ring.size() - 1 - i) % ring.size()];
+        }
+    };
+
+    struct PendingItem {
+        SentimentSource source;
+        ScoredSentiment item;
+    };
+
+    struct alignas(64) ProducerBuffer {
+        std::mutex mutex;
+        std::vector<PendingItem> items;  // the first `size` are pending
+        size_t size{0};
+    };
+
+    void update(SentimentSource source, const std::string& text, double score, double confidence);
+    ProducerBuffer& producerBuffer();
+    // These require stateMutex_
+    void mergeLocked() const;
+    double sentimentLocked(SentimentSource source) const;
+    // Calls visit(item) for up to count items, newest first across sources
+    template <typename Visitor>
+    void visitRecentLocked(size_t count, Visitor&& visit) const;
+    void record(SourceState& state, SentimentSource source, const ScoredSentiment& item) const;
+    double decay(std::chrono::system_clock::duration elapsed) const;
+
+    SentimentOptions options_;
+    // Queries merge pending items first, hence mutable
+    mutable std::mutex stateMutex_;
+    mutable std::array<SourceState, kSourceCount> sources_;
+    mutable std::array<ProducerBuffer, kProducerBuffers> buffers_;
+    // Reused across merges; the first mergingSize_ entries are being merged
+    mutable std::vector<PendingItem> merging_;
+    mutable size_t mergingSize_{0};
+    mutable std::vector<uint32_t> mergeOrder_;
 };
 
-} // namespace novacrypt 
\ No newline at end of file
+} // namespace novacrypt
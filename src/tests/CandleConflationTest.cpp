@@ -0,0 +1,116 @@
+#include "data/MarketDataPipeline.h"
+#include "data/Clock.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+using namespace novacrypt;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr SymbolId kSymbol = 3;
+constexpr int kTicks = 50;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAIL: " << what << std::endl;
+        ++failures;
+    }
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+struct Bars {
+    OHLCV closedSecond;
+    OHLCV openMinute;
+    size_t queuedUpdates;
+};
+
+// Pushes kTicks ticks in one second and one in the next while the pipeline
+// is stopped, so a conflating queue folds the first run into one entry
+Bars runTicks(MarketDataPipeline::QueueMode mode) {
+    const auto start = std::chrono::system_clock::time_point(1700000040s);
+    auto clock = std::make_shared<ManualClock>(start + 2s);
+
+    MarketDataPipeline pipeline;
+    pipeline.setClock(clock);
+    pipeline.setMarketDataQueueMode(mode);
+    SourceId source = pipeline.registerSource("test");
+
+    for (int i = 0; i < kTicks; ++i) {
+        double price = 100.0 + (i * 37 % 23) - 11.0;
+        double volume = 1.0 + i % 7;
+        pipeline.pushMarketData(MarketDataUpdate{price, volume, start + i * 10ms, source, 0.9, kSymbol});
+    }
+    const auto last = start + 1s + 5ms;
+    pipeline.pushMarketData(MarketDataUpdate{150.0, 2.0, last, source, 0.9, kSymbol});
+
+    Bars bars{};
+    bars.queuedUpdates = pipeline.getMarketDataQueueSize();
+    pipeline.start();
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (pipeline.getLatestMarketData(kSymbol).timestamp != last &&
+           std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    pipeline.stop();
+    bars.closedSecond = pipeline.getLastClosedBar(kSymbol, Timeframe::Second1);
+    bars.openMinute = pipeline.getOpenBar(kSymbol, Timeframe::Minute1);
+    return bars;
+}
+
+void checkBar(const OHLCV& bar, const OHLCV& expected, const char* what) {
+    bool same = sameBits(bar.open, expected.open) && sameBits(bar.high, expected.high) &&
+                sameBits(bar.low, expected.low) && sameBits(bar.close, expected.close) &&
+                sameBits(bar.volume, expected.volume) && bar.timestamp == expected.timestamp;
+    if (!same) {
+        std::cerr << what << ": got " << bar.open << '/' << bar.high << '/' << bar.low << '/'
+                  << bar.close << " vol " << bar.volume << ", expected " << expected.open << '/'
+                  << expected.high << '/' << expected.low << '/' << expected.close << " vol "
+                  << expected.volume << std::endl;
+    }
+    check(same, what);
+}
+
+} // namespace
+
+int main() {
+    const auto start = std::chrono::system_clock::time_point(1700000040s);
+    OHLCV second{0.0, 0.0, 1e300, 0.0, 0.0, start};
+    for (int i = 0; i < kTicks; ++i) {
+        double price = 100.0 + (i * 37 % 23) - 11.0;
+        if (i == 0) {
+            second.open = price;
+        }
+        second.high = std::max(second.high, price);
+        second.low = std::min(second.low, price);
+        second.close = price;
+        second.volume += 1.0 + i % 7;
+    }
+    OHLCV minute{second.open, 150.0, second.low, 150.0, second.volume + 2.0, start};
+
+    Bars conflated = runTicks(MarketDataPipeline::QueueMode::Conflating);
+    check(conflated.queuedUpdates == 2, "conflating queue folds one second's ticks into one update");
+    checkBar(conflated.closedSecond, second, "conflated 1s bar");
+    checkBar(conflated.openMinute, minute, "conflated 1m bar");
+
+    Bars fifo = runTicks(MarketDataPipeline::QueueMode::Fifo);
+    check(fifo.queuedUpdates == kTicks + 1, "fifo queue keeps every tick");
+    checkBar(fifo.closedSecond, second, "fifo 1s bar");
+    checkBar(fifo.openMinute, minute, "fifo 1m bar");
+
+    if (failures != 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "CandleConflationTest passed" << std::endl;
+    return 0;
+}
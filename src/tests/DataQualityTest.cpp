@@ -33,8 +33,8 @@ double generateRandomConfidence() {
 }
 
 // Helper function to generate order book levels
-std::vector<OrderBookUpdate::Level> generateOrderBookLevels(double basePrice, int numLevels, bool isBids) {
-    std::vector<OrderBookUpdate::Level> levels;
+OrderBookUpdate::Levels generateOrderBookLevels(double basePrice, int numLevels, bool isBids) {
+    OrderBookUpdate::Levels levels;
     double priceStep = basePrice * 0.001; // 0.1% price step
     
     for (int i = 0; i < numLevels; ++i) {
@@ -51,6 +51,7 @@ std::vector<OrderBookUpdate::Level> generateOrderBookLevels(double basePrice, in
 void simulateMarketData(MarketDataPipeline& pipeline, const std::string& source) {
     double basePrice = 50000.0; // Simulating BTC price
     double baseVolume = 100.0;
+    SourceId sourceId = pipeline.registerSource(source);
     
     while (true) {
         try {
@@ -59,7 +60,7 @@ void simulateMarketData(MarketDataPipeline& pipeline, const std::string& source)
             marketData.price = generateRandomPrice(basePrice, 0.001);
             marketData.volume = generateRandomVolume(baseVolume, 0.2);
             marketData.timestamp = std::chrono::system_clock::now();
-            marketData.source = source;
+            marketData.source = sourceId;
             marketData.confidence = generateRandomConfidence();
             
             // Generate order book
@@ -67,7 +68,7 @@ void simulateMarketData(MarketDataPipeline& pipeline, const std::string& source)
             orderBook.bids = generateOrderBookLevels(marketData.price, 10, true);
             orderBook.asks = generateOrderBookLevels(marketData.price, 10, false);
             orderBook.timestamp = marketData.timestamp;
-            orderBook.source = source;
+            orderBook.source = sourceId;
             orderBook.confidence = generateRandomConfidence();
             
             // Push data to pipeline
@@ -76,7 +77,7 @@ void simulateMarketData(MarketDataPipeline& pipeline, const std::string& source)
             
             // Generate sentiment
             double sentiment = (generateRandomConfidence() - 0.8) * 2.5 - 1.0; // Scale to [-1, 1]
-            pipeline.pushSentimentData(source, sentiment);
+            pipeline.pushSentimentData(sourceId, sentiment);
             
             // Update base price
             basePrice = marketData.price;
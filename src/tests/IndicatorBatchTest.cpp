@@ -0,0 +1,96 @@
+#include "indicators/IndicatorBatch.h"
+#include "indicators/IndicatorManager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+using namespace novacrypt;
+
+namespace {
+
+constexpr size_t kBars = 1000;
+
+int failures = 0;
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+void check(const char* name, size_t bar, double batch, double streaming) {
+    if (!sameBits(batch, streaming)) {
+        // Report the first mismatches only
+        if (failures++ < 20) {
+            std::cerr.precision(17);
+            std::cerr << "FAIL: " << name << " at bar " << bar << ": batch " << batch
+                      << ", streaming " << streaming << std::endl;
+        }
+    }
+}
+
+// Deterministic random walk with occasional flat bars and gaps, so the
+// kernels see zero changes and large true ranges as well as noise
+std::vector<OHLCV> makeCandles() {
+    std::vector<OHLCV> candles;
+    candles.reserve(kBars);
+    uint64_t state = 0x9e3779b97f4a7c15ULL;
+    auto next = [&state]() {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<double>(state >> 11) / static_cast<double>(1ULL << 53);
+    };
+    double close = 30000.0;
+    auto time = std::chrono::system_clock::time_point(std::chrono::seconds(1700000000));
+    for (size_t i = 0; i < kBars; ++i) {
+        double open = close;
+        if (i % 97 == 0) {
+            open *= 1.0 + (next() - 0.5) * 0.1;
+        }
+        close = i % 13 == 0 ? open : open * (1.0 + (next() - 0.5) * 0.01);
+        double high = std::max(open, close) * (1.0 + next() * 0.002);
+        double low = std::min(open, close) * (1.0 - next() * 0.002);
+        candles.push_back(OHLCV{open, high, low, close, next() * 10.0, time});
+        time += std::chrono::minutes(1);
+    }
+    return candles;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<OHLCV> candles = makeCandles();
+    IndicatorBatch batch;
+    const IndicatorSeries series = batch.computeSeries(candles);
+    if (series.size() != candles.size()) {
+        std::cerr << "FAIL: batch returned " << series.size() << " rows for " << candles.size()
+                  << " candles" << std::endl;
+        return 1;
+    }
+
+    IndicatorManager manager;
+    for (size_t i = 0; i < candles.size(); ++i) {
+        manager.update(candles[i]);
+        check("RSI", i, series.rsi[i], manager.getRSI());
+        check("MACD", i, series.macd[i], manager.getMACD());
+        check("MACD signal", i, series.macdSignal[i], manager.getMACDSignal());
+        check("MACD histogram", i, series.macdHistogram[i], manager.getMACDHistogram());
+        check("BB upper", i, series.bbUpper[i], manager.getBBUpper());
+        check("BB middle", i, series.bbMiddle[i], manager.getBBMiddle());
+        check("BB lower", i, series.bbLower[i], manager.getBBLower());
+        check("ATR", i, series.atr[i], manager.getATR());
+        for (const auto& [period, values] : series.sma) {
+            check("SMA", i, values[i], manager.getSMA(period));
+        }
+        for (const auto& [period, values] : series.ema) {
+            check("EMA", i, values[i], manager.getEMA(period));
+        }
+    }
+
+    if (failures != 0) {
+        std::cerr << failures << " value(s) differ" << std::endl;
+        return 1;
+    }
+    std::cout << "IndicatorBatchTest passed" << std::endl;
+    return 0;
+}
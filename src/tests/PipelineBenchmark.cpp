@@ -0,0 +1,345 @@
+#include "../data/MarketDataPipeline.h"
+#include "../data/LatencyHistogram.h"
+#include "../data/Tracing.h"
+#include "../indicators/IndicatorSet.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace novacrypt;
+using namespace std::chrono_literals;
+
+// Pipeline micro and macro benchmarks. Results are printed as a table, or as
+// JSON / CSV for regression tracking:
+//
+//   PipelineBenchmark [--format=text|json|csv] [--quick] [--filter=<substring>]
+//                     [--trace=<file>]
+//
+// --trace writes a Chrome trace of the run; it needs a NOVACRYPT_TRACING build.
+
+namespace {
+
+struct Result {
+    std::string benchmark;
+    std::string metric;
+    double value;
+    std::string unit;
+};
+
+struct Options {
+    std::string format = "text";
+    std::string filter;
+    std::string tracePath;
+    bool quick = false;
+};
+
+// Keeps the optimizer from discarding benchmarked work
+std::atomic<double> sink{0.0};
+
+void consume(double value) {
+    sink.store(value, std::memory_order_relaxed);
+}
+
+template<typename F>
+double nanosecondsPerOp(size_t iterations, F&& operation) {
+    // Warm caches and branch predictors first
+    for (size_t i = 0; i < std::min<size_t>(iterations / 10, 10000); ++i) {
+        operation(i);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        operation(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations);
+}
+
+OHLCV makeCandle(size_t i) {
+    double price = 50000.0 + 100.0 * std::sin(static_cast<double>(i) * 0.01);
+    return OHLCV{price, price + 5.0, price - 5.0, price + 1.0, 10.0 + static_cast<double>(i % 7),
+                 std::chrono::system_clock::now()};
+}
+
+OrderBookUpdate makeBook(SourceId source, size_t depth) {
+    OrderBookUpdate book;
+    for (size_t i = 0; i < depth; ++i) {
+        book.bids.push_back({49999.0 - static_cast<double>(i), 1.0 + static_cast<double>(i)});
+        book.asks.push_back({50001.0 + static_cast<double>(i), 1.0 + static_cast<double>(i)});
+    }
+    book.timestamp = std::chrono::system_clock::now();
+    book.source = source;
+    book.confidence = 0.99;
+    return book;
+}
+
+MarketDataUpdate makeTick(SourceId source, size_t i) {
+    return MarketDataUpdate{50000.0 + static_cast<double>(i % 100), 1.0, std::chrono::system_clock::now(),
+                            source, 0.99, static_cast<SymbolId>(i % 16)};
+}
+
+void addPercentiles(std::vector<Result>& results, const std::string& name,
+                    const LatencyHistogram::Snapshot& latency) {
+    results.push_back({name, "p50", static_cast<double>(latency.percentile(0.50)), "ns"});
+    results.push_back({name, "p99", static_cast<double>(latency.percentile(0.99)), "ns"});
+    results.push_back({name, "p99.9", static_cast<double>(latency.percentile(0.999)), "ns"});
+    results.push_back({name, "max", static_cast<double>(latency.max), "ns"});
+    results.push_back({name, "samples", static_cast<double>(latency.count), "count"});
+}
+
+// Time from pushMarketData to the processing thread's callback, at a paced rate
+void benchmarkPushLatency(const Options& options, std::vector<Result>& results) {
+    const size_t ticks = options.quick ? 20000 : 200000;
+    MarketDataPipeline pipeline;
+    pipeline.setMaxQueueSize(4096);
+    SourceId source = pipeline.registerSource("bench");
+
+    LatencyHistogram latency;
+    std::atomic<size_t> received{0};
+    pipeline.setMarketDataCallback([&](const MarketDataUpdate& data) {
+        auto elapsed = std::chrono::system_clock::now() - data.timestamp;
+        latency.record(static_cast<uint64_t>(std::max<int64_t>(
+            0, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count())));
+        received.fetch_add(1, std::memory_order_relaxed);
+    });
+    pipeline.start();
+
+    for (size_t i = 0; i < ticks; ++i) {
+        pipeline.pushMarketData(makeTick(source, i));
+        // Pace pushes so this measures latency, not queueing under overload
+        auto until = std::chrono::steady_clock::now() + 2us;
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    }
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (received.load() < ticks && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    pipeline.stop();
+    addPercentiles(results, "push_to_callback_latency", latency.snapshot());
+}
+
+// Unpaced pushes from several producer threads into one pipeline
+void benchmarkThroughput(const Options& options, std::vector<Result>& results) {
+    const size_t ticksPerProducer = options.quick ? 50000 : 500000;
+    size_t maxProducers = std::max<size_t>(2, std::thread::hardware_concurrency());
+    for (size_t producers = 1; producers <= maxProducers; producers *= 2) {
+        MarketDataPipeline pipeline;
+        pipeline.setMaxQueueSize(1 << 16);
+        pipeline.setProducerMode(producers == 1 ? ProducerMode::Single : ProducerMode::Multi);
+        std::vector<SourceId> sources;
+        for (size_t p = 0; p < producers; ++p) {
+            sources.push_back(pipeline.registerSource("bench-" + std::to_string(p)));
+        }
+        std::atomic<size_t> processed{0};
+        pipeline.setMarketDataCallback([&](const MarketDataUpdate&) {
+            processed.fetch_add(1, std::memory_order_relaxed);
+        });
+        pipeline.start();
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p] {
+                for (size_t i = 0; i < ticksPerProducer; ++i) {
+                    pipeline.pushMarketData(makeTick(sources[p], i));
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        auto pushed = std::chrono::steady_clock::now();
+        while (pipeline.getMarketDataQueueSize() > 0) {
+            std::this_thread::yield();
+        }
+        auto drained = std::chrono::steady_clock::now();
+        pipeline.stop();
+
+        double total = static_cast<double>(producers * ticksPerProducer);
+        double pushSeconds = std::chrono::duration<double>(pushed - start).count();
+        double drainSeconds = std::chrono::duration<double>(drained - start).count();
+        std::string name = "throughput_" + std::to_string(producers) + "_producers";
+        results.push_back({name, "pushed", total / pushSeconds, "ticks/s"});
+        results.push_back({name, "processed", static_cast<double>(processed.load()) / drainSeconds, "ticks/s"});
+        results.push_back({name, "dropped", (1.0 - static_cast<double>(processed.load()) / total) * 100.0, "%"});
+    }
+}
+
+template<typename IndicatorType>
+void benchmarkIndicator(const std::string& name, IndicatorType indicator, size_t iterations,
+                        const std::vector<OHLCV>& candles, std::vector<Result>& results) {
+    double ns = nanosecondsPerOp(iterations, [&](size_t i) {
+        indicator.update(candles[i % candles.size()]);
+    });
+    consume(indicator.getValue());
+    results.push_back({"indicator_update_" + name, "time", ns, "ns/op"});
+}
+
+void benchmarkIndicators(const Options& options, std::vector<Result>& results) {
+    const size_t iterations = options.quick ? 200000 : 2000000;
+    std::vector<OHLCV> candles;
+    for (size_t i = 0; i < 4096; ++i) {
+        candles.push_back(makeCandle(i));
+    }
+    benchmarkIndicator("sma20", SMA(20), iterations, candles, results);
+    benchmarkIndicator("ema20", EMA(20), iterations, candles, results);
+    benchmarkIndicator("rsi14", RSI(14), iterations, candles, results);
+    benchmarkIndicator("macd", MACD(12, 26, 9), iterations, candles, results);
+    benchmarkIndicator("bollinger20", BollingerBands(20, 2.0), iterations, candles, results);
+    benchmarkIndicator("atr14", ATR(14), iterations, candles, results);
+
+    IndicatorManager manager;
+    double ns = nanosecondsPerOp(iterations, [&](size_t i) {
+        manager.update(candles[i % candles.size()]);
+    });
+    consume(manager.getRSI());
+    results.push_back({"indicator_update_manager", "time", ns, "ns/op"});
+
+    // Same indicators with compile-time periods, no virtual dispatch
+    DefaultIndicatorSet set;
+    ns = nanosecondsPerOp(iterations, [&](size_t i) {
+        set.update(candles[i % candles.size()]);
+    });
+    consume(set.value<fixed::RSI<14>>());
+    results.push_back({"indicator_update_set", "time", ns, "ns/op"});
+}
+
+void benchmarkValidation(const Options& options, std::vector<Result>& results) {
+    const size_t iterations = options.quick ? 100000 : 1000000;
+    MarketDataPipeline pipeline;
+    SourceId source = pipeline.registerSource("bench");
+    for (size_t depth : {1, 5, 10, 20, 50, 100}) {
+        OrderBookUpdate book = makeBook(source, depth);
+        size_t valid = 0;
+        double ns = nanosecondsPerOp(iterations, [&](size_t) {
+            valid += pipeline.validateOrderBook(book);
+        });
+        consume(static_cast<double>(valid));
+        results.push_back({"validate_order_book_depth_" + std::to_string(depth), "time", ns, "ns/op"});
+    }
+}
+
+void benchmarkQualityTracker(const Options& options, std::vector<Result>& results) {
+    const size_t iterations = options.quick ? 500000 : 5000000;
+    DataQualityTracker tracker;
+    SourceId source = tracker.registerSource("bench");
+    const std::string name = "bench";
+
+    results.push_back({"quality_record_data_point", "time",
+                       nanosecondsPerOp(iterations, [&](size_t i) { tracker.recordDataPoint(source, i % 64 != 0); }),
+                       "ns/op"});
+    results.push_back({"quality_record_latency", "time",
+                       nanosecondsPerOp(iterations, [&](size_t i) {
+                           tracker.recordLatency(source, std::chrono::microseconds(i % 5000));
+                       }),
+                       "ns/op"});
+    results.push_back({"quality_record_data_point_by_name", "time",
+                       nanosecondsPerOp(iterations / 10, [&](size_t i) { tracker.recordDataPoint(name, i % 64 != 0); }),
+                       "ns/op"});
+    results.push_back({"quality_snapshot_if_due", "time",
+                       nanosecondsPerOp(iterations, [&](size_t) { consume(tracker.snapshotIfDue()); }),
+                       "ns/op"});
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void printResults(const Options& options, const std::vector<Result>& results) {
+    if (options.format == "json") {
+        std::cout << "{\n  \"hardware_threads\": " << std::thread::hardware_concurrency()
+                  << ",\n  \"quick\": " << (options.quick ? "true" : "false")
+                  << ",\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto& result = results[i];
+            std::cout << "    {\"benchmark\": \"" << jsonEscape(result.benchmark)
+                      << "\", \"metric\": \"" << jsonEscape(result.metric)
+                      << "\", \"value\": " << std::setprecision(10) << result.value
+                      << ", \"unit\": \"" << jsonEscape(result.unit) << "\"}"
+                      << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        std::cout << "  ]\n}\n";
+    } else if (options.format == "csv") {
+        std::cout << "benchmark,metric,value,unit\n";
+        for (const auto& result : results) {
+            std::cout << result.benchmark << "," << result.metric << ","
+                      << std::setprecision(10) << result.value << "," << result.unit << "\n";
+        }
+    } else {
+        for (const auto& result : results) {
+            std::cout << std::left << std::setw(40) << result.benchmark << std::setw(10) << result.metric
+                      << std::right << std::setw(16) << std::fixed << std::setprecision(2) << result.value
+                      << " " << result.unit << "\n";
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--format=", 0) == 0) {
+            options.format = arg.substr(9);
+        } else if (arg.rfind("--filter=", 0) == 0) {
+            options.filter = arg.substr(9);
+        } else if (arg.rfind("--trace=", 0) == 0) {
+            options.tracePath = arg.substr(8);
+        } else if (arg == "--quick") {
+            options.quick = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--format=text|json|csv] [--quick] [--filter=<substring>] [--trace=<file>]\n";
+            return 2;
+        }
+    }
+    if (options.format != "text" && options.format != "json" && options.format != "csv") {
+        std::cerr << "Unknown format: " << options.format << "\n";
+        return 2;
+    }
+
+    using Benchmark = void (*)(const Options&, std::vector<Result>&);
+    const std::pair<const char*, Benchmark> benchmarks[] = {
+        {"push_latency", benchmarkPushLatency},
+        {"throughput", benchmarkThroughput},
+        {"indicators", benchmarkIndicators},
+        {"validation", benchmarkValidation},
+        {"quality_tracker", benchmarkQualityTracker},
+    };
+
+    try {
+        if (!options.tracePath.empty()) {
+            Tracer::instance().setEnabled(true);
+        }
+        std::vector<Result> results;
+        for (const auto& [name, run] : benchmarks) {
+            if (!options.filter.empty() && std::string(name).find(options.filter) == std::string::npos) {
+                continue;
+            }
+            std::cerr << "Running " << name << "..." << std::endl;
+            run(options, results);
+        }
+        printResults(options, results);
+        if (!options.tracePath.empty()) {
+            Tracer::instance().writeChromeTrace(options.tracePath);
+            std::cerr << Tracer::instance().statsReport();
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
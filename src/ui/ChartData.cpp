@@ -0,0 +1,196 @@
+#include "ChartData.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace novacrypt {
+
+ChartSeries::ChartSeries(size_t capacity)
+    : capacity_(capacity),
+      begin_(0),
+      size_(0)
+{
+    if (capacity == 0) {
+        throw std::invalid_argument("Chart series capacity must be positive");
+    }
+}
+
+void ChartSeries::push(const double* values) {
+    if (begin_ + size_ == 2 * capacity_) {
+        // Storage is full: keep the newest capacity - 1 points at the front
+        size_t keep = capacity_ - 1;
+        for (auto& column : columns_) {
+            std::copy(column.end() - keep, column.end(), column.begin());
+            column.resize(keep);
+        }
+        begin_ = 0;
+        size_ = keep;
+    }
+    for (size_t i = 0; i < kColumns; ++i) {
+        columns_[i].push_back(values[i]);
+    }
+    if (size_ == capacity_) {
+        ++begin_;
+    } else {
+        ++size_;
+    }
+}
+
+void ChartSeries::clear() {
+    for (auto& column : columns_) {
+        column.clear();
+    }
+    begin_ = 0;
+    size_ = 0;
+}
+
+size_t ChartSeries::size() const {
+    return size_;
+}
+
+size_t ChartSeries::capacity() const {
+    return capacity_;
+}
+
+bool ChartSeries::empty() const {
+    return size_ == 0;
+}
+
+const double* ChartSeries::column(Column column) const {
+    return columns_[column].data() + begin_;
+}
+
+std::pair<size_t, size_t> ChartSeries::visibleRange(double from, double to) const {
+    const double* time = column(Time);
+    size_t first = static_cast<size_t>(std::lower_bound(time, time + size_, from) - time);
+    size_t last = static_cast<size_t>(std::upper_bound(time, time + size_, to) - time);
+    if (first > 0) --first;
+    if (last < size_) ++last;
+    return {first, std::max(first, last)};
+}
+
+ChartHistory::ChartHistory(size_t capacity)
+    : points_(capacity),
+      blocks_(capacity / kBlockSize + 1),
+      block_{},
+      blockFill_(0) {}
+
+void ChartHistory::push(const double* values) {
+    points_.push(values);
+    if (blockFill_ == 0) {
+        std::copy(values, values + ChartSeries::kColumns, block_);
+    } else {
+        // Time and Open stay at the block's first point
+        block_[ChartSeries::High] = std::max(block_[ChartSeries::High], values[ChartSeries::High]);
+        block_[ChartSeries::Low] = std::min(block_[ChartSeries::Low], values[ChartSeries::Low]);
+        std::copy(values + ChartSeries::Close, values + ChartSeries::kColumns, block_ + ChartSeries::Close);
+    }
+    if (++blockFill_ == kBlockSize) {
+        blocks_.push(block_);
+        blockFill_ = 0;
+    }
+}
+
+void ChartHistory::clear() {
+    points_.clear();
+    blocks_.clear();
+    blockFill_ = 0;
+}
+
+const ChartSeries& ChartHistory::points() const {
+    return points_;
+}
+
+const ChartSeries& ChartHistory::blocks() const {
+    return blocks_;
+}
+
+const ChartSeries& ChartHistory::levelFor(double from, double to, size_t targetPoints) const {
+    auto range = points_.visibleRange(from, to);
+    bool coarse = range.second - range.first >= kBlockSize * targetPoints && blocks_.size() > 1;
+    return coarse ? blocks_ : points_;
+}
+
+size_t downsampleLttb(const double* x, const double* y, size_t count, size_t threshold,
+                      double* outX, double* outY) {
+    threshold = std::max<size_t>(threshold, 3);
+    if (count <= threshold) {
+        std::copy(x, x + count, outX);
+        std::copy(y, y + count, outY);
+        return count;
+    }
+
+    const double bucketSize = static_cast<double>(count - 2) / static_cast<double>(threshold - 2);
+    size_t written = 0;
+    size_t kept = 0;
+    outX[written] = x[0];
+    outY[written] = y[0];
+    ++written;
+
+    for (size_t bucket = 0; bucket < threshold - 2; ++bucket) {
+        // Average of the next bucket is the third triangle vertex
+        size_t nextStart = static_cast<size_t>(std::floor((bucket + 1) * bucketSize)) + 1;
+        size_t nextEnd = std::min(static_cast<size_t>(std::floor((bucket + 2) * bucketSize)) + 1, count);
+        double avgX = 0.0;
+        double avgY = 0.0;
+        for (size_t i = nextStart; i < nextEnd; ++i) {
+            avgX += x[i];
+            avgY += y[i];
+        }
+        double span = static_cast<double>(nextEnd - nextStart);
+        avgX /= span;
+        avgY /= span;
+
+        size_t start = static_cast<size_t>(std::floor(bucket * bucketSize)) + 1;
+        size_t end = nextStart;
+        double maxArea = -1.0;
+        size_t chosen = start;
+        for (size_t i = start; i < end; ++i) {
+            // Twice the triangle area; the factor does not change the argmax
+            double area = std::abs((x[kept] - avgX) * (y[i] - y[kept]) -
+                                   (x[kept] - x[i]) * (avgY - y[kept]));
+            if (area > maxArea) {
+                maxArea = area;
+                chosen = i;
+            }
+        }
+        outX[written] = x[chosen];
+        outY[written] = y[chosen];
+        ++written;
+        kept = chosen;
+    }
+
+    outX[written] = x[count - 1];
+    outY[written] = y[count - 1];
+    return written + 1;
+}
+
+size_t downsampleCandles(const double* time, const double* open, const double* high,
+                         const double* low, const double* close, size_t count, size_t buckets,
+                         double* outTime, double* outOpen, double* outHigh,
+                         double* outLow, double* outClose) {
+    buckets = std::max<size_t>(buckets, 1);
+    size_t perBucket = (count + buckets - 1) / buckets;
+    if (perBucket <= 1) {
+        std::copy(time, time + count, outTime);
+        std::copy(open, open + count, outOpen);
+        std::copy(high, high + count, outHigh);
+        std::copy(low, low + count, outLow);
+        std::copy(close, close + count, outClose);
+        return count;
+    }
+
+    size_t written = 0;
+    for (size_t first = 0; first < count; first += perBucket) {
+        size_t last = std::min(first + perBucket, count);
+        outTime[written] = time[first];
+        outOpen[written] = open[first];
+        outClose[written] = close[last - 1];
+        outHigh[written] = *std::max_element(high + first, high + last);
+        outLow[written] = *std::min_element(low + first, low + last);
+        ++written;
+    }
+    return written;
+}
+
+} // namespace novacrypt
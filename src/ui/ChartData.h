@@ -0,0 +1,100 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace novacrypt {
+
+// Columnar chart points with a fixed capacity. Storage holds up to twice
+// the capacity; when it fills, the newest `capacity` points slide back to
+// the front. Pushes stay amortized O(1) and the live window is always
+// contiguous, so ImPlot and the downsamplers read plain arrays with no
+// wraparound.
+class ChartSeries {
+public:
+    enum Column : size_t {
+        Time,   // Unix seconds, the ImPlot time axis unit
+        Open,
+        High,
+        Low,
+        Close,
+        Sma20,
+        Sma50,
+        Ema12,
+        Rsi,
+        kColumns
+    };
+
+    explicit ChartSeries(size_t capacity);
+
+    // Appends one point; values holds kColumns entries in Column order.
+    // The oldest point is dropped once size() reaches capacity().
+    void push(const double* values);
+    void clear();
+
+    size_t size() const;
+    size_t capacity() const;
+    bool empty() const;
+
+    // size() values, oldest first
+    const double* column(Column column) const;
+
+    // Index range [first, last) of the points with a time inside [from, to],
+    // widened by one point on each side so lines run to the plot edges
+    std::pair<size_t, size_t> visibleRange(double from, double to) const;
+
+private:
+    size_t capacity_;
+    size_t begin_;
+    size_t size_;
+    std::array<std::vector<double>, kColumns> columns_;
+};
+
+// Chart history for the dashboard, owned by the UI thread: the raw points
+// plus a coarse level where every kBlockSize points are merged into one
+// candle (first open, max high, min low, last close; indicators take their
+// last value). Both are maintained on push, so a zoomed-out frame
+// downsamples a few thousand blocks instead of a million points.
+class ChartHistory {
+public:
+    static constexpr size_t kBlockSize = 64;
+
+    explicit ChartHistory(size_t capacity);
+
+    void push(const double* values);
+    void clear();
+
+    const ChartSeries& points() const;
+    // Completed blocks only; the newest < kBlockSize points are not in here
+    const ChartSeries& blocks() const;
+
+    // The level to draw [from, to] at targetPoints: blocks once a block is
+    // no wider than one target point, otherwise the raw points
+    const ChartSeries& levelFor(double from, double to, size_t targetPoints) const;
+
+private:
+    ChartSeries points_;
+    ChartSeries blocks_;
+    double block_[ChartSeries::kColumns];
+    size_t blockFill_;
+};
+
+// Largest-Triangle-Three-Buckets: keeps the first and last point and, from
+// each of threshold - 2 equal buckets in between, the point forming the
+// largest triangle with the previously kept point and the next bucket's
+// average. Preserves the visual shape of a line far better than striding.
+// Writes up to max(threshold, 3) points (all of them if count is smaller)
+// and returns how many were written.
+size_t downsampleLttb(const double* x, const double* y, size_t count, size_t threshold,
+                      double* outX, double* outY);
+
+// Merges candles into at most `buckets` candles of equal point count: open
+// of the first, close of the last, and the min low / max high in between, so
+// no wick is lost at any zoom level. Returns the number written.
+size_t downsampleCandles(const double* time, const double* open, const double* high,
+                         const double* low, const double* close, size_t count, size_t buckets,
+                         double* outTime, double* outOpen, double* outHigh,
+                         double* outLow, double* outClose);
+
+} // namespace novacrypt
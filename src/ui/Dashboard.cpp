@@ -1,9 +1,11 @@
 #include "Dashboard.h"
 #include <imgui_internal.h>
+#include <implot.h>
+#include <implot_internal.h>
 #include <algorithm>
 #include <chrono>
-#include <iomanip>
-#include <sstream>
+#include <cmath>
+#include <cstdio>
 
 namespace novacrypt {
 
@@ -13,7 +15,16 @@ Dashboard::Dashboard()
       showSettings_(false),
       showTradeLog_(true),
       showPerformance_(true),
-      liveTrading_(false)
+      liveTrading_(false),
+      droppedUpdates_(0),
+      chart_(kChartHistoryCapacity),
+      series_(&chart_.points()),
+      visible_(0, 0),
+      plotWidth_(1),
+      xMin_(0.0),
+      xMax_(1.0),
+      signalHead_(0),
+      signalCount_(0)
 {
     // Initialize metrics
     currentMetrics_ = {0.0, 0.0, 0.0, 0.0, 0};
@@ -41,6 +52,7 @@ bool Dashboard::initialize() {
     // Setup Dear ImGui
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
+    ImPlot::CreateContext();
     ImGuiIO& io = ImGui::GetIO();
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
     io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
@@ -59,6 +71,7 @@ bool Dashboard::initialize() {
 void Dashboard::run() {
     while (!glfwWindowShouldClose(window_) && running_) {
         glfwPollEvents();
+        consumeFeed();
 
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -81,6 +94,7 @@ void Dashboard::run() {
 void Dashboard::shutdown() {
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
+    ImPlot::DestroyContext();
     ImGui::DestroyContext();
 
     if (window_) {
@@ -147,11 +161,39 @@ void Dashboard::renderChart() {
     // Chart area
     ImVec2 chartSize = ImGui::GetContentRegionAvail();
     ImGui::BeginChild("Chart", chartSize, true);
-    
-    drawCandlestickChart();
-    drawIndicators();
-    drawTradeSignals();
-    
+
+    float priceHeight = ImGui::GetContentRegionAvail().y * 0.7f;
+    if (ImPlot::BeginPlot("##Price", ImVec2(-1, priceHeight))) {
+        ImPlot::SetupAxes(nullptr, "Price", 0, ImPlotAxisFlags_AutoFit | ImPlotAxisFlags_RangeFit);
+        ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Time);
+        ImPlot::SetupAxisLinks(ImAxis_X1, &xMin_, &xMax_);
+
+        // Only what is inside the X range is downsampled and drawn, except
+        // when X is being fitted, which needs everything. Y auto-fits to
+        // whatever is drawn.
+        ImPlotRect limits = ImPlot::GetPlotLimits();
+        bool fitX = ImPlot::GetCurrentPlot()->Axes[ImAxis_X1].FitThisFrame;
+        double from = fitX ? -HUGE_VAL : limits.X.Min;
+        double to = fitX ? HUGE_VAL : limits.X.Max;
+        plotWidth_ = std::max<size_t>(static_cast<size_t>(ImPlot::GetPlotSize().x), 1);
+        series_ = &chart_.levelFor(from, to, plotWidth_);
+        visible_ = series_->visibleRange(from, to);
+
+        drawCandlestickChart();
+        drawIndicators();
+        drawTradeSignals();
+        ImPlot::EndPlot();
+    }
+
+    if (ImPlot::BeginPlot("##RSI", ImVec2(-1, -1))) {
+        ImPlot::SetupAxes(nullptr, "RSI");
+        ImPlot::SetupAxisScale(ImAxis_X1, ImPlotScale_Time);
+        ImPlot::SetupAxisLinks(ImAxis_X1, &xMin_, &xMax_);
+        ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 100.0, ImPlotCond_Always);
+        drawLine("RSI 14", ChartSeries::Rsi);
+        ImPlot::EndPlot();
+    }
+
     ImGui::EndChild();
 }
 
@@ -159,8 +201,10 @@ void Dashboard::renderTradeSignals() {
     ImGui::Text("Trade Signals");
     ImGui::Separator();
 
-    for (const auto& signal : tradeSignals_) {
-        ImGui::PushID(&signal);
+    for (size_t i = 0; i < signalCount_; ++i) {
+        const SignalRow& row = signals_[(signalHead_ + i) % kMaxSignals];
+        const TradeSignal& signal = row.signal;
+        ImGui::PushID(static_cast<int>(i));
         
         // Signal type indicator
         ImVec4 color;
@@ -180,16 +224,11 @@ void Dashboard::renderTradeSignals() {
         }
 
         // Confidence bar
-        ImGui::ProgressBar(signal.confidence, ImVec2(-1, 0), 
-            std::to_string(static_cast<int>(signal.confidence * 100)).append("%").c_str());
+        ImGui::ProgressBar(static_cast<float>(signal.confidence), ImVec2(-1, 0), row.confidenceLabel.c_str());
 
         // Reason and timestamp
         ImGui::TextWrapped("%s", signal.reason.c_str());
-        
-        std::stringstream ss;
-        ss << std::put_time(std::localtime(&std::chrono::system_clock::to_time_t(signal.timestamp)),
-                          "%Y-%m-%d %H:%M:%S");
-        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "%s", ss.str().c_str());
+        ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "%s", row.timeLabel.c_str());
         
         ImGui::Separator();
         ImGui::PopID();
@@ -221,6 +260,11 @@ void Dashboard::renderPerformanceMetrics() {
     ImGui::Text("%d", currentMetrics_.totalTrades);
     
     ImGui::Columns(1);
+
+    if (droppedUpdates_ > 0) {
+        ImGui::TextColored(ImVec4(0.8f, 0.8f, 0.0f, 1.0f), "Dropped updates: %llu",
+                           static_cast<unsigned long long>(droppedUpdates_));
+    }
 }
 
 void Dashboard::renderSettings() {
@@ -322,33 +366,138 @@ void Dashboard::setupFonts() {
 }
 
 void Dashboard::onMarketDataUpdate(const OHLCV& data) {
-    marketData_.push_back(data);
-    // Keep only last 1000 data points
-    if (marketData_.size() > 1000) {
-        marketData_.erase(marketData_.begin());
-    }
+    feed_.pushCandle(data);
 }
 
 void Dashboard::onTradeSignal(const TradeSignal& signal) {
-    tradeSignals_.push_back(signal);
-    // Keep only last 50 signals
-    if (tradeSignals_.size() > 50) {
-        tradeSignals_.erase(tradeSignals_.begin());
-    }
+    feed_.pushSignal(signal);
 }
 
 void Dashboard::onPerformanceUpdate(const PerformanceMetrics& metrics) {
-    currentMetrics_ = metrics;
+    feed_.pushMetrics(metrics);
+}
+
+void Dashboard::consumeFeed() {
+    feed_.drain(batch_);
+    droppedUpdates_ += batch_.dropped;
+
+    if (!batch_.candles.empty()) {
+        const ChartSeries& points = chart_.points();
+        bool wasEmpty = points.empty();
+        double previousLast = wasEmpty ? 0.0 : points.column(ChartSeries::Time)[points.size() - 1];
+
+        double row[ChartSeries::kColumns];
+        for (const auto& candle : batch_.candles) {
+            chartIndicators_.update(candle);
+            row[ChartSeries::Time] = std::chrono::duration<double>(candle.timestamp.time_since_epoch()).count();
+            row[ChartSeries::Open] = candle.open;
+            row[ChartSeries::High] = candle.high;
+            row[ChartSeries::Low] = candle.low;
+            row[ChartSeries::Close] = candle.close;
+            row[ChartSeries::Sma20] = chartIndicators_.value<fixed::SMA<20>>();
+            row[ChartSeries::Sma50] = chartIndicators_.value<fixed::SMA<50>>();
+            row[ChartSeries::Ema12] = chartIndicators_.value<fixed::EMA<12>>();
+            row[ChartSeries::Rsi] = chartIndicators_.value<fixed::RSI<14>>();
+            chart_.push(row);
+        }
+
+        const double* time = points.column(ChartSeries::Time);
+        double last = time[points.size() - 1];
+        if (wasEmpty) {
+            xMin_ = time[0];
+            xMax_ = std::max(last, xMin_ + 60.0);
+        } else if (xMax_ >= previousLast) {
+            // Scroll with new data while the live edge is in view
+            xMin_ += last - previousLast;
+            xMax_ += last - previousLast;
+        }
+    }
+
+    for (auto& signal : batch_.signals) {
+        size_t slot;
+        if (signalCount_ < kMaxSignals) {
+            slot = (signalHead_ + signalCount_) % kMaxSignals;
+            ++signalCount_;
+        } else {
+            slot = signalHead_;
+            signalHead_ = (signalHead_ + 1) % kMaxSignals;
+        }
+        SignalRow& row = signals_[slot];
+        char label[16];
+        std::snprintf(label, sizeof(label), "%d%%", static_cast<int>(signal.confidence * 100));
+        row.confidenceLabel = label;
+        row.timeLabel = formatLocalTime(signal.timestamp);
+        row.signal = std::move(signal);
+    }
+
+    if (batch_.hasMetrics) {
+        currentMetrics_ = batch_.metrics;
+    }
 }
 
 void Dashboard::drawCandlestickChart() {
-    // TODO: Implement candlestick chart drawing
-    // This would use ImPlot or custom OpenGL rendering
+    size_t first = visible_.first;
+    size_t count = visible_.second - visible_.first;
+    if (count == 0) return;
+
+    // About one candle per two pixels; beyond that candles are merged
+    size_t buckets = std::max<size_t>(plotWidth_ / 2, 1);
+    size_t capacity = std::min(count, buckets);
+    auto& s = scratch_;
+    s.time.resize(capacity);
+    s.open.resize(capacity);
+    s.high.resize(capacity);
+    s.low.resize(capacity);
+    s.close.resize(capacity);
+    size_t n = downsampleCandles(series_->column(ChartSeries::Time) + first, series_->column(ChartSeries::Open) + first,
+                                 series_->column(ChartSeries::High) + first, series_->column(ChartSeries::Low) + first,
+                                 series_->column(ChartSeries::Close) + first, count, buckets,
+                                 s.time.data(), s.open.data(), s.high.data(), s.low.data(), s.close.data());
+
+    if (!ImPlot::BeginItem("Price")) return;
+    if (ImPlot::FitThisFrame()) {
+        for (size_t i = 0; i < n; ++i) {
+            ImPlot::FitPoint(ImPlotPoint(s.time[i], s.low[i]));
+            ImPlot::FitPoint(ImPlotPoint(s.time[i], s.high[i]));
+        }
+    }
+
+    ImDrawList* drawList = ImPlot::GetPlotDrawList();
+    double halfWidth = n > 1 ? 0.4 * (s.time[n - 1] - s.time[0]) / static_cast<double>(n - 1) : 0.5;
+    const ImU32 up = IM_COL32(0, 204, 0, 255);
+    const ImU32 down = IM_COL32(204, 0, 0, 255);
+    for (size_t i = 0; i < n; ++i) {
+        ImU32 color = s.close[i] >= s.open[i] ? up : down;
+        ImVec2 lowPos = ImPlot::PlotToPixels(s.time[i], s.low[i]);
+        ImVec2 highPos = ImPlot::PlotToPixels(s.time[i], s.high[i]);
+        ImVec2 openPos = ImPlot::PlotToPixels(s.time[i] - halfWidth, s.open[i]);
+        ImVec2 closePos = ImPlot::PlotToPixels(s.time[i] + halfWidth, s.close[i]);
+        drawList->AddLine(lowPos, highPos, color);
+        drawList->AddRectFilled(openPos, closePos, color);
+    }
+    ImPlot::EndItem();
 }
 
 void Dashboard::drawIndicators() {
-    // TODO: Implement indicator overlays
-    // This would draw RSI, MACD, Moving Averages, etc.
+    drawLine("SMA 20", ChartSeries::Sma20);
+    drawLine("SMA 50", ChartSeries::Sma50);
+    drawLine("EMA 12", ChartSeries::Ema12);
+}
+
+void Dashboard::drawLine(const char* label, ChartSeries::Column column) {
+    size_t first = visible_.first;
+    size_t count = visible_.second - visible_.first;
+    if (count == 0) return;
+
+    // One point per pixel column is all the plot can show
+    size_t threshold = std::max<size_t>(plotWidth_, 3);
+    size_t capacity = std::min(count, threshold);
+    auto& s = scratch_;
+    s.lineX.resize(capacity);
+    s.lineY.resize(capacity);
+    size_t n = downsampleLttb(series_->column(ChartSeries::Time) + first, series_->column(column) + first,
+                              count, threshold, s.lineX.data(), s.lineY.data());
+    ImPlot::PlotLine(label, s.lineX.data(), s.lineY.data(), static_cast<int>(n));
 }
 
 void Dashboard::drawTradeSignals() {
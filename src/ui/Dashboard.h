@@ -1 +1,115 @@
- 
\ No newline at end of file
+#pragma once
+#include "ChartData.h"
+#include "DashboardFeed.h"
+#include "../indicators/IndicatorSet.h"
+#include <imgui.h>
+#include <imgui_impl_glfw.h>
+#include <imgui_impl_opengl3.h>
+#include <GLFW/glfw3.h>
+#include <array>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace novacrypt {
+
+// ImGui/ImPlot trading dashboard. The on*Update methods may be called from
+// any thread: they only publish to the DashboardFeed, which the render loop
+// drains once per frame into UI-owned chart history and label caches.
+class Dashboard {
+public:
+    // Points kept for the chart; drawing cost depends on the plot width, not this
+    static constexpr size_t kChartHistoryCapacity = 1 << 20;
+    static constexpr size_t kMaxSignals = 50;
+
+    Dashboard();
+    ~Dashboard();
+
+    Dashboard(const Dashboard&) = delete;
+    Dashboard& operator=(const Dashboard&) = delete;
+
+    bool initialize();
+    void run();
+    void shutdown();
+
+    void onMarketDataUpdate(const OHLCV& data);
+    void onTradeSignal(const TradeSignal& signal);
+    void onPerformanceUpdate(const PerformanceMetrics& metrics);
+
+    // For producers that want to hold the feed directly
+    DashboardFeed& getFeed() { return feed_; }
+
+    void setLiveTradingCallback(std::function<void(bool)> callback) { onLiveTradingToggle_ = std::move(callback); }
+    void setStrategyChangeCallback(std::function<void(const std::string&)> callback) { onStrategyChange_ = std::move(callback); }
+    void setParameterUpdateCallback(std::function<void(const std::map<std::string, double>&)> callback) {
+        onParameterUpdate_ = std::move(callback);
+    }
+
+private:
+    // Indicators drawn over the chart, computed on the UI thread
+    using ChartIndicators = IndicatorSet<fixed::SMA<20>, fixed::SMA<50>, fixed::EMA<12>, fixed::RSI<14>>;
+
+    // A signal with the labels it renders with, formatted once on arrival
+    struct SignalRow {
+        TradeSignal signal;
+        std::string confidenceLabel;
+        std::string timeLabel;
+    };
+
+    // Reused per-frame output of the downsamplers
+    struct ChartScratch {
+        std::vector<double> time, open, high, low, close;
+        std::vector<double> lineX, lineY;
+    };
+
+    void consumeFeed();
+
+    void renderMainWindow();
+    void renderChart();
+    void renderTradeSignals();
+    void renderPerformanceMetrics();
+    void renderSettings();
+    void renderTradeLog();
+
+    void setupTheme();
+    void setupFonts();
+
+    void drawCandlestickChart();
+    void drawIndicators();
+    void drawTradeSignals();
+    void drawLine(const char* label, ChartSeries::Column column);
+
+    GLFWwindow* window_;
+    bool running_;
+    bool showSettings_;
+    bool showTradeLog_;
+    bool showPerformance_;
+    bool liveTrading_;
+
+    DashboardFeed feed_;
+    DashboardFeed::Batch batch_;
+    uint64_t droppedUpdates_;
+
+    ChartHistory chart_;
+    ChartIndicators chartIndicators_;
+    ChartScratch scratch_;
+    const ChartSeries* series_;          // level of chart_ drawn this frame
+    std::pair<size_t, size_t> visible_;  // its index range in view
+    size_t plotWidth_;                   // pixels, the downsampling target
+    double xMin_;                        // X range shared by the price and RSI plots
+    double xMax_;
+
+    std::array<SignalRow, kMaxSignals> signals_;
+    size_t signalHead_;   // oldest row
+    size_t signalCount_;
+
+    PerformanceMetrics currentMetrics_;
+    std::vector<TradeLogEntry> tradeLog_;
+
+    std::function<void(bool)> onLiveTradingToggle_;
+    std::function<void(const std::string&)> onStrategyChange_;
+    std::function<void(const std::map<std::string, double>&)> onParameterUpdate_;
+};
+
+} // namespace novacrypt
@@ -0,0 +1,63 @@
+#include "DashboardFeed.h"
+#include <cstdio>
+#include <ctime>
+#include <stdexcept>
+
+namespace novacrypt {
+
+std::string formatLocalTime(std::chrono::system_clock::time_point timestamp) {
+    std::time_t time = std::chrono::system_clock::to_time_t(timestamp);
+    std::tm local{};
+    localtime_r(&time, &local);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+    return stamp;
+}
+
+std::string TradeLogEntry::toString() const {
+    const char* side = type == TradeType::BUY ? "BUY" : (type == TradeType::SELL ? "SELL" : "HOLD");
+    char line[96];
+    std::snprintf(line, sizeof(line), "  %-4s %.6f @ %.2f", side, quantity, price);
+    return formatLocalTime(timestamp) + line;
+}
+
+DashboardFeed::DashboardFeed(size_t maxPending) : maxPending_(maxPending) {
+    if (maxPending == 0) {
+        throw std::invalid_argument("Dashboard feed needs room for at least one item");
+    }
+}
+
+void DashboardFeed::pushCandle(const OHLCV& candle) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.candles.size() >= maxPending_) {
+        ++pending_.dropped;
+        return;
+    }
+    pending_.candles.push_back(candle);
+}
+
+void DashboardFeed::pushSignal(const TradeSignal& signal) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.signals.size() >= maxPending_) {
+        ++pending_.dropped;
+        return;
+    }
+    pending_.signals.push_back(signal);
+}
+
+void DashboardFeed::pushMetrics(const PerformanceMetrics& metrics) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending_.metrics = metrics;
+    pending_.hasMetrics = true;
+}
+
+void DashboardFeed::drain(Batch& batch) {
+    batch.candles.clear();
+    batch.signals.clear();
+    batch.hasMetrics = false;
+    batch.dropped = 0;
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::swap(pending_, batch);
+}
+
+} // namespace novacrypt
@@ -0,0 +1,90 @@
+#pragma once
+#include "../indicators/MarketData.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace novacrypt {
+
+struct TradeSignal {
+    enum class Type {
+        BUY,
+        SELL,
+        HOLD
+    };
+
+    Type type;
+    double confidence;  // 0..1
+    std::string reason;
+    std::chrono::system_clock::time_point timestamp;
+};
+
+// Percentages, as shown on the dashboard
+struct PerformanceMetrics {
+    double totalPnL;
+    double winRate;
+    double averageTrade;
+    double maxDrawdown;
+    int totalTrades;
+};
+
+enum class TradeType {
+    BUY,
+    SELL,
+    HOLD
+};
+
+struct TradeLogEntry {
+    TradeType type;
+    double price;
+    double quantity;
+    std::chrono::system_clock::time_point timestamp;
+
+    std::string toString() const;
+};
+
+// "YYYY-mm-dd HH:MM:SS" in local time
+std::string formatLocalTime(std::chrono::system_clock::time_point timestamp);
+
+// Hand-off from the trading threads to the UI thread. Producers append to
+// back buffers under a mutex the UI thread only holds long enough to swap
+// them with its own (already drained, capacity-retaining) buffers, so
+// publishing never waits on rendering and steady state allocates nothing.
+// If the UI stops draining, each buffer holds at most maxPending items and
+// further pushes are counted as dropped.
+class DashboardFeed {
+public:
+    struct Batch {
+        std::vector<OHLCV> candles;
+        std::vector<TradeSignal> signals;
+        bool hasMetrics = false;
+        PerformanceMetrics metrics{};
+        uint64_t dropped = 0;  // pushes lost to a full buffer since the last drain
+    };
+
+    explicit DashboardFeed(size_t maxPending = 1 << 16);
+
+    DashboardFeed(const DashboardFeed&) = delete;
+    DashboardFeed& operator=(const DashboardFeed&) = delete;
+
+    // Any thread
+    void pushCandle(const OHLCV& candle);
+    void pushSignal(const TradeSignal& signal);
+    // Only the latest metrics are kept
+    void pushMetrics(const PerformanceMetrics& metrics);
+
+    // UI thread: replaces batch with everything published since the last
+    // call, oldest first. Pass the same batch every frame to reuse its
+    // buffers.
+    void drain(Batch& batch);
+
+private:
+    size_t maxPending_;
+    std::mutex mutex_;
+    Batch pending_;
+};
+
+} // namespace novacrypt